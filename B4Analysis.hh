@@ -31,8 +31,9 @@
 #ifndef B4Analysis_h
 #define B4Analysis_h 1
 
-#include "g4root.hh"
-//#include "g4cvs.hh"
-//#include "g4xml.hh"
+// The generic analysis manager selects the output type at run time,
+// from the file name extension or via /analysis/setDefaultFileType
+// (root, csv, xml, hdf5 if Geant4 is built with HDF5)
+#include "G4AnalysisManager.hh"
 
 #endif
@@ -0,0 +1,52 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4Cache.hh
+/// \brief Helpers for the files cached between exampleB4c jobs
+
+#ifndef B4Cache_h
+#define B4Cache_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <string>
+
+/// Location and keys of the files cached between jobs.
+///
+/// The cache directory is given by the B4_CACHE_DIR environment variable,
+/// and defaults to .b4cache in the working directory. The keys are 
+/// FNV-1a hashes, which are stable between builds and platforms.
+
+namespace B4Cache
+{
+  // Returns the cache directory, created if needed
+  G4String GetDirectory();
+
+  // Returns the hexadecimal FNV-1a hash of the given description
+  G4String GetKey(const std::string& description);
+}
+
+#endif
@@ -0,0 +1,297 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4CosmicGenerator.cc
+/// \brief Implementation of the B4CosmicGenerator class
+
+#include "B4CosmicGenerator.hh"
+
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4MuonPlus.hh"
+#include "G4MuonMinus.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VSolid.hh"
+#include "G4GenericMessenger.hh"
+#include "G4UnitsTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4CosmicGenerator::B4CosmicGenerator()
+ : G4VPrimaryGenerator(),
+   fMessenger(nullptr),
+   fMuPlus(G4MuonPlus::Definition()),
+   fMuMinus(G4MuonMinus::Definition()),
+   fMinEnergy(1.*GeV),
+   fMaxEnergy(10.*TeV),
+   fZenith(0., 1., 0.),
+   fRadius(0.),
+   fChargeRatio(1.27),
+   fTableBuilt(false),
+   fLogEnergies(),
+   fIntensityCdf()
+{
+  // the generator is defined on each thread, as the particle source
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/cosmic/", 
+                             "Cosmic muon generator");
+
+  auto& minEnergyCmd 
+    = fMessenger->DeclareMethodWithUnit("setMinEnergy", "GeV", 
+                                        &B4CosmicGenerator::SetMinEnergy,
+                                        "Set the minimum muon energy.");
+  minEnergyCmd.SetParameterName("minEnergy", false);
+  minEnergyCmd.SetRange("minEnergy>0.");
+
+  auto& maxEnergyCmd 
+    = fMessenger->DeclareMethodWithUnit("setMaxEnergy", "GeV", 
+                                        &B4CosmicGenerator::SetMaxEnergy,
+                                        "Set the maximum muon energy.");
+  maxEnergyCmd.SetParameterName("maxEnergy", false);
+  maxEnergyCmd.SetRange("maxEnergy>0.");
+
+  auto& zenithCmd 
+    = fMessenger->DeclareMethod("setZenith", &B4CosmicGenerator::SetZenith,
+                                "Set the upward vertical direction.");
+  zenithCmd.SetParameterName("x", "y", "z", false);
+
+  auto& radiusCmd 
+    = fMessenger->DeclarePropertyWithUnit("setRadius", "cm", fRadius,
+                                          "Set the radius of the sphere, "
+                                          "0 for the sphere enclosing the "
+                                          "detector.");
+  radiusCmd.SetParameterName("radius", false);
+  radiusCmd.SetRange("radius>=0.");
+
+  auto& ratioCmd 
+    = fMessenger->DeclareProperty("setChargeRatio", fChargeRatio,
+                                  "Set the mu+/mu- ratio.");
+  ratioCmd.SetParameterName("ratio", false);
+  ratioCmd.SetRange("ratio>=0.");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4CosmicGenerator::~B4CosmicGenerator()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4CosmicGenerator::SetMinEnergy(G4double energy)
+{
+  fMinEnergy = energy;
+  fTableBuilt = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4CosmicGenerator::SetMaxEnergy(G4double energy)
+{
+  fMaxEnergy = energy;
+  fTableBuilt = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4CosmicGenerator::SetZenith(const G4ThreeVector& zenith)
+{
+  if ( zenith.mag2() <= 0. ) {
+    G4ExceptionDescription msg;
+    msg << "The zenith direction cannot be null, command ignored.";
+    G4Exception("B4CosmicGenerator::SetZenith()",
+      "MyCode0018", JustWarning, msg);
+    return;
+  }
+  fZenith = zenith.unit();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4CosmicGenerator::GetVerticalIntensity(G4double energy)
+{
+  // Gaisser's formula, with the low energy correction of Guan et al., 
+  // at cos(theta) = 1; the energy in GeV
+  auto e = energy/GeV;
+  return 0.14 / ( cm2*s*sr*GeV ) 
+         * std::pow(e * ( 1. + 3.64/e ), -2.7)
+         * ( 1./( 1. + 1.1*e/115. ) + 0.054/( 1. + 1.1*e/850. ) );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4CosmicGenerator::BuildTable()
+{
+  fLogEnergies.clear();
+  fIntensityCdf.clear();
+  fTableBuilt = true;
+  if ( fMaxEnergy <= fMinEnergy ) {
+    G4ExceptionDescription msg;
+    msg << "The maximum muon energy must exceed the minimum energy, "
+        << "no muons are generated.";
+    G4Exception("B4CosmicGenerator::BuildTable()",
+      "MyCode0018", JustWarning, msg);
+    return;
+  }
+
+  // Intensity integrated per bin of log(energy)
+  auto minLogEnergy = std::log(fMinEnergy);
+  auto step = ( std::log(fMaxEnergy) - minLogEnergy ) / ( kNofEnergies - 1 );
+  G4double intensity = 0.;
+  G4double previous = 0.;
+  for ( std::size_t i=0; i<kNofEnergies; ++i ) {
+    auto logEnergy = minLogEnergy + i*step;
+    auto energy = std::exp(logEnergy);
+    auto value = GetVerticalIntensity(energy) * energy;
+    fLogEnergies.push_back(logEnergy);
+    if ( i > 0 ) {
+      intensity += 0.5 * ( previous + value ) * step;
+      fIntensityCdf.push_back(intensity);
+    }
+    previous = value;
+  }
+
+  G4cout << "### Cosmic generator: vertical intensity " 
+         << intensity * ( m2*s*sr ) << " /m2/s/sr between " 
+         << G4BestUnit(fMinEnergy, "Energy") << " and " 
+         << G4BestUnit(fMaxEnergy, "Energy") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4CosmicGenerator::GetRadius() const
+{
+  if ( fRadius > 0. ) return fRadius;
+
+  // The sphere enclosing the bounding boxes of the world daughters
+  auto world 
+    = G4PhysicalVolumeStore::GetInstance()->GetVolume("World", false);
+  if ( ! world ) return 0.;
+  auto worldLV = world->GetLogicalVolume();
+  G4double radius = 0.;
+  for ( std::size_t i=0; i<worldLV->GetNoDaughters(); ++i ) {
+    auto daughter = worldLV->GetDaughter(i);
+    G4ThreeVector pMin, pMax;
+    daughter->GetLogicalVolume()->GetSolid()->BoundingLimits(pMin, pMax);
+    for ( G4int corner=0; corner<8; ++corner ) {
+      G4ThreeVector point((corner & 1) ? pMax.x() : pMin.x(),
+                          (corner & 2) ? pMax.y() : pMin.y(),
+                          (corner & 4) ? pMax.z() : pMin.z());
+      point = daughter->GetObjectRotationValue() * point 
+              + daughter->GetObjectTranslation();
+      radius = std::max(radius, point.mag());
+    }
+  }
+  return radius;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4CosmicGenerator::GetLiveTimePerMuon()
+{
+  if ( ! fTableBuilt ) BuildTable();
+  if ( fIntensityCdf.empty() ) return 0.;
+
+  // Rate through the disk: the integral of cos^2 over the upper 
+  // hemisphere is 2 pi/3
+  auto radius = GetRadius();
+  auto rate 
+    = fIntensityCdf.back() * ( twopi/3. * sr ) * ( pi*radius*radius );
+  return ( rate > 0. ) ? 1./rate : 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4CosmicGenerator::GeneratePrimaryVertex(G4Event* event)
+{
+  if ( ! fTableBuilt ) BuildTable();
+  if ( fIntensityCdf.empty() || fIntensityCdf.back() <= 0. ) return;
+
+  // Energy from the vertical spectrum
+  auto bin 
+    = std::upper_bound(fIntensityCdf.begin(), fIntensityCdf.end(), 
+                       G4UniformRand() * fIntensityCdf.back()) 
+      - fIntensityCdf.begin();
+  bin = std::min<std::ptrdiff_t>(bin, fIntensityCdf.size() - 1);
+  auto energy 
+    = std::exp(fLogEnergies[bin] 
+               + ( fLogEnergies[bin+1] - fLogEnergies[bin] ) * G4UniformRand());
+
+  // Arrival direction, cos^2 distributed per solid angle around the zenith
+  auto cosTheta = std::cbrt(G4UniformRand());
+  auto sinTheta = std::sqrt(std::max(0., 1. - cosTheta*cosTheta));
+  auto phi = twopi * G4UniformRand();
+  auto u = fZenith.orthogonal().unit();
+  auto v = fZenith.cross(u);
+  auto arrival 
+    = cosTheta * fZenith + sinTheta * ( std::cos(phi) * u + std::sin(phi) * v );
+
+  // Point of the disk tangent to the sphere, facing the arrival 
+  // direction, moved along the direction to the sphere
+  auto radius = GetRadius();
+  auto r = radius * std::sqrt(G4UniformRand());
+  auto alpha = twopi * G4UniformRand();
+  auto a = arrival.orthogonal().unit();
+  auto b = arrival.cross(a);
+  auto position 
+    = std::sqrt(radius*radius - r*r) * arrival 
+      + r * ( std::cos(alpha) * a + std::sin(alpha) * b );
+
+  // and then into the world if the sphere exceeds it; the muons missing
+  // the world miss the detector, the event is left empty
+  auto world 
+    = G4PhysicalVolumeStore::GetInstance()->GetVolume("World", false);
+  if ( world ) {
+    auto worldSolid = world->GetLogicalVolume()->GetSolid();
+    if ( worldSolid->Inside(position) == kOutside ) {
+      auto distance = worldSolid->DistanceToIn(position, -arrival);
+      if ( distance == kInfinity ) return;
+      position -= distance * arrival;
+    }
+  }
+
+  auto definition 
+    = ( G4UniformRand() * ( 1. + fChargeRatio ) < fChargeRatio ) 
+      ? fMuPlus : fMuMinus;
+  // the sampled energy is the total energy
+  auto muon = new G4PrimaryParticle(definition);
+  muon->SetKineticEnergy(std::max(energy - definition->GetPDGMass(), 0.));
+  muon->SetMomentumDirection(-arrival);
+
+  auto vertex = new G4PrimaryVertex(position, particle_time);
+  vertex->SetPrimary(muon);
+  event->AddPrimaryVertex(vertex);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
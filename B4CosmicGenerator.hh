@@ -0,0 +1,113 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4CosmicGenerator.hh
+/// \brief Definition of the B4CosmicGenerator class
+
+#ifndef B4CosmicGenerator_h
+#define B4CosmicGenerator_h 1
+
+#include "G4VPrimaryGenerator.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4Event;
+class G4GenericMessenger;
+class G4ParticleDefinition;
+
+/// Cosmic muon primary generator at sea level.
+///
+/// The muon energy is sampled from the modified Gaisser parametrization
+/// of the vertical spectrum (Guan et al., arXiv:1509.06176), between a 
+/// minimum and a maximum energy, from a table computed once when they 
+/// change. The parametrization gives the total muon energy, the muon 
+/// mass is subtracted to set the kinetic energy. The zenith angle 
+/// follows the cos^2 distribution per solid angle, and the charge is 
+/// drawn with the mu+/mu- ratio.
+///
+/// The muons start from a disk perpendicular to their direction, 
+/// tangent to a sphere centred at the origin and enclosing the detector
+/// (the volumes placed in the world), with the disk radius equal to the
+/// sphere radius: every muon crosses the sphere, and none is lost on 
+/// the detector side. They are moved along their direction to where 
+/// they enter the sphere, or the world when the sphere exceeds it.
+///
+/// The rate of the muons through the disk is the integrated vertical 
+/// intensity times the solid angle integral of cos^2 (2 pi/3) times the
+/// disk area, and the live time represented by a muon is its inverse; 
+/// the run action sums it over the events.
+///
+/// The following commands are defined (on each thread):
+/// - /B4/cosmic/setMinEnergy value unit
+/// - /B4/cosmic/setMaxEnergy value unit
+/// - /B4/cosmic/setZenith x y z
+/// - /B4/cosmic/setRadius value unit   (0 for the enclosing sphere)
+/// - /B4/cosmic/setChargeRatio value
+
+class B4CosmicGenerator : public G4VPrimaryGenerator
+{
+  public:
+    B4CosmicGenerator();
+    virtual ~B4CosmicGenerator();
+
+    virtual void GeneratePrimaryVertex(G4Event* event);
+
+    // The vertical intensity dI/dE (per unit area, time and solid angle)
+    static G4double GetVerticalIntensity(G4double energy);
+
+    // The live time represented by one muon
+    G4double GetLiveTimePerMuon();
+
+    // set methods
+    void SetMinEnergy(G4double energy);
+    void SetMaxEnergy(G4double energy);
+    void SetZenith(const G4ThreeVector& zenith);
+
+  private:
+    void BuildTable();
+    G4double GetRadius() const;
+
+    static constexpr std::size_t kNofEnergies = 1000;
+
+    G4GenericMessenger* fMessenger;
+    const G4ParticleDefinition* fMuPlus;
+    const G4ParticleDefinition* fMuMinus;
+
+    G4double fMinEnergy;
+    G4double fMaxEnergy;
+    G4ThreeVector fZenith;
+    G4double fRadius;
+    G4double fChargeRatio;
+
+    // table
+    G4bool fTableBuilt;
+    std::vector<G4double> fLogEnergies;
+    std::vector<G4double> fIntensityCdf;  ///< per energy bin
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,124 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4EmPhysicsList.cc
+/// \brief Implementation of the B4EmPhysicsList class
+
+#include "B4EmPhysicsList.hh"
+
+#include "G4EmStandardPhysics_option4.hh"
+#include "G4EmLivermorePhysics.hh"
+#include "G4EmPenelopePhysics.hh"
+#include "G4DecayPhysics.hh"
+#include "G4RadioactiveDecayPhysics.hh"
+#include "G4GenericMessenger.hh"
+#include "G4ApplicationState.hh"
+
+namespace {
+  G4VPhysicsConstructor* CreateEmPhysics(const G4String& emName) {
+    if ( emName == "opt4" )      return new G4EmStandardPhysics_option4();
+    if ( emName == "Livermore" ) return new G4EmLivermorePhysics();
+    if ( emName == "Penelope" )  return new G4EmPenelopePhysics();
+    return nullptr;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4EmPhysicsList::B4EmPhysicsList(const G4String& emName)
+ : G4VModularPhysicsList(),
+   fMessenger(nullptr),
+   fRadioactiveDecay(false)
+{
+  SetVerboseLevel(1);
+
+  auto emPhysics = CreateEmPhysics(emName);
+  if ( ! emPhysics ) {
+    G4ExceptionDescription msg;
+    msg << "Unknown EM physics " << emName << ", opt4 is used.";
+    G4Exception("B4EmPhysicsList::B4EmPhysicsList()",
+      "MyCode0010", JustWarning, msg);
+    emPhysics = CreateEmPhysics("opt4");
+  }
+  RegisterPhysics(emPhysics);
+  RegisterPhysics(new G4DecayPhysics());
+
+  // The physics list is shared by all threads, the commands are 
+  // therefore executed on master only
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/phys/", "EM physics list control");
+
+  auto& emCmd 
+    = fMessenger->DeclareMethod("setEm", &B4EmPhysicsList::SetEm,
+                                "Select the electromagnetic physics.");
+  emCmd.SetParameterName("emName", false);
+  emCmd.SetCandidates("opt4 Livermore Penelope");
+  emCmd.SetStates(G4State_PreInit);
+  emCmd.command->SetToBeBroadcasted(false);
+
+  auto& rdmCmd 
+    = fMessenger->DeclareMethod("addRadioactiveDecay", 
+                                &B4EmPhysicsList::AddRadioactiveDecay,
+                                "Add the radioactive decay.");
+  rdmCmd.SetStates(G4State_PreInit);
+  rdmCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4EmPhysicsList::~B4EmPhysicsList()
+{ 
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4EmPhysicsList::IsEmName(const G4String& emName)
+{
+  return emName == "opt4" || emName == "Livermore" || emName == "Penelope";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4EmPhysicsList::SetEm(const G4String& emName)
+{
+  auto emPhysics = CreateEmPhysics(emName);
+  if ( ! emPhysics ) return;
+
+  // replaces the constructor of the same (electromagnetic) type
+  ReplacePhysics(emPhysics);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4EmPhysicsList::AddRadioactiveDecay()
+{
+  if ( fRadioactiveDecay ) return;
+
+  RegisterPhysics(new G4RadioactiveDecayPhysics());
+  fRadioactiveDecay = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
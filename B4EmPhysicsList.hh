@@ -0,0 +1,71 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4EmPhysicsList.hh
+/// \brief Definition of the B4EmPhysicsList class
+
+#ifndef B4EmPhysicsList_h
+#define B4EmPhysicsList_h 1
+
+#include "G4VModularPhysicsList.hh"
+#include "globals.hh"
+
+class G4GenericMessenger;
+
+/// Electromagnetic-only modular physics list.
+///
+/// For MeV electrons, gammas and alphas the hadronic models of the 
+/// reference physics lists are not needed; this list only builds the 
+/// electromagnetic physics, the decays and, optionally, the radioactive
+/// decay. The electromagnetic constructor is one of:
+/// - opt4      (G4EmStandardPhysics_option4, the default)
+/// - Livermore (G4EmLivermorePhysics)
+/// - Penelope  (G4EmPenelopePhysics)
+///
+/// The following commands are defined (before /run/initialize):
+/// - /B4/phys/setEm opt4|Livermore|Penelope
+/// - /B4/phys/addRadioactiveDecay
+
+class B4EmPhysicsList : public G4VModularPhysicsList
+{
+  public:
+    B4EmPhysicsList(const G4String& emName = "opt4");
+    virtual ~B4EmPhysicsList();
+
+    // Returns true if the name is that of an available EM constructor
+    static G4bool IsEmName(const G4String& emName);
+
+    // set methods
+    void SetEm(const G4String& emName);
+    void AddRadioactiveDecay();
+
+  private:
+    G4GenericMessenger* fMessenger;
+    G4bool fRadioactiveDecay;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,272 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4EventSeeder.cc
+/// \brief Implementation of the B4EventSeeder class
+
+#include "B4EventSeeder.hh"
+
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "Randomize.hh"
+
+#include "CLHEP/Random/MixMaxRng.h"
+#include "CLHEP/Random/RanluxEngine.h"
+#include "CLHEP/Random/Ranlux64Engine.h"
+#include "CLHEP/Random/RanluxppEngine.h"
+#include "CLHEP/Random/RanecuEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <vector>
+
+namespace {
+  const std::vector<G4String> kEngineNames 
+    = { "MixMax", "Ranlux", "Ranlux64", "RanluxPP", "Ranecu" };
+
+  CLHEP::HepRandomEngine* CreateEngine(const G4String& name) {
+    if ( name == "MixMax" )   return new CLHEP::MixMaxRng;
+    if ( name == "Ranlux" )   return new CLHEP::RanluxEngine;
+    if ( name == "Ranlux64" ) return new CLHEP::Ranlux64Engine;
+    if ( name == "RanluxPP" ) return new CLHEP::RanluxppEngine;
+    if ( name == "Ranecu" )   return new CLHEP::RanecuEngine;
+    return nullptr;
+  }
+
+  // SplitMix64 finalizer, a bijection on 64-bit integers
+  std::uint64_t Mix(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  // Hashes a (seed, run, event) key to 64 bits
+  std::uint64_t Hash(std::uint64_t runSeed, std::uint64_t runID,
+                     std::uint64_t eventID) {
+    return Mix(Mix(Mix(runSeed) ^ runID) ^ eventID);
+  }
+
+  // Seeds the engine from a (seed, run, event) key
+  void SetSeeds(CLHEP::HepRandomEngine* engine, std::uint64_t runSeed,
+                std::uint64_t runID, std::uint64_t eventID) {
+    const std::uint64_t mask32 = 0xffffffffULL;
+    if ( dynamic_cast<CLHEP::MixMaxRng*>(engine) ) {
+      // distinct seed tuples give non-overlapping MixMax streams: the 
+      // event ID (below 2^32) and the run ID are passed as they are, the
+      // run seed and the high part of the event ID as a 64-bit hash
+      auto key = Mix(Mix(runSeed) ^ (eventID >> 32));
+      long seeds[4] = { long(eventID & mask32),
+                        long(runID & mask32),
+                        long(key & mask32),
+                        long(key >> 32) };
+      engine->setSeeds(seeds, 4);
+    }
+    else if ( dynamic_cast<CLHEP::RanluxppEngine*>(engine) ) {
+      // the full 64-bit hash
+      engine->setSeed(long(Hash(runSeed, runID, eventID)), 0);
+    }
+    else {
+      auto key = Hash(runSeed, runID, eventID);
+      // two non-zero 31-bit seeds, as used by the Geant4 workers
+      long seeds[3] = { long(1 + (key & mask32) % 0x7ffffffe),
+                        long(1 + (key >> 32) % 0x7ffffffe),
+                        0 };
+      engine->setSeeds(seeds, -1);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4EventSeeder* B4EventSeeder::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4EventSeeder* B4EventSeeder::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4EventSeeder();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4EventSeeder::B4EventSeeder()
+ : fMessenger(nullptr),
+   fRunSeed(12345),
+   fEventOffset(0),
+   fReplayKeys()
+{
+  // The seeder state is shared by all threads, the commands are 
+  // therefore executed on master only
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/random/", "Per-event seeding control");
+
+  auto& seedCmd 
+    = fMessenger->DeclareMethod("setRunSeed", &B4EventSeeder::SetRunSeed,
+                                "Set the seed from which all events are seeded.");
+  seedCmd.SetParameterName("seed", false);
+  seedCmd.command->SetToBeBroadcasted(false);
+
+  auto& benchCmd 
+    = fMessenger->DeclareMethod("benchmark", &B4EventSeeder::Benchmark,
+                                "Time the per-event cost of each engine.");
+  benchCmd.SetParameterName("nDrawsPerEvent", true);
+  benchCmd.SetDefaultValue("1000");
+  benchCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4EventSeeder::~B4EventSeeder()
+{ 
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4EventSeeder::SetEngine(const G4String& name)
+{
+  auto engine = CreateEngine(name);
+  if ( ! engine ) {
+    G4ExceptionDescription msg;
+    msg << "Unknown random engine " << name << ". Available engines:";
+    for ( const auto& engineName : kEngineNames ) msg << " " << engineName;
+    G4Exception("B4EventSeeder::SetEngine()",
+      "MyCode0005", JustWarning, msg);
+    return false;
+  }
+
+  G4Random::setTheEngine(engine);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4EventSeeder::EventKey 
+B4EventSeeder::GetEventKey(const G4Event* event) const
+{
+  auto run = G4RunManager::GetRunManager()->GetCurrentRun();
+
+  EventKey key;
+  key.fRunSeed = fRunSeed;
+  key.fRunID = run ? run->GetRunID() : 0;
+  key.fEventID = fEventOffset + event->GetEventID();
+  return key;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4EventSeeder::EventKey 
+B4EventSeeder::GetSeedKey(const G4Event* event) const
+{
+  // a replayed event is seeded from its original key
+  auto index = std::size_t(event->GetEventID());
+  if ( index < fReplayKeys.size() ) return fReplayKeys[index];
+
+  return GetEventKey(event);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4EventSeeder::SeedEvent(const G4Event* event) const
+{
+  auto key = GetSeedKey(event);
+
+  // with /event/verbose 1 or more
+  auto index = std::size_t(event->GetEventID());
+  if ( index < fReplayKeys.size() && 
+       G4EventManager::GetEventManager()->GetVerboseLevel() > 0 ) {
+    G4cout << "---> Replaying event " << key.fEventID << " of run " 
+           << key.fRunID << " (seed " << key.fRunSeed << ") as event "
+           << event->GetEventID() << G4endl;
+  }
+
+  SetSeeds(G4Random::getTheEngine(), key.fRunSeed, key.fRunID, 
+           key.fEventID);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4EventSeeder::SeedStream(const G4Event* event, G4int stream,
+                               CLHEP::HepRandomEngine* engine) const
+{
+  // the run seed is mixed with the stream number
+  auto key = GetSeedKey(event);
+  SetSeeds(engine, Mix(key.fRunSeed) ^ Mix(stream), key.fRunID, 
+           key.fEventID);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4EventSeeder::Benchmark(G4int nofDrawsPerEvent)
+{
+  using clock = std::chrono::steady_clock;
+  const G4int nofEvents = 10000;
+
+  G4cout << G4endl 
+         << "### Random engine benchmark: " << nofEvents << " events, "
+         << nofDrawsPerEvent << " draws per event" << G4endl;
+
+  G4double sum = 0.;
+  for ( const auto& name : kEngineNames ) {
+    std::unique_ptr<CLHEP::HepRandomEngine> engine(CreateEngine(name));
+
+    auto start = clock::now();
+    for ( G4int i=0; i<nofEvents; ++i ) {
+      SetSeeds(engine.get(), fRunSeed, 0, i);
+    }
+    auto seeded = clock::now();
+    for ( G4int i=0; i<nofEvents; ++i ) {
+      for ( G4int j=0; j<nofDrawsPerEvent; ++j ) sum += engine->flat();
+    }
+    auto drawn = clock::now();
+
+    auto seedTime 
+      = std::chrono::duration<G4double, std::nano>(seeded - start).count();
+    auto drawTime 
+      = std::chrono::duration<G4double, std::nano>(drawn - seeded).count();
+    auto nofDraws = G4double(nofEvents) * std::max(nofDrawsPerEvent, 1);
+
+    G4cout << "  " << std::setw(9) << name 
+           << " : seeding " << seedTime/nofEvents << " ns/event" 
+           << ", draw " << drawTime/nofDraws << " ns" 
+           << ", total " << (seedTime + drawTime)/nofEvents/1000. 
+           << " us/event" << G4endl;
+  }
+  // keep the draws from being optimized away
+  G4cout << "  (checksum " << sum << ")" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,157 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4EventSeeder.hh
+/// \brief Definition of the B4EventSeeder class
+
+#ifndef B4EventSeeder_h
+#define B4EventSeeder_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class G4Event;
+class G4GenericMessenger;
+
+namespace CLHEP {
+  class HepRandomEngine;
+}
+
+/// Per-event seeding of the random engine.
+///
+/// Each event is seeded from the run seed, the run ID and the event ID,
+/// so that the sequence of random numbers used by an event does not depend
+/// on the number of threads nor on the order in which the events are 
+/// processed. With the MixMax engine the event ID, the run ID and a 64-bit
+/// hash of the run seed are passed to its unique-stream seeding, which 
+/// guarantees non-overlapping sequences; the other engines are seeded with
+/// a 64-bit hash of the whole key (in full for RanluxPP, as two 31-bit 
+/// seeds for the 32-bit engines).
+///
+/// Derived streams of the same key seed separate engines, so that a 
+/// step of the event processing (such as the digitization) draws the 
+/// same numbers whatever the number of draws before it in the event.
+///
+/// An event offset can be set so that the events of a run split over 
+/// several processes (shards) are seeded with their IDs in the whole run.
+///
+/// Selected events can be replayed: when replay keys are set, the event
+/// i of the next runs is seeded from the i-th key instead of its own, 
+/// which reproduces the original event provided that the same engine, 
+/// geometry and source are used (see B4cEventKeeper). The replayed 
+/// events are printed with /event/verbose 1.
+///
+/// The engine is chosen with SetEngine() before the run manager is created
+/// (MixMax, Ranlux, Ranlux64, RanluxPP, Ranecu). The following commands 
+/// are defined:
+/// - /B4/random/setRunSeed seed
+/// - /B4/random/benchmark nDrawsPerEvent
+
+class B4EventSeeder
+{
+  public:
+    // The key from which an event is seeded
+    struct EventKey {
+      G4long fRunSeed = 0;
+      G4int  fRunID = 0;
+      G4long fEventID = 0;
+    };
+
+    static B4EventSeeder* Instance();
+    ~B4EventSeeder();
+
+    // Install the named engine as the master engine
+    static G4bool SetEngine(const G4String& name);
+
+    // Derived streams
+    static constexpr G4int kDigitizationStream = 1;
+
+    // Reseed the engine of the calling thread for the given event
+    void SeedEvent(const G4Event* event) const;
+
+    // Seed the given engine with a derived stream of the event key
+    void SeedStream(const G4Event* event, G4int stream,
+                    CLHEP::HepRandomEngine* engine) const;
+
+    // The key of the given event in the current run
+    EventKey GetEventKey(const G4Event* event) const;
+
+    // Time the reseeding and the draws of all available engines
+    void Benchmark(G4int nofDrawsPerEvent);
+
+    // set/get methods
+    void   SetRunSeed(G4long seed);
+    G4long GetRunSeed() const;
+    void   SetEventOffset(G4long offset);
+    G4long GetEventOffset() const;
+    void   SetReplayKeys(const std::vector<EventKey>& keys);
+    const std::vector<EventKey>& GetReplayKeys() const;
+
+  private:
+    B4EventSeeder();
+
+    // The key from which the event is seeded, its own or a replayed one
+    EventKey GetSeedKey(const G4Event* event) const;
+
+    static B4EventSeeder* fgInstance;
+
+    G4GenericMessenger* fMessenger;
+    G4long fRunSeed;
+    G4long fEventOffset;
+    std::vector<EventKey> fReplayKeys;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B4EventSeeder::SetRunSeed(G4long seed) {
+  fRunSeed = seed;
+}
+
+inline G4long B4EventSeeder::GetRunSeed() const {
+  return fRunSeed;
+}
+
+inline void B4EventSeeder::SetEventOffset(G4long offset) {
+  fEventOffset = offset;
+}
+
+inline G4long B4EventSeeder::GetEventOffset() const {
+  return fEventOffset;
+}
+
+inline void 
+B4EventSeeder::SetReplayKeys(const std::vector<EventKey>& keys) {
+  fReplayKeys = keys;
+}
+
+inline const std::vector<B4EventSeeder::EventKey>& 
+B4EventSeeder::GetReplayKeys() const {
+  return fReplayKeys;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,583 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4IbdGenerator.cc
+/// \brief Implementation of the B4IbdGenerator class
+
+#include "B4IbdGenerator.hh"
+
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4Positron.hh"
+#include "G4Neutron.hh"
+#include "G4Proton.hh"
+#include "G4TransportationManager.hh"
+#include "G4Navigator.hh"
+#include "G4NavigationHistory.hh"
+#include "G4TouchableHistory.hh"
+#include "G4AffineTransform.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VSolid.hh"
+#include "G4Material.hh"
+#include "G4GenericMessenger.hh"
+#include "G4RandomDirection.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace {
+  // Nucleon form factors at zero momentum transfer: vector, axial and 
+  // weak magnetism (difference of the anomalous magnetic moments)
+  const G4double kF = 1.;
+  const G4double kG = 1.26;
+  const G4double kF2 = 3.706;
+
+  // Normalization of the total cross section at zeroth order,
+  // sigma = 0.0952e-42 cm2 Ee pe / MeV2, in units of (f^2 + 3g^2)
+  const G4double kSigma0 = 0.0952e-42*cm2 / ( kF*kF + 3.*kG*kG );
+
+  // Huber-Mueller parametrizations of the antineutrino spectra per 
+  // fission, exp(sum a_k E^k) with E in MeV, for 235U, 238U, 239Pu, 241Pu
+  const G4double kReactorCoefficients[4][6] = {
+    { 3.217, -3.111, 1.395, -3.690e-1, 4.445e-2, -2.053e-3 },
+    { 4.833e-1, 1.927e-1, -1.283e-1, -6.762e-3, 2.233e-3, -1.536e-4 },
+    { 6.413, -7.432, 3.535, -8.820e-1, 1.025e-1, -4.550e-3 },
+    { 3.251, -3.204, 1.428, -3.675e-1, 4.254e-2, -1.896e-3 } };
+
+  // Upper end of the reactor spectrum
+  const G4double kReactorMaxEnergy = 10.*MeV;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4IbdGenerator::B4IbdGenerator()
+ : G4VPrimaryGenerator(),
+   fMessenger(nullptr),
+   fPositron(G4Positron::Definition()),
+   fNeutron(G4Neutron::Definition()),
+   fSpectrum("reactor"),
+   fFissionFractions({ 0.58, 0.07, 0.30, 0.05 }),
+   fPoints(),
+   fDirection(0., 0., 0.),
+   fTargetVolume(),
+   fTablesBuilt(false),
+   fThreshold(0.),
+   fEnergies(),
+   fRateCdf(),
+   fCosThetaCdfs(),
+   fMeanCrossSection(0.),
+   fNavigator(nullptr),
+   fNormalization(0.)
+{
+  // the generator is defined on each thread, as the particle source
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/ibd/", 
+                             "Inverse beta decay generator");
+
+  auto& spectrumCmd 
+    = fMessenger->DeclareMethod("setSpectrum", &B4IbdGenerator::SetSpectrum,
+                                "Select the antineutrino spectrum.");
+  spectrumCmd.SetParameterName("spectrum", false);
+  spectrumCmd.SetCandidates("reactor table");
+
+  auto& fractionsCmd 
+    = fMessenger->DeclareMethod("setFissionFractions", 
+                                &B4IbdGenerator::SetFissionFractions,
+                                "Set the fission fractions of the reactor: "
+                                "f235U f238U f239Pu f241Pu.");
+  fractionsCmd.SetParameterName("fractions", false);
+
+  auto& pointCmd 
+    = fMessenger->DeclareMethod("addPoint", &B4IbdGenerator::AddPoint,
+                                "Add a point to the tabulated spectrum: "
+                                "energy(MeV) weight.");
+  pointCmd.SetParameterName("point", false);
+
+  fMessenger->DeclareMethod("clearPoints", &B4IbdGenerator::ClearPoints,
+                            "Clear the tabulated spectrum.");
+
+  auto& readCmd 
+    = fMessenger->DeclareMethod("readSpectrum", &B4IbdGenerator::ReadSpectrum,
+                                "Read the tabulated spectrum from a file "
+                                "of lines: energy(MeV) weight.");
+  readCmd.SetParameterName("fileName", false);
+
+  auto& directionCmd 
+    = fMessenger->DeclareMethod("setDirection", &B4IbdGenerator::SetDirection,
+                                "Set the antineutrino direction, "
+                                "isotropic if null.");
+  directionCmd.SetParameterName("x", "y", "z", false);
+
+  auto& targetCmd 
+    = fMessenger->DeclareMethod("setTargetVolume", 
+                                &B4IbdGenerator::SetTargetVolume,
+                                "Force the interactions in the named "
+                                "volume, none if empty.");
+  targetCmd.SetParameterName("name", true);
+  targetCmd.SetDefaultValue("");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4IbdGenerator::~B4IbdGenerator()
+{
+  delete fNavigator;
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4IbdGenerator::SetSpectrum(const G4String& spectrum)
+{
+  fSpectrum = spectrum;
+  fTablesBuilt = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4IbdGenerator::SetFissionFractions(const G4String& fractions)
+{
+  std::istringstream input(fractions);
+  std::array<G4double, 4> values;
+  for ( auto& value : values ) {
+    if ( ! ( input >> value ) || value < 0. ) {
+      G4ExceptionDescription msg;
+      msg << "Wrong fission fractions \"" << fractions 
+          << "\", the fractions are not changed.";
+      G4Exception("B4IbdGenerator::SetFissionFractions()",
+        "MyCode0015", JustWarning, msg);
+      return;
+    }
+  }
+  fFissionFractions = values;
+  fTablesBuilt = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4IbdGenerator::AddPoint(const G4String& point)
+{
+  std::istringstream input(point);
+  G4double energy, weight;
+  if ( ! ( input >> energy >> weight ) || energy < 0. || weight < 0. ) {
+    G4ExceptionDescription msg;
+    msg << "Wrong spectrum point \"" << point << "\", point ignored.";
+    G4Exception("B4IbdGenerator::AddPoint()",
+      "MyCode0015", JustWarning, msg);
+    return;
+  }
+
+  // the points are kept ordered in energy
+  std::pair<G4double, G4double> value(energy*MeV, weight);
+  fPoints.insert(std::upper_bound(fPoints.begin(), fPoints.end(), value), 
+                 value);
+  fTablesBuilt = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4IbdGenerator::ClearPoints()
+{
+  fPoints.clear();
+  fTablesBuilt = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4IbdGenerator::ReadSpectrum(const G4String& fileName)
+{
+  std::ifstream file(fileName.c_str());
+  if ( ! file ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fileName << ".";
+    G4Exception("B4IbdGenerator::ReadSpectrum()",
+      "MyCode0015", JustWarning, msg);
+    return;
+  }
+
+  ClearPoints();
+  std::string line;
+  while ( std::getline(file, line) ) {
+    if ( line.empty() || line[0] == '#' ) continue;
+    AddPoint(line);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4IbdGenerator::SetDirection(const G4ThreeVector& direction)
+{
+  fDirection = direction;
+  if ( fDirection.mag2() > 0. ) fDirection = fDirection.unit();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4IbdGenerator::SetTargetVolume(const G4String& name)
+{
+  fTargetVolume = name;
+  fNormalization = fMeanCrossSection;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4IbdGenerator::GetSpectrum(G4double energy) const
+{
+  if ( fSpectrum == "reactor" ) {
+    auto e = energy/MeV;
+    G4double spectrum = 0.;
+    for ( std::size_t i=0; i<4; ++i ) {
+      const auto& a = kReactorCoefficients[i];
+      auto exponent = a[0] + e*(a[1] + e*(a[2] + e*(a[3] + e*(a[4] + e*a[5]))));
+      spectrum += fFissionFractions[i] * std::exp(exponent);
+    }
+    return spectrum;
+  }
+
+  // tabulated spectrum, null outside of its points
+  std::pair<G4double, G4double> value(energy, 0.);
+  auto upper = std::upper_bound(fPoints.begin(), fPoints.end(), value);
+  if ( upper == fPoints.begin() || upper == fPoints.end() ) return 0.;
+  auto lower = upper - 1;
+  if ( upper->first == lower->first ) return lower->second;
+  return lower->second + ( upper->second - lower->second ) 
+         * ( energy - lower->first ) / ( upper->first - lower->first );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4IbdGenerator::GetDifferentialCrossSection(G4double energy, 
+                                                     G4double cosTheta) const
+{
+  // Vogel and Beacom, eqs. (12)-(13)
+  static const G4double protonMass = G4Proton::Definition()->GetPDGMass();
+  static const G4double neutronMass = G4Neutron::Definition()->GetPDGMass();
+  static const G4double electronMass = electron_mass_c2;
+  static const G4double nucleonMass = 0.5 * ( protonMass + neutronMass );
+  static const G4double delta = neutronMass - protonMass;
+  static const G4double ySquare 
+    = 0.5 * ( delta*delta - electronMass*electronMass );
+
+  const G4double f2 = kF*kF;
+  const G4double g2 = kG*kG;
+  const G4double me2 = electronMass*electronMass;
+
+  // zeroth order positron energy
+  auto energy0 = energy - delta;
+  if ( energy0 <= electronMass ) return 0.;
+  auto momentum0 = std::sqrt(energy0*energy0 - me2);
+  auto velocity0 = momentum0/energy0;
+
+  // first order positron energy
+  auto energy1 
+    = energy0 * ( 1. - energy/nucleonMass * ( 1. - velocity0*cosTheta ) )
+      - ySquare/nucleonMass;
+  if ( energy1 <= electronMass ) return 0.;
+  auto momentum1 = std::sqrt(energy1*energy1 - me2);
+  auto velocity1 = momentum1/energy1;
+
+  auto recoil = ( energy0 + delta ) * ( 1. - cosTheta/velocity0 ) - delta;
+  auto gamma 
+    = 2. * ( kF + kF2 ) * kG 
+      * ( ( 2.*energy0 + delta ) * ( 1. - velocity0*cosTheta ) 
+          - me2/energy0 )
+    + ( f2 + g2 ) * ( delta * ( 1. + velocity0*cosTheta ) + me2/energy0 )
+    + ( f2 + 3.*g2 ) * recoil
+    + ( f2 - g2 ) * recoil * velocity0*cosTheta;
+
+  auto crossSection 
+    = 0.5 * kSigma0 
+      * ( ( ( f2 + 3.*g2 ) + ( f2 - g2 ) * velocity1*cosTheta ) 
+          * energy1*momentum1 
+          - gamma/nucleonMass * energy0*momentum0 ) / (MeV*MeV);
+
+  // the expansion is not valid very close to the threshold
+  return std::max(crossSection, 0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4IbdGenerator::BuildTables()
+{
+  auto protonMass = G4Proton::Definition()->GetPDGMass();
+  auto neutronMass = fNeutron->GetPDGMass();
+  auto positronMass = fPositron->GetPDGMass();
+  fThreshold 
+    = ( ( neutronMass + positronMass ) * ( neutronMass + positronMass ) 
+        - protonMass*protonMass ) / ( 2.*protonMass );
+
+  auto maxEnergy 
+    = ( fSpectrum == "reactor" ) ? kReactorMaxEnergy
+      : ( fPoints.empty() ? 0. : fPoints.back().first );
+
+  fEnergies.clear();
+  fRateCdf.clear();
+  fCosThetaCdfs.clear();
+  fMeanCrossSection = 0.;
+  fNormalization = 0.;
+  if ( maxEnergy <= fThreshold ) {
+    G4ExceptionDescription msg;
+    msg << "The antineutrino spectrum does not extend above the inverse "
+        << "beta decay threshold, no interactions are generated.";
+    G4Exception("B4IbdGenerator::BuildTables()",
+      "MyCode0015", JustWarning, msg);
+    fTablesBuilt = true;
+    return;
+  }
+
+  // Total cross section and angular distribution at each energy
+  auto energyStep = ( maxEnergy - fThreshold ) / ( kNofEnergies - 1 );
+  auto cosThetaStep = 2. / kNofCosThetas;
+  std::vector<G4double> rates;
+  for ( std::size_t i=0; i<kNofEnergies; ++i ) {
+    auto energy = fThreshold + i*energyStep;
+    fEnergies.push_back(energy);
+
+    std::vector<G4double> cdf;
+    G4double crossSection = 0.;
+    for ( std::size_t j=0; j<kNofCosThetas; ++j ) {
+      auto cosTheta = -1. + ( j + 0.5 ) * cosThetaStep;
+      crossSection 
+        += GetDifferentialCrossSection(energy, cosTheta) * cosThetaStep;
+      cdf.push_back(crossSection);
+    }
+    // isotropic at the threshold
+    for ( std::size_t j=0; j<kNofCosThetas; ++j ) {
+      cdf[j] = ( crossSection > 0. ) ? cdf[j]/crossSection 
+                                     : ( j + 1. ) / kNofCosThetas;
+    }
+    fCosThetaCdfs.push_back(cdf);
+    rates.push_back(GetSpectrum(energy) * crossSection);
+  }
+
+  // Interaction spectrum, integrated per energy bin
+  G4double rate = 0.;
+  for ( std::size_t i=0; i+1<kNofEnergies; ++i ) {
+    rate += 0.5 * ( rates[i] + rates[i+1] ) * energyStep;
+    fRateCdf.push_back(rate);
+  }
+
+  // Flux-averaged cross section, over the spectrum above the threshold
+  // integrated on the same energies as the rate, whatever the spectrum
+  G4double flux = 0.;
+  for ( std::size_t i=0; i+1<kNofEnergies; ++i ) {
+    flux += 0.5 * ( GetSpectrum(fEnergies[i]) + GetSpectrum(fEnergies[i+1]) )
+            * energyStep;
+  }
+  fMeanCrossSection = ( flux > 0. ) ? rate/flux : 0.;
+  fNormalization = fMeanCrossSection;
+  fTablesBuilt = true;
+
+  G4cout << "### IBD generator: " << fSpectrum << " spectrum, "
+         << "mean cross section " << fMeanCrossSection/cm2 << " cm2" 
+         << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4IbdGenerator::SampleCosTheta(std::size_t bin) const
+{
+  const auto& cdf = fCosThetaCdfs[bin];
+  auto index 
+    = std::upper_bound(cdf.begin(), cdf.end(), G4UniformRand()) - cdf.begin();
+  index = std::min<std::ptrdiff_t>(index, kNofCosThetas - 1);
+  return -1. + ( index + G4UniformRand() ) * 2. / kNofCosThetas;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4IbdGenerator::FindTarget(G4VPhysicalVolume* volume, 
+                                  std::vector<G4VPhysicalVolume*>& path) const
+{
+  // depth-first search from the world, through the placements which 
+  // have a fixed transformation
+  path.push_back(volume);
+  if ( volume->GetName() == fTargetVolume ) return true;
+
+  auto logicalVolume = volume->GetLogicalVolume();
+  for ( std::size_t i=0; i<logicalVolume->GetNoDaughters(); ++i ) {
+    auto daughter = logicalVolume->GetDaughter(i);
+    if ( daughter->VolumeType() == kNormal && FindTarget(daughter, path) ) {
+      return true;
+    }
+  }
+  path.pop_back();
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector B4IbdGenerator::SampleTargetPosition()
+{
+  // The geometry may have been rebuilt since the previous event
+  auto worldPV = G4TransportationManager::GetTransportationManager()
+                   ->GetNavigatorForTracking()->GetWorldVolume();
+  std::vector<G4VPhysicalVolume*> path;
+  if ( ! worldPV || ! FindTarget(worldPV, path) ) {
+    G4ExceptionDescription msg;
+    msg << "Target volume " << fTargetVolume << " not found, "
+        << "the vertex is at the source position.";
+    G4Exception("B4IbdGenerator::SampleTargetPosition()",
+      "MyCode0015", JustWarning, msg);
+    return particle_position;
+  }
+  auto volume = path.back();
+
+  // Free protons of the target
+  auto solid = volume->GetLogicalVolume()->GetSolid();
+  auto material = volume->GetLogicalVolume()->GetMaterial();
+  G4double nofHydrogens = 0.;
+  const auto elements = material->GetElementVector();
+  for ( std::size_t i=0; i<material->GetNumberOfElements(); ++i ) {
+    if ( (*elements)[i]->GetZasInt() == 1 ) {
+      nofHydrogens += material->GetVecNbOfAtomsPerVolume()[i];
+    }
+  }
+  if ( nofHydrogens == 0. ) {
+    G4ExceptionDescription msg;
+    msg << "The material " << material->GetName() << " of the target "
+        << "volume " << fTargetVolume << " contains no hydrogen.";
+    G4Exception("B4IbdGenerator::SampleTargetPosition()",
+      "MyCode0015", FatalException, msg);
+  }
+
+  // Run normalization, printed when it changes
+  auto nofProtons = nofHydrogens * solid->GetCubicVolume();
+  auto normalization = fMeanCrossSection * nofProtons;
+  if ( normalization != fNormalization ) {
+    fNormalization = normalization;
+    G4cout << "### IBD generator: target " << fTargetVolume << " (" 
+           << material->GetName() << "), " << nofProtons 
+           << " free protons, " << fNormalization/cm2 
+           << " cm2 interactions per unit antineutrino fluence" << G4endl;
+  }
+
+  // Transformation of the target to the world, from its navigation 
+  // history
+  G4NavigationHistory history;
+  history.SetFirstEntry(worldPV);
+  for ( std::size_t i=1; i<path.size(); ++i ) {
+    history.NewLevel(path[i], kNormal, path[i]->GetCopyNo());
+  }
+  G4TouchableHistory touchable(history);
+  auto toWorld = touchable.GetHistory()->GetTopTransform().Inverse();
+
+  if ( ! fNavigator ) fNavigator = new G4Navigator();
+  fNavigator->SetWorldVolume(worldPV);
+
+  // Uniform in the solid, and located in the target itself
+  G4ThreeVector pMin, pMax;
+  solid->BoundingLimits(pMin, pMax);
+  for ( G4int i=0; i<100000; ++i ) {
+    G4ThreeVector local(pMin.x() + ( pMax.x() - pMin.x() ) * G4UniformRand(),
+                        pMin.y() + ( pMax.y() - pMin.y() ) * G4UniformRand(),
+                        pMin.z() + ( pMax.z() - pMin.z() ) * G4UniformRand());
+    if ( solid->Inside(local) != kInside ) continue;
+
+    auto position = toWorld.TransformPoint(local);
+    if ( fNavigator->LocateGlobalPointAndSetup(position, nullptr, 
+                                               false, true) == volume ) {
+      return position;
+    }
+  }
+
+  G4ExceptionDescription msg;
+  msg << "No point sampled in the target volume " << fTargetVolume << ".";
+  G4Exception("B4IbdGenerator::SampleTargetPosition()",
+    "MyCode0015", JustWarning, msg);
+  return toWorld.TransformPoint(G4ThreeVector());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4IbdGenerator::GeneratePrimaryVertex(G4Event* event)
+{
+  if ( ! fTablesBuilt ) BuildTables();
+  if ( fRateCdf.empty() || fRateCdf.back() <= 0. ) return;
+
+  // Antineutrino energy from the interaction spectrum
+  auto bin 
+    = std::upper_bound(fRateCdf.begin(), fRateCdf.end(), 
+                       G4UniformRand() * fRateCdf.back()) - fRateCdf.begin();
+  bin = std::min<std::ptrdiff_t>(bin, fRateCdf.size() - 1);
+  auto fraction = G4UniformRand();
+  auto energy 
+    = fEnergies[bin] + ( fEnergies[bin+1] - fEnergies[bin] ) * fraction;
+
+  // Positron angle from the closer of the two tabulated energies
+  auto cosTheta = SampleCosTheta( ( G4UniformRand() < fraction ) ? bin+1 : bin);
+  auto sinTheta = std::sqrt(std::max(0., 1. - cosTheta*cosTheta));
+  auto phi = twopi * G4UniformRand();
+
+  // Exact two-body kinematics on a proton at rest: 
+  // A Ee - B pe = K, with pe^2 = Ee^2 - me^2
+  auto protonMass = G4Proton::Definition()->GetPDGMass();
+  auto neutronMass = fNeutron->GetPDGMass();
+  auto positronMass = fPositron->GetPDGMass();
+  auto a = energy + protonMass;
+  auto b = energy * cosTheta;
+  auto k = 0.5 * ( protonMass*protonMass + 2.*protonMass*energy 
+                   + positronMass*positronMass - neutronMass*neutronMass );
+  auto discriminant 
+    = std::max(0., k*k - positronMass*positronMass * ( a*a - b*b ));
+  auto positronEnergy = ( a*k + b*std::sqrt(discriminant) ) / ( a*a - b*b );
+  auto positronMomentum 
+    = std::sqrt(std::max(0., positronEnergy*positronEnergy 
+                             - positronMass*positronMass));
+
+  // Directions
+  auto direction 
+    = ( fDirection.mag2() > 0. ) ? fDirection : G4RandomDirection();
+  auto u = direction.orthogonal().unit();
+  auto v = direction.cross(u);
+  auto positronDirection 
+    = cosTheta * direction 
+      + sinTheta * ( std::cos(phi) * u + std::sin(phi) * v );
+  auto positronP = positronMomentum * positronDirection;
+  auto neutronP = energy * direction - positronP;
+
+  // Vertex in the target, the events are not weighted
+  auto position = particle_position;
+  if ( ! fTargetVolume.empty() ) {
+    position = SampleTargetPosition();
+  }
+
+  auto vertex = new G4PrimaryVertex(position, particle_time);
+  vertex->SetPrimary(
+    new G4PrimaryParticle(fPositron, positronP.x(), positronP.y(), 
+                          positronP.z()));
+  vertex->SetPrimary(
+    new G4PrimaryParticle(fNeutron, neutronP.x(), neutronP.y(), 
+                          neutronP.z()));
+  event->AddPrimaryVertex(vertex);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
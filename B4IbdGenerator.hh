@@ -0,0 +1,159 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4IbdGenerator.hh
+/// \brief Definition of the B4IbdGenerator class
+
+#ifndef B4IbdGenerator_h
+#define B4IbdGenerator_h 1
+
+#include "G4VPrimaryGenerator.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+class G4Event;
+class G4GenericMessenger;
+class G4Navigator;
+class G4ParticleDefinition;
+class G4VPhysicalVolume;
+
+/// Inverse beta decay (anti-nu_e + p -> e+ + n) primary generator.
+///
+/// The antineutrino energy is sampled from the interaction spectrum,
+/// the product of the antineutrino spectrum and of the total cross 
+/// section, and the positron angle from the differential cross section
+/// at this energy; both are taken from tables computed once when the 
+/// spectrum changes, so that an event costs two binary searches. The 
+/// cross section is the first order in 1/M of Vogel and Beacom (Phys. 
+/// Rev. D 60 (1999) 053003); the positron energy is then given by the 
+/// exact two-body kinematics and the neutron takes the remaining 
+/// momentum, so that the energies and the directions of the pair are 
+/// correlated as in the interaction.
+///
+/// The antineutrino spectrum is either the reactor spectrum (the 
+/// Huber-Mueller parametrizations of the 235U, 238U, 239Pu and 241Pu 
+/// fissions, with the given fission fractions) or a table of points, 
+/// e.g. a geoneutrino spectrum, linearly interpolated. The antineutrinos
+/// come from a fixed direction, or isotropically if it is null.
+///
+/// The flux-averaged cross section is averaged over the spectrum above
+/// the threshold, for both the reactor and the tabulated spectra.
+///
+/// The vertex is at the position of the generator or, when a target 
+/// volume is given, uniformly distributed in it: the interaction is then
+/// forced in the target. The target is a placement at any depth of the
+/// geometry; the points are sampled in its solid, transformed to the 
+/// world with the transformation of its navigation history, and 
+/// rejected when the navigator locates them in another volume (a 
+/// daughter or an overlapping volume). The target material must contain
+/// hydrogen, a fatal exception is raised otherwise.
+///
+/// The events are not weighted. The normalization, the number of 
+/// interactions in the target per unit antineutrino fluence (the 
+/// flux-averaged cross section times the number of free protons, the 
+/// hydrogen atoms of the volume), is printed when it changes and 
+/// returned by GetNormalization(); without target, it is the 
+/// flux-averaged cross section per proton.
+///
+/// The following commands are defined (on each thread):
+/// - /B4/ibd/setSpectrum reactor|table
+/// - /B4/ibd/setFissionFractions f235U f238U f239Pu f241Pu
+/// - /B4/ibd/addPoint energy(MeV) weight
+/// - /B4/ibd/clearPoints
+/// - /B4/ibd/readSpectrum fileName
+/// - /B4/ibd/setDirection x y z
+/// - /B4/ibd/setTargetVolume name
+
+class B4IbdGenerator : public G4VPrimaryGenerator
+{
+  public:
+    B4IbdGenerator();
+    virtual ~B4IbdGenerator();
+
+    virtual void GeneratePrimaryVertex(G4Event* event);
+
+    // Differential cross section in the positron angle
+    G4double GetDifferentialCrossSection(G4double energy, 
+                                         G4double cosTheta) const;
+    // The antineutrino spectrum (arbitrary normalization)
+    G4double GetSpectrum(G4double energy) const;
+    // Interactions per unit antineutrino fluence
+    G4double GetNormalization() const;
+
+    // set methods
+    void SetSpectrum(const G4String& spectrum);
+    void SetFissionFractions(const G4String& fractions);
+    void AddPoint(const G4String& point);
+    void ClearPoints();
+    void ReadSpectrum(const G4String& fileName);
+    void SetDirection(const G4ThreeVector& direction);
+    void SetTargetVolume(const G4String& name);
+
+  private:
+    void BuildTables();
+    G4double SampleCosTheta(std::size_t bin) const;
+    G4bool FindTarget(G4VPhysicalVolume* volume, 
+                      std::vector<G4VPhysicalVolume*>& path) const;
+    G4ThreeVector SampleTargetPosition();
+
+    static constexpr std::size_t kNofEnergies = 500;
+    static constexpr std::size_t kNofCosThetas = 200;
+
+    G4GenericMessenger* fMessenger;
+    const G4ParticleDefinition* fPositron;
+    const G4ParticleDefinition* fNeutron;
+
+    // spectrum
+    G4String fSpectrum;
+    std::array<G4double, 4> fFissionFractions;
+    std::vector<std::pair<G4double, G4double>> fPoints;
+    G4ThreeVector fDirection;
+    G4String fTargetVolume;
+
+    // tables
+    G4bool fTablesBuilt;
+    G4double fThreshold;
+    std::vector<G4double> fEnergies;
+    std::vector<G4double> fRateCdf;     ///< per energy bin
+    std::vector<std::vector<G4double>> fCosThetaCdfs; ///< per energy
+    G4double fMeanCrossSection;         ///< flux-averaged
+
+    // target
+    G4Navigator* fNavigator;
+    G4double fNormalization;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline G4double B4IbdGenerator::GetNormalization() const {
+  return fNormalization;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
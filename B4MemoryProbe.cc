@@ -0,0 +1,110 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4MemoryProbe.cc
+/// \brief Implementation of the B4MemoryProbe helpers
+
+#include "B4MemoryProbe.hh"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4MemoryProbe::GetResidentSize()
+{
+#ifdef __APPLE__
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if ( task_info(mach_task_self(), MACH_TASK_BASIC_INFO, 
+                 reinterpret_cast<task_info_t>(&info), &count) 
+         != KERN_SUCCESS ) return -1.;
+  return G4double(info.resident_size);
+#else
+  // second field of statm, in pages
+  std::ifstream statm("/proc/self/statm");
+  G4double size = 0.;
+  G4double resident = 0.;
+  if ( ! ( statm >> size >> resident ) ) return -1.;
+
+  return resident * ::sysconf(_SC_PAGESIZE);
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4MemoryProbe::GetPeakResidentSize()
+{
+#ifdef __APPLE__
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if ( task_info(mach_task_self(), MACH_TASK_BASIC_INFO, 
+                 reinterpret_cast<task_info_t>(&info), &count) 
+         == KERN_SUCCESS ) return G4double(info.resident_size_max);
+#else
+  // "VmHWM:   123456 kB"
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while ( std::getline(status, line) ) {
+    if ( line.compare(0, 6, "VmHWM:") != 0 ) continue;
+
+    std::istringstream input(line.substr(6));
+    G4double peak = 0.;
+    input >> peak;
+    return peak * 1024.;
+  }
+#endif
+
+  // the maximum resident size, in kilobytes (bytes on macOS)
+  struct rusage usage;
+  if ( ::getrusage(RUSAGE_SELF, &usage) != 0 ) return -1.;
+#ifdef __APPLE__
+  return G4double(usage.ru_maxrss);
+#else
+  return usage.ru_maxrss * 1024.;
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String B4MemoryProbe::Format(G4double size)
+{
+  if ( size < 0. ) return "n/a";
+
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(1) << size / (1024.*1024.);
+  return text.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,52 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4MemoryProbe.hh
+/// \brief Helpers for the memory usage of the exampleB4c process
+
+#ifndef B4MemoryProbe_h
+#define B4MemoryProbe_h 1
+
+#include "globals.hh"
+
+/// Memory usage of the process, read from /proc/self on Linux and from
+/// the task info on macOS; the peak falls back to getrusage() elsewhere.
+///
+/// The sizes are returned in bytes, or a negative value when they are not
+/// available, which Format() prints as "n/a".
+
+namespace B4MemoryProbe
+{
+  // Returns the current resident set size 
+  G4double GetResidentSize();
+
+  // Returns the peak resident set size
+  G4double GetPeakResidentSize();
+
+  // Returns the size in MB with one decimal, or "n/a"
+  G4String Format(G4double size);
+}
+
+#endif
@@ -0,0 +1,92 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4MergedVector.hh
+/// \brief Definition of the B4MergedVector class
+
+#ifndef B4MergedVector_h
+#define B4MergedVector_h 1
+
+#include "globals.hh"
+
+#include <mutex>
+#include <vector>
+
+/// Total over the threads of the vector data which G4Accumulable does not
+/// hold: the voxel maps of the dose mesh and of the optical readout, and 
+/// the neutron records. The scalar counters are G4Accumulable registered
+/// by the run action.
+///
+/// Master resets the total at the start of run. Each thread adds its own 
+/// data, bin by bin (Add) or at the end (Append), when it ends its run; 
+/// as the workers end their run first, master reads the total at the end
+/// of its run.
+
+template <typename T>
+class B4MergedVector
+{
+  public:
+    // Called by master at the start of run
+    void Reset(std::size_t size = 0);
+
+    // Called by each thread at the end of its run
+    void Add(const std::vector<T>& data);
+    void Append(const std::vector<T>& data);
+
+    const std::vector<T>& Get() const;
+
+  private:
+    std::vector<T> fTotal;
+    std::mutex fMutex;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <typename T>
+inline void B4MergedVector<T>::Reset(std::size_t size) {
+  fTotal.assign(size, T());
+}
+
+template <typename T>
+inline void B4MergedVector<T>::Add(const std::vector<T>& data) {
+  std::lock_guard<std::mutex> lock(fMutex);
+  if ( fTotal.size() < data.size() ) fTotal.resize(data.size(), T());
+  for ( std::size_t i=0; i<data.size(); ++i ) fTotal[i] += data[i];
+}
+
+template <typename T>
+inline void B4MergedVector<T>::Append(const std::vector<T>& data) {
+  std::lock_guard<std::mutex> lock(fMutex);
+  fTotal.insert(fTotal.end(), data.begin(), data.end());
+}
+
+template <typename T>
+inline const std::vector<T>& B4MergedVector<T>::Get() const {
+  return fTotal;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
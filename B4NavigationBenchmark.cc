@@ -0,0 +1,185 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4NavigationBenchmark.cc
+/// \brief Implementation of the B4NavigationBenchmark class
+
+#include "B4NavigationBenchmark.hh"
+
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4TransportationManager.hh"
+#include "G4Navigator.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4SmartVoxelHeader.hh"
+#include "G4SmartVoxelProxy.hh"
+#include "G4SmartVoxelNode.hh"
+#include "G4GenericMessenger.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4NavigationBenchmark* B4NavigationBenchmark::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4NavigationBenchmark* B4NavigationBenchmark::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4NavigationBenchmark();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4NavigationBenchmark::B4NavigationBenchmark()
+ : fMessenger(nullptr),
+   fEnabled(false),
+   fLayout(),
+   fVoxels()
+{
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/navigation/", 
+                             "Geometry navigation benchmark");
+
+  auto& benchmarkCmd 
+    = fMessenger->DeclareMethod("setBenchmark", 
+                                &B4NavigationBenchmark::SetEnabled,
+                                "Count the steps and print the navigation "
+                                "statistics at the end of run.");
+  benchmarkCmd.SetParameterName("enabled", true);
+  benchmarkCmd.SetDefaultValue("true");
+  benchmarkCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4NavigationBenchmark::~B4NavigationBenchmark()
+{ 
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4NavigationBenchmark::CollectVoxels(const G4SmartVoxelHeader* header,
+                                          VoxelStatistics& statistics)
+{
+  ++statistics.fNofHeaders;
+  statistics.fMemory += sizeof(G4SmartVoxelHeader);
+
+  // consecutive equivalent slices share the same proxy
+  auto nofSlices = G4int(header->GetNoSlices());
+  statistics.fNofSlices += nofSlices;
+  G4SmartVoxelProxy* previous = nullptr;
+  for ( G4int i=0; i<nofSlices; ++i ) {
+    auto proxy = header->GetSlice(i);
+    statistics.fMemory += sizeof(G4SmartVoxelProxy*);
+    if ( proxy == previous ) continue;
+    previous = proxy;
+    statistics.fMemory += sizeof(G4SmartVoxelProxy);
+
+    if ( proxy->IsHeader() ) {
+      CollectVoxels(proxy->GetHeader(), statistics);
+    }
+    else {
+      auto nofContained = G4int(proxy->GetNode()->GetNoContained());
+      ++statistics.fNofNodes;
+      statistics.fNofContained += nofContained;
+      statistics.fMaxContained 
+        = std::max(statistics.fMaxContained, nofContained);
+      statistics.fMemory 
+        += sizeof(G4SmartVoxelNode) + nofContained * sizeof(G4int);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4NavigationBenchmark::BeginOfRun()
+{
+  fVoxels = VoxelStatistics();
+  fLayout = "";
+  if ( ! fEnabled ) return;
+
+  // The geometry is closed, and voxelized, before the start of run
+  auto worldPV = G4TransportationManager::GetTransportationManager()
+                   ->GetNavigatorForTracking()->GetWorldVolume();
+  if ( ! worldPV ) return;
+  auto worldLV = worldPV->GetLogicalVolume();
+
+  std::set<const G4LogicalVolume*> logicalVolumes;
+  for ( std::size_t i=0; i<worldLV->GetNoDaughters(); ++i ) {
+    logicalVolumes.insert(worldLV->GetDaughter(i)->GetLogicalVolume());
+  }
+  std::ostringstream layout;
+  layout << worldLV->GetNoDaughters() << " placements of " 
+         << logicalVolumes.size() << " volumes, smartless " 
+         << worldLV->GetSmartless();
+  fLayout = layout.str();
+
+  if ( worldLV->GetVoxelHeader() ) {
+    CollectVoxels(worldLV->GetVoxelHeader(), fVoxels);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4NavigationBenchmark::EndOfRun(const G4Run* run, G4double nofTracks,
+                                     G4double nofSteps, 
+                                     G4double runTime) const
+{
+  if ( ! fEnabled ) return;
+
+  // the event loop time summed over the threads, which includes the 
+  // physics, the stacking and the output besides the navigation
+  auto nofThreads = G4RunManager::GetRunManager()->GetNumberOfThreads();
+  auto threadTime = runTime * std::max(nofThreads, 1);
+
+  // one line per run, to be collected from the logs of several settings
+  // (the precision of G4cout is restored)
+  auto precision = G4cout.precision();
+  G4cout << "### Navigation [" << fLayout << "] run " << run->GetRunID() 
+         << ": " << G4long(nofTracks) << " tracks, " << G4long(nofSteps) 
+         << " steps, " << std::fixed << std::setprecision(2)
+         << ( nofTracks > 0. ? nofSteps / nofTracks : 0. ) << " steps/track, "
+         << ( nofSteps > 0. ? threadTime / nofSteps * 1.e9 : 0. ) 
+         << " ns/step total; voxels: " << fVoxels.fNofHeaders << " headers, "
+         << fVoxels.fNofSlices << " slices, " << fVoxels.fNofNodes 
+         << " nodes, " 
+         << ( fVoxels.fNofNodes ? fVoxels.fNofContained / fVoxels.fNofNodes 
+                                : 0. )
+         << " volumes/node (max " << fVoxels.fMaxContained << "), " 
+         << fVoxels.fMemory / 1024. << " kB" << std::defaultfloat << G4endl;
+  G4cout.precision(precision);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
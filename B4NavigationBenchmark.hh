@@ -0,0 +1,110 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4NavigationBenchmark.hh
+/// \brief Definition of the B4NavigationBenchmark class
+
+#ifndef B4NavigationBenchmark_h
+#define B4NavigationBenchmark_h 1
+
+#include "globals.hh"
+
+class G4Run;
+class G4GenericMessenger;
+class G4SmartVoxelHeader;
+
+/// Benchmark of the geometry navigation.
+///
+/// The primaries are geantinos or charged geantinos fired by the /gps/
+/// source (see navigation.mac), so that the event time is spent in the 
+/// transportation. At the start of run, master collects the statistics 
+/// of the voxelization of the world volume; the steps and the tracks 
+/// are counted by the stepping action on each thread. At the end of run,
+/// master prints one line with the layout of the world (placements, 
+/// logical volumes, smartless), the number of steps per track, the 
+/// total time per step and the voxelization statistics, which can be
+/// compared between geometry settings (see B4cDetectorConstruction).
+///
+/// The time per step is the event loop time summed over the threads 
+/// divided by the number of steps: besides the navigation it includes 
+/// the physics (transportation only for geantinos), the stacking, the 
+/// user actions and the output, and it is therefore an upper bound of 
+/// the navigation time per step.
+///
+/// The following command is defined (on master only):
+/// - /B4/navigation/setBenchmark true|false
+
+class B4NavigationBenchmark
+{
+  public:
+    static B4NavigationBenchmark* Instance();
+    ~B4NavigationBenchmark();
+
+    // Called from the run action on master
+    void BeginOfRun();
+    void EndOfRun(const G4Run* run, G4double nofTracks, G4double nofSteps,
+                  G4double runTime) const;
+
+    // set/get methods
+    void   SetEnabled(G4bool enabled);
+    G4bool GetEnabled() const;
+
+  private:
+    B4NavigationBenchmark();
+
+    // Statistics of the voxelization of a volume
+    struct VoxelStatistics {
+      G4int fNofHeaders = 0;
+      G4int fNofNodes = 0;
+      G4int fNofSlices = 0;
+      G4int fMaxContained = 0;     ///< max number of volumes in a node
+      G4double fNofContained = 0.; ///< volumes summed over the nodes
+      G4double fMemory = 0.;       ///< bytes
+    };
+
+    static void CollectVoxels(const G4SmartVoxelHeader* header, 
+                              VoxelStatistics& statistics);
+
+    static B4NavigationBenchmark* fgInstance;
+
+    G4GenericMessenger* fMessenger;
+    G4bool fEnabled;
+    G4String fLayout;
+    VoxelStatistics fVoxels;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B4NavigationBenchmark::SetEnabled(G4bool enabled) {
+  fEnabled = enabled;
+}
+
+inline G4bool B4NavigationBenchmark::GetEnabled() const {
+  return fEnabled;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,74 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4OutputLayout.hh
+/// \brief Names of the objects written in the B4 output file
+
+#ifndef B4OutputLayout_h
+#define B4OutputLayout_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+/// Names of the histograms and of the ntuples written by B4RunAction.
+/// They are shared with the standalone tools which read the output files,
+/// so the booking in B4RunAction must follow the order defined here.
+
+namespace B4OutputLayout
+{
+  // H1 histograms, in the order of their IDs
+  const std::vector<G4String> kH1Names = {
+    "Eabs", "Egap", "Labs", "Lgap", "Ebot", "Lbot", "Eback", "Lback",
+    "Efront", "Lfront", "EtopR", "LtopR", "EtopL", "LtopL", "Etotal" };
+
+  // Ntuple with one row per event and its double columns,
+  // the energy deposit and track length of each panel, in the order of
+  // the corresponding histograms
+  const G4String kNtupleName = "B4";
+  const std::vector<G4String> kNtupleColumns = {
+    "Eabs", "Egap", "Labs", "Lgap", "Ebot", "Lbot", "Eback", "Lback",
+    "Efront", "Lfront", "EtopR", "LtopR", "EtopL", "LtopL" };
+
+  // Fine-binned energy spectra of the panels shared by the threads
+  // (B4SharedHistograms), in the order of the panels
+  const std::vector<G4String> kSpectrumNames = {
+    "Eabs", "Egap", "Ebot", "Eback", "Efront", "EtopR", "EtopL" };
+
+  // Ntuple of the digits, with one row per event with at least one digit:
+  // the event ID and the ADC value of each panel (0 without digit)
+  const G4String kDigiNtupleName = "B4digi";
+  const std::vector<G4String> kDigiNtupleColumns = {
+    "Event", "Aabs", "Agap", "Abot", "Aback", "Afront", "AtopR", "AtopL" };
+
+  // Ntuple of the optical readout of the liquid argon gap, with one row 
+  // per event: the event ID and the photoelectrons of each panel
+  const G4String kOpticalNtupleName = "B4optical";
+  const std::vector<G4String> kOpticalNtupleColumns = {
+    "Event", "PEabs", "PEgap", "PEbot", "PEback", "PEfront", "PEtopR", 
+    "PEtopL" };
+}
+
+#endif
@@ -0,0 +1,179 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4OutputReader.cc
+/// \brief Implementation of the B4OutputReader class
+
+#include "B4OutputReader.hh"
+
+#include "G4Version.hh"
+
+#include "tools/rroot/file"
+#include "tools/rroot/rall"
+#include "tools/rroot/streamers"
+#include "tools/rroot/fac"
+#include "tools/rroot/tree"
+#include "tools/rroot/ntuple"
+#include "tools/ntuple_binding"
+
+#include <algorithm>
+
+#if G4VERSION_NUMBER >= 1110
+#include "toolx/zlib"
+namespace B4Zip = toolx;
+#else
+#include "tools/zlib"
+namespace B4Zip = tools;
+#endif
+
+namespace {
+  // Returns a buffer positioned on the object of the given key
+  std::unique_ptr<tools::rroot::buffer> 
+  GetObjectBuffer(tools::rroot::file& file, const G4String& name,
+                  std::ostream& log) {
+    auto key = file.dir().find_key(name);
+    if ( ! key ) return nullptr;
+
+    unsigned int size;
+    auto charBuffer = key->get_object_buffer(file, size);
+    if ( ! charBuffer ) return nullptr;
+
+    std::unique_ptr<tools::rroot::buffer> buffer(
+      new tools::rroot::buffer(log, file.byte_swap(), size, charBuffer,
+                               key->key_length(), false));
+    buffer->set_map_objs(true);
+    return buffer;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4OutputReader::B4OutputReader(const G4String& fileName, std::ostream& log)
+ : fFile(new tools::rroot::file(log, fileName, false)),
+   fLog(log)
+{
+  if ( fFile->is_open() ) {
+    fFile->add_unziper('Z', B4Zip::decompress_buffer);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4OutputReader::~B4OutputReader()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4OutputReader::IsOpen() const
+{
+  return fFile->is_open();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+tools::histo::h1d* B4OutputReader::ReadH1(const G4String& name)
+{
+  auto buffer = GetObjectBuffer(*fFile, name, fLog);
+  if ( ! buffer ) return nullptr;
+
+  return tools::rroot::TH1D_stream(*buffer);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4long B4OutputReader::GetNtupleEntries(const G4String& name)
+{
+  auto buffer = GetObjectBuffer(*fFile, name, fLog);
+  if ( ! buffer ) return -1;
+
+  tools::rroot::fac fac(fLog);
+  tools::rroot::tree tree(*fFile, fac);
+  if ( ! tree.stream(*buffer) ) return -1;
+
+  return G4long(tree.entries());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <typename T>
+G4long B4OutputReader::ReadRows(const G4String& name, 
+                                const std::vector<G4String>& columns,
+                                G4long firstRow, G4long nofRows,
+                                const RowFunction& function)
+{
+  auto buffer = GetObjectBuffer(*fFile, name, fLog);
+  if ( ! buffer ) return -1;
+
+  tools::rroot::fac fac(fLog);
+  tools::rroot::tree tree(*fFile, fac);
+  if ( ! tree.stream(*buffer) ) return -1;
+
+  // bind the requested columns, with the type of the ntuple
+  std::vector<T> values(columns.size(), T(0));
+  tools::ntuple_binding binding;
+  for ( std::size_t i=0; i<columns.size(); ++i ) {
+    binding.add_column(columns[i], values[i]);
+  }
+
+  tools::rroot::ntuple ntuple(tree);
+  if ( ! ntuple.initialize(fLog, binding) ) return -1;
+
+  // next() only moves the row index, the values are read by get_row()
+  std::vector<G4double> row(columns.size(), 0.);
+  G4long index = 0;
+  G4long nofRead = 0;
+  ntuple.start();
+  while ( ntuple.next() ) {
+    if ( index++ < firstRow ) continue;
+    if ( nofRows >= 0 && nofRead >= nofRows ) break;
+    if ( ! ntuple.get_row() ) return -1;
+    std::copy(values.begin(), values.end(), row.begin());
+    function(row);
+    ++nofRead;
+  }
+  return nofRead;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4long B4OutputReader::ReadNtuple(const G4String& name, 
+                                  const std::vector<G4String>& columns,
+                                  G4long firstRow, G4long nofRows,
+                                  const RowFunction& function)
+{
+  return ReadRows<G4double>(name, columns, firstRow, nofRows, function);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4long B4OutputReader::ReadIntNtuple(const G4String& name, 
+                                     const std::vector<G4String>& columns,
+                                     G4long firstRow, G4long nofRows,
+                                     const RowFunction& function)
+{
+  return ReadRows<G4int>(name, columns, firstRow, nofRows, function);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,97 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4OutputReader.hh
+/// \brief Definition of the B4OutputReader class
+
+#ifndef B4OutputReader_h
+#define B4OutputReader_h 1
+
+#include "globals.hh"
+
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace tools {
+  namespace rroot { class file; }
+  namespace histo { class h1d; }
+}
+
+/// Reader of the Root files written by exampleB4c, used by the standalone
+/// tools.
+///
+/// It reads the histograms and the ntuple rows directly with the g4tools
+/// Root reader, without the thread-local G4RootAnalysisReader, so that 
+/// several files can be read concurrently, one reader per thread.
+
+class B4OutputReader
+{
+  public:
+    using RowFunction = std::function<void(const std::vector<G4double>&)>;
+
+    B4OutputReader(const G4String& fileName, std::ostream& log);
+    ~B4OutputReader();
+
+    G4bool IsOpen() const;
+
+    // Returns the named histogram (owned by the caller), 
+    // or nullptr if it is not found
+    tools::histo::h1d* ReadH1(const G4String& name);
+
+    // Returns the number of rows of the named ntuple, or -1 if it is 
+    // not found
+    G4long GetNtupleEntries(const G4String& name);
+
+    // Calls function for the rows [firstRow, firstRow + nofRows) of 
+    // the named ntuple with the values of the given double columns 
+    // (nofRows < 0 reads up to the last row).
+    // Returns the number of rows read, or -1 in case of error.
+    G4long ReadNtuple(const G4String& name, 
+                      const std::vector<G4String>& columns,
+                      G4long firstRow, G4long nofRows,
+                      const RowFunction& function);
+
+    // Same for the given int columns, whose values are passed as doubles
+    G4long ReadIntNtuple(const G4String& name, 
+                         const std::vector<G4String>& columns,
+                         G4long firstRow, G4long nofRows,
+                         const RowFunction& function);
+
+  private:
+    template <typename T>
+    G4long ReadRows(const G4String& name, 
+                    const std::vector<G4String>& columns,
+                    G4long firstRow, G4long nofRows,
+                    const RowFunction& function);
+
+    std::unique_ptr<tools::rroot::file> fFile;
+    std::ostream& fLog;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
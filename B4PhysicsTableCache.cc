@@ -0,0 +1,235 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4PhysicsTableCache.cc
+/// \brief Implementation of the B4PhysicsTableCache class
+
+#include "B4PhysicsTableCache.hh"
+#include "B4Cache.hh"
+
+#include "G4VUserPhysicsList.hh"
+#include "G4StateManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4EmParameters.hh"
+#include "G4Material.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4RegionStore.hh"
+#include "G4Region.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4Version.hh"
+
+#include <cstdlib>
+#include <filesystem>
+#include <set>
+#include <sstream>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+  // Data sets the tables are computed from
+  const char* kDataVariables[] 
+    = { "G4LEDATA", "G4LEVELGAMMADATA", "G4RADIOACTIVEDATA", 
+        "G4PARTICLEXSDATA", "G4ENSDFSTATEDATA" };
+
+  // Names of the materials of the volumes in the region, which with the
+  // region cuts give its material-cuts couples (the couples are not yet 
+  // built when the key is computed)
+  std::set<G4String> GetRegionMaterials(G4Region* region) {
+    std::set<G4String> materials;
+    std::vector<G4LogicalVolume*> toVisit;
+    auto rootVolume = region->GetRootLogicalVolumeIterator();
+    for ( std::size_t i=0; i<region->GetNumberOfRootVolumes(); ++i ) {
+      toVisit.push_back(*rootVolume++);
+    }
+    std::set<G4LogicalVolume*> visited;
+    while ( ! toVisit.empty() ) {
+      auto logicalVolume = toVisit.back();
+      toVisit.pop_back();
+      if ( ! visited.insert(logicalVolume).second ) continue;
+      if ( logicalVolume->GetMaterial() ) {
+        materials.insert(logicalVolume->GetMaterial()->GetName());
+      }
+      for ( std::size_t i=0; i<logicalVolume->GetNoDaughters(); ++i ) {
+        auto daughter = logicalVolume->GetDaughter(i)->GetLogicalVolume();
+        if ( daughter->GetRegion() == region ) toVisit.push_back(daughter);
+      }
+    }
+    return materials;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4PhysicsTableCache::B4PhysicsTableCache(G4VUserPhysicsList* physicsList,
+                                         const G4String& physicsName)
+ : G4VStateDependent(),
+   fPhysicsList(physicsList),
+   fPhysicsName(physicsName),
+   fMessenger(nullptr),
+   fEnabled(true),
+   fRetrieved(false),
+   fStoreDirectory()
+{
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/physicsCache/", 
+                             "Physics tables cache control");
+
+  auto& enableCmd 
+    = fMessenger->DeclareMethod("setEnabled", &B4PhysicsTableCache::SetEnabled,
+                                "Store and retrieve the physics tables.");
+  enableCmd.SetParameterName("enabled", true);
+  enableCmd.SetDefaultValue("true");
+  enableCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4PhysicsTableCache::~B4PhysicsTableCache()
+{ 
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String B4PhysicsTableCache::GetKeyDescription() const
+{
+  std::ostringstream description;
+  description << G4Version << G4endl << fPhysicsName << G4endl;
+  for ( auto variable : kDataVariables ) {
+    auto value = std::getenv(variable);
+    description << variable << "=" << ( value ? value : "" ) << G4endl;
+  }
+
+  G4EmParameters::Instance()->StreamInfo(description);
+
+  description << "default cut " << fPhysicsList->GetDefaultCutValue() 
+              << G4endl;
+  for ( auto region : *G4RegionStore::GetInstance() ) {
+    description << "region " << region->GetName();
+    auto cuts = region->GetProductionCuts();
+    if ( cuts ) {
+      for ( G4int i=0; i<NumberOfG4CutIndex; ++i ) {
+        description << " " << cuts->GetProductionCut(i);
+      }
+    }
+    description << " materials";
+    for ( const auto& material : GetRegionMaterials(region) ) {
+      description << " " << material;
+    }
+    description << G4endl;
+  }
+
+  description << *(G4Material::GetMaterialTable());
+  return description.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4PhysicsTableCache::Notify(G4ApplicationState requestedState)
+{
+  if ( ! fEnabled ) return true;
+
+  auto currentState = G4StateManager::GetStateManager()->GetCurrentState();
+  auto nofCouples 
+    = G4ProductionCutsTable::GetProductionCutsTable()->GetTableSize();
+
+  // Before the first build of the physics tables 
+  // (there are no material-cuts couples yet)
+  if ( currentState == G4State_Idle && requestedState == G4State_Init &&
+       nofCouples == 0 ) {
+    auto directory = B4Cache::GetDirectory() + "/physics-" 
+                   + B4Cache::GetKey(GetKeyDescription());
+
+    std::error_code error;
+    if ( std::filesystem::is_directory(directory.c_str(), error) ) {
+      fPhysicsList->SetPhysicsTableRetrieved(directory);
+      fRetrieved = true;
+      fStoreDirectory.clear();
+    }
+    else {
+      fPhysicsList->ResetPhysicsTableRetrieved();
+      fRetrieved = false;
+      fStoreDirectory = directory;
+    }
+  }
+
+  // After the physics tables are built
+  if ( currentState == G4State_Init && requestedState == G4State_Idle &&
+       nofCouples > 0 ) {
+    if ( fRetrieved ) {
+      G4cout << "### Physics tables retrieved from " 
+             << fPhysicsList->GetPhysicsTableDirectory() << G4endl;
+      // The workers build their tables from the master ones
+      fPhysicsList->ResetPhysicsTableRetrieved();
+      fRetrieved = false;
+    }
+    if ( fStoreDirectory.size() ) {
+      StoreTables();
+    }
+  }
+
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4PhysicsTableCache::StoreTables()
+{
+  auto directory = fStoreDirectory;
+  fStoreDirectory.clear();
+
+  std::error_code error;
+  if ( std::filesystem::is_directory(directory.c_str(), error) ) return;
+
+  // Write the tables aside and publish them with an atomic rename
+  std::ostringstream temporary;
+  temporary << directory << ".tmp" << ::getpid();
+  std::filesystem::remove_all(temporary.str(), error);
+  std::filesystem::create_directories(temporary.str(), error);
+  if ( error ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot create " << temporary.str() << ": " << error.message()
+        << ", the physics tables are not cached.";
+    G4Exception("B4PhysicsTableCache::StoreTables()",
+      "MyCode0011", JustWarning, msg);
+    return;
+  }
+
+  fPhysicsList->StorePhysicsTable(temporary.str());
+
+  std::filesystem::rename(temporary.str(), directory.c_str(), error);
+  if ( error ) {
+    // stored meanwhile by another job
+    std::filesystem::remove_all(temporary.str(), error);
+    return;
+  }
+  G4cout << "### Physics tables stored in " << directory << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,93 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4PhysicsTableCache.hh
+/// \brief Definition of the B4PhysicsTableCache class
+
+#ifndef B4PhysicsTableCache_h
+#define B4PhysicsTableCache_h 1
+
+#include "G4VStateDependent.hh"
+#include "globals.hh"
+
+class G4VUserPhysicsList;
+class G4GenericMessenger;
+
+/// Cache of the physics tables between jobs.
+///
+/// At the first run initialization on master (the Idle to Init transition
+/// just before the physics tables are built), a key is computed from the
+/// Geant4 version, the physics list name, the EM parameters, the 
+/// production cuts and the materials of the volumes of all regions, 
+/// which give the material-cuts couples, and the material table; a 
+/// change of the geometry which changes the couples (shield layers,
+/// liquid argon gap) therefore gives a new key. If the cache
+/// (see B4Cache) holds tables for this key, the physics list is set to 
+/// retrieve them; otherwise the tables are built and, at the end of the
+/// initialization, stored in a temporary directory which is then renamed
+/// to the key directory, so that concurrent jobs never read incomplete
+/// tables. A changed configuration gives a new key, and the tables are 
+/// rebuilt. The retrieval is reset before the workers initialize, which
+/// keep sharing the master tables.
+///
+/// Only the tables handled by the processes Store/RetrievePhysicsTable() 
+/// (mostly electromagnetic) are cached.
+///
+/// The following command is defined:
+/// - /B4/physicsCache/setEnabled true|false
+
+class B4PhysicsTableCache : public G4VStateDependent
+{
+  public:
+    B4PhysicsTableCache(G4VUserPhysicsList* physicsList, 
+                        const G4String& physicsName);
+    virtual ~B4PhysicsTableCache();
+
+    virtual G4bool Notify(G4ApplicationState requestedState);
+
+    // set methods
+    void SetEnabled(G4bool value);
+
+  private:
+    G4String GetKeyDescription() const;
+    void StoreTables();
+
+    G4VUserPhysicsList* fPhysicsList;
+    G4String fPhysicsName;
+    G4GenericMessenger* fMessenger;
+    G4bool fEnabled;
+    G4bool fRetrieved;
+    G4String fStoreDirectory;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B4PhysicsTableCache::SetEnabled(G4bool value) {
+  fEnabled = value;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
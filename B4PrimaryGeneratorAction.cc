@@ -29,13 +29,21 @@
 /// \brief Implementation of the B4PrimaryGeneratorAction class
 
 #include "B4PrimaryGeneratorAction.hh"
+#include "B4EventSeeder.hh"
+#include "B4cCheckpoint.hh"
+#include "B4IbdGenerator.hh"
+#include "B4CosmicGenerator.hh"
+#include "B4RunAction.hh"
+#include "B4cOpticalReadout.hh"
 
 #include "G4RunManager.hh"
 #include "G4LogicalVolumeStore.hh"
 #include "G4LogicalVolume.hh"
 #include "G4Box.hh"
 #include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4ParticleGun.hh"
+#include "G4GenericMessenger.hh"
 #include "G4GeneralParticleSource.hh"
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
@@ -44,9 +52,15 @@
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-B4PrimaryGeneratorAction::B4PrimaryGeneratorAction()
+B4PrimaryGeneratorAction::B4PrimaryGeneratorAction(B4RunAction* runAction)
  : G4VUserPrimaryGeneratorAction(),
-   fGeneralParticleSource()
+   fGeneralParticleSource(),
+   fIbdGenerator(nullptr),
+   fCosmicGenerator(nullptr),
+   fGenerator("gps"),
+   fRunAction(runAction),
+   fPosition(0., 0., 0.),
+   fMessenger(nullptr)
 {
   G4int nofParticles = 1;
   fGeneralParticleSource = new G4GeneralParticleSource();
@@ -56,6 +70,24 @@ B4PrimaryGeneratorAction::B4PrimaryGeneratorAction()
   auto particleDefinition 
     = G4ParticleTable::GetParticleTable()->FindParticle("alpha");
   fGeneralParticleSource->SetParticleDefinition(particleDefinition);
+
+  // antineutrino interactions, selected with /B4/gun/setGenerator
+  fIbdGenerator = new B4IbdGenerator();
+  fCosmicGenerator = new B4CosmicGenerator();
+
+  // source position command, defined on each thread
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/gun/", "Primary source control");
+  auto& positionCmd 
+    = fMessenger->DeclarePropertyWithUnit("setPosition", "mm", fPosition,
+                                          "Set the displacement of the "
+                                          "source from its /gps/ position.");
+  positionCmd.SetParameterName("x", "y", "z", false);
+  auto& generatorCmd
+    = fMessenger->DeclareProperty("setGenerator", fGenerator,
+                                  "Select the primary generator.");
+  generatorCmd.SetParameterName("generator", false);
+  generatorCmd.SetCandidates("gps ibd cosmic");
 //  fGeneralParticleSource->SetParticleMomentumDirection(G4ThreeVector(0.,0.,1.));
 //  fGeneralParticleSource->SetParticleEnergy(5.*MeV);
 }
@@ -72,6 +104,9 @@ B4PrimaryGeneratorAction::B4PrimaryGeneratorAction()
 
 B4PrimaryGeneratorAction::~B4PrimaryGeneratorAction()
 {
+  delete fMessenger;
+  delete fCosmicGenerator;
+  delete fIbdGenerator;
   delete fGeneralParticleSource;
 }
 
@@ -81,6 +116,26 @@ void B4PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
   // This function is called at the begining of event
 
+  // Seed the event independently of the thread which processes it
+  B4EventSeeder::Instance()->SeedEvent(anEvent);
+
+  // The restored events are part of the live time of the cosmic muons
+  if ( fGenerator == "cosmic" && fRunAction ) {
+    fRunAction->AddLiveTime(fCosmicGenerator->GetLiveTimePerMuon());
+  }
+
+  // The events restored from a checkpoint are not simulated again
+  if ( B4cCheckpoint::Instance()->GetRestoredRecord(anEvent->GetEventID()) ) {
+    return;
+  }
+
+  // The optical map is built from photons emitted in the gap
+  auto opticalReadout = B4cOpticalReadout::Instance();
+  if ( opticalReadout->IsBuilding() ) {
+    opticalReadout->GeneratePrimaries(anEvent);
+    return;
+  }
+
   // In order to avoid dependence of PrimaryGeneratorAction
   // on DetectorConstruction class we get world volume 
   // from G4LogicalVolumeStore
@@ -106,11 +161,27 @@ void B4PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
       "MyCode0002", JustWarning, msg);
   } 
   
-  // Set gun position
-  fGeneralParticleSource
-    ->SetParticlePosition(G4ThreeVector(0., 0., 0.));
+  if ( fGenerator == "ibd" ) {
+    fIbdGenerator->SetParticlePosition(fPosition);
+    fIbdGenerator->GeneratePrimaryVertex(anEvent);
+    return;
+  }
+
+  if ( fGenerator == "cosmic" ) {
+    fCosmicGenerator->GeneratePrimaryVertex(anEvent);
+    return;
+  }
 
   fGeneralParticleSource->GeneratePrimaryVertex(anEvent);
+
+  // Displace the source: the position set on the source is ignored 
+  // by the GPS, which samples its own position distribution
+  auto vertex = anEvent->GetPrimaryVertex();
+  if ( vertex ) {
+    vertex->SetPosition(vertex->GetX0() + fPosition.x(), 
+                        vertex->GetY0() + fPosition.y(),
+                        vertex->GetZ0() + fPosition.z());
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -34,8 +34,13 @@
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "globals.hh"
 #include "G4GeneralParticleSource.hh"
+#include "G4ThreeVector.hh"
 
 class G4GeneralParticleSource;
+class B4IbdGenerator;
+class B4CosmicGenerator;
+class B4RunAction;
+class G4GenericMessenger;
 class G4Event;
 
 /// The primary generator action class with particle gum.
@@ -44,11 +49,25 @@ class G4Event;
 /// perpendicular to the input face. The type of the particle
 /// can be changed via the G4 build-in commands of G4ParticleGun class 
 /// (see the macros provided with this example).
+/// Each event is seeded first via B4EventSeeder, so that its random 
+/// sequence does not depend on the thread which processes it.
+/// No primaries are generated for the events restored from a checkpoint
+/// (see B4cCheckpoint).
+/// The source is displaced from its /gps/ position via 
+/// /B4/gun/setPosition x y z unit.
+/// The inverse beta decay generator (see B4IbdGenerator) is used instead
+/// of the GPS after /B4/gun/setGenerator ibd; its vertex is then at the
+/// displacement position, unless a target volume is set.
+/// The cosmic muon generator (see B4CosmicGenerator) is used after 
+/// /B4/gun/setGenerator cosmic; the live time of each event, restored 
+/// or not, is then added to the run action.
+/// When the optical map is built, the optical photons are generated by 
+/// B4cOpticalReadout instead.
 
 class B4PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
 public:
-  B4PrimaryGeneratorAction();    
+  B4PrimaryGeneratorAction(B4RunAction* runAction = nullptr);
   virtual ~B4PrimaryGeneratorAction();
 
   virtual void GeneratePrimaries(G4Event* event);
@@ -58,6 +77,12 @@ public:
 
 private:
   G4GeneralParticleSource*  fGeneralParticleSource; // G4 particle gun
+  B4IbdGenerator*           fIbdGenerator;
+  B4CosmicGenerator*        fCosmicGenerator;
+  G4String                  fGenerator;             // gps, ibd or cosmic
+  B4RunAction*              fRunAction;
+  G4ThreeVector             fPosition;              // source displacement
+  G4GenericMessenger*       fMessenger;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
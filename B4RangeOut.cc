@@ -0,0 +1,239 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4RangeOut.cc
+/// \brief Implementation of the B4RangeOut class
+
+#include "B4RangeOut.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4ProcessManager.hh"
+#include "G4LossTableManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4AccumulableManager.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4RangeOut* B4RangeOut::fgInstance = nullptr;
+G4ThreadLocal B4RangeOut::Counters* B4RangeOut::fgCounters = nullptr;
+G4ThreadLocal std::unordered_map<G4int, G4double>* B4RangeOut::fgFlagged 
+  = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4RangeOut* B4RangeOut::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4RangeOut();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4RangeOut::B4RangeOut()
+ : fMessenger(nullptr),
+   fEnabled(false),
+   fSafetyMargin(10.*um),
+   fMeasureOnly(false)
+{
+  // The policy is shared by all threads: 
+  // the commands are executed on master only
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/rangeOut/", 
+                             "Local deposition of the range-out tracks");
+
+  auto& enabledCmd 
+    = fMessenger->DeclareMethod("setEnabled", &B4RangeOut::SetEnabled,
+                                "Deposit locally the energy of the tracks "
+                                "ranging out in a panel.");
+  enabledCmd.SetParameterName("enabled", true);
+  enabledCmd.SetDefaultValue("true");
+  enabledCmd.SetStates(G4State_PreInit, G4State_Idle);
+  enabledCmd.command->SetToBeBroadcasted(false);
+
+  auto& marginCmd 
+    = fMessenger->DeclareMethodWithUnit("setSafetyMargin", "um",
+                                        &B4RangeOut::SetSafetyMargin,
+                                        "Set the margin added to the "
+                                        "residual range.");
+  marginCmd.SetParameterName("margin", false);
+  marginCmd.SetRange("margin>=0.");
+  marginCmd.SetStates(G4State_PreInit, G4State_Idle);
+  marginCmd.command->SetToBeBroadcasted(false);
+
+  auto& measureCmd 
+    = fMessenger->DeclareMethod("setMeasureOnly", &B4RangeOut::SetMeasureOnly,
+                                "Only count the steps which would be saved, "
+                                "without stopping the tracks.");
+  measureCmd.SetParameterName("measureOnly", true);
+  measureCmd.SetDefaultValue("true");
+  measureCmd.SetStates(G4State_PreInit, G4State_Idle);
+  measureCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4RangeOut::~B4RangeOut()
+{ 
+  delete fgCounters;
+  fgCounters = nullptr;
+  delete fgFlagged;
+  fgFlagged = nullptr;
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4RangeOut::BeginOfRun()
+{
+  if ( ! fEnabled ) return;
+
+  // The counters are reset by the run action
+  if ( ! fgFlagged ) {
+    fgFlagged = new std::unordered_map<G4int, G4double>();
+  }
+  fgFlagged->clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4RangeOut::BeginOfEvent()
+{
+  // the track IDs are numbered again in each event
+  if ( fgFlagged ) fgFlagged->clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4RangeOut::EndOfRun(G4bool isMaster)
+{
+  if ( ! fEnabled || ! isMaster ) return;
+
+  auto nofSteps = fgCounters->fNofSteps.GetValue();
+  G4cout << "### Range-out (margin " << G4BestUnit(fSafetyMargin, "Length");
+  if ( fMeasureOnly ) {
+    auto nofSavedSteps = fgCounters->fNofSavedSteps.GetValue();
+    G4cout << ", measure only): " << nofSteps 
+           << " steps in the panels, " << fgCounters->fNofTracks.GetValue() 
+           << " tracks to stop, " << nofSavedSteps << " steps to save, " 
+           << nofSteps - nofSavedSteps << " steps expected with the policy";
+  }
+  else {
+    G4cout << "): " << nofSteps 
+           << " steps in the panels, " << fgCounters->fNofTracks.GetValue() 
+           << " tracks stopped, " 
+           << G4BestUnit(fgCounters->fEnergy.GetValue(), "Energy")
+           << " deposited locally (approximation)";
+  }
+  G4cout << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4RangeOut::RegisterAccumulables()
+{
+  if ( fgCounters ) return;
+
+  fgCounters = new Counters();
+  auto accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->RegisterAccumulable(fgCounters->fNofSteps);
+  accumulableManager->RegisterAccumulable(fgCounters->fNofTracks);
+  accumulableManager->RegisterAccumulable(fgCounters->fEnergy);
+  accumulableManager->RegisterAccumulable(fgCounters->fNofSavedSteps);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4RangeOut::IsFlagged(const G4Step* step) const
+{
+  // a track is flagged after its range-out step, a secondary from its 
+  // creation if it was produced by a flagged track after that step 
+  // (the secondaries of the range-out step itself are not saved)
+  auto track = step->GetTrack();
+  if ( fgFlagged->count(track->GetTrackID()) ) return true;
+  if ( track->GetCurrentStepNumber() != 1 ) return false;
+
+  auto parent = fgFlagged->find(track->GetParentID());
+  if ( parent == fgFlagged->end() ) return false;
+  auto creationTime = step->GetPreStepPoint()->GetGlobalTime();
+  if ( creationTime <= parent->second ) return false;
+
+  fgFlagged->emplace(track->GetTrackID(), creationTime);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4RangeOut::DoApply(G4Step* step, G4double& residualRange)
+{
+  // The flagged tracks are allocated at the start of run
+  if ( ! fgFlagged ) return 0.;
+  fgCounters->fNofSteps += 1.;
+
+  auto track = step->GetTrack();
+  if ( fMeasureOnly && IsFlagged(step) ) {
+    fgCounters->fNofSavedSteps += 1.;
+    return 0.;
+  }
+
+  if ( track->GetTrackStatus() != fAlive ) return 0.;
+
+  // the safety is null on the panel boundary
+  auto postStepPoint = step->GetPostStepPoint();
+  if ( postStepPoint->GetStepStatus() == fGeomBoundary ) return 0.;
+
+  auto particle = track->GetDefinition();
+  if ( particle->GetPDGCharge() == 0. ) return 0.;
+  auto processManager = particle->GetProcessManager();
+  if ( ! processManager || 
+       processManager->GetAtRestProcessVector()->entries() > 0 ) return 0.;
+
+  auto kineticEnergy = postStepPoint->GetKineticEnergy();
+  if ( kineticEnergy <= 0. ) return 0.;
+
+  // DBL_MAX for the particles without energy loss tables
+  auto range 
+    = G4LossTableManager::Instance()->GetRange(
+        particle, kineticEnergy, postStepPoint->GetMaterialCutsCouple());
+  if ( range + fSafetyMargin >= postStepPoint->GetSafety() ) return 0.;
+
+  fgCounters->fNofTracks += 1.;
+  if ( fMeasureOnly ) {
+    fgFlagged->emplace(track->GetTrackID(), 
+                       postStepPoint->GetGlobalTime());
+    return 0.;
+  }
+
+  fgCounters->fEnergy += kineticEnergy;
+  track->SetTrackStatus(fStopAndKill);
+  residualRange = range;
+  return kineticEnergy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
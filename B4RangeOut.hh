@@ -0,0 +1,154 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4RangeOut.hh
+/// \brief Definition of the B4RangeOut class
+
+#ifndef B4RangeOut_h
+#define B4RangeOut_h 1
+
+#include "globals.hh"
+#include "G4Accumulable.hh"
+
+#include <unordered_map>
+
+class G4Step;
+class G4GenericMessenger;
+
+/// Local deposition of the charged particles ranging out in a panel.
+///
+/// At each step in a panel, a charged particle whose residual range 
+/// (from the energy loss tables, at its post-step energy) plus a safety
+/// margin is shorter than the distance to the nearest panel boundary
+/// (the safety of the post-step point) is assumed not to leave the 
+/// panel: its kinetic energy is deposited at once in the hit of the 
+/// panel and the track is killed.
+///
+/// The local deposition is an approximation. The range is a mean path
+/// length: the restricted range is used, which is longer than the 
+/// continuous slowing down range, and the path length is longer than 
+/// the distance travelled, but a track can still go beyond its mean 
+/// range by range straggling. The margin is the length added to the 
+/// range to cover this straggling: a larger margin stops fewer tracks 
+/// and moves the panel totals closer to the full tracking. The energy 
+/// carried out of the panel by the secondaries which would have been 
+/// produced later (bremsstrahlung and fluorescence photons, delta rays 
+/// above the production cut) is deposited in the panel instead. The 
+/// particles with processes at rest (e+, mu, pi-, ...) are not stopped.
+///
+/// The steps in the panels, the tracks stopped and the energy deposited
+/// locally are counted on each thread and printed by master at the end 
+/// of run, in both modes. In measure-only mode, the tracks are only 
+/// flagged and the steps done afterwards by them and by their later 
+/// secondaries in the panels are counted as the steps to save; the 
+/// steps expected with the policy (steps minus steps to save) can then 
+/// be compared with the steps of a run with the policy applied, which 
+/// gives the steps actually saved (see rangeout.mac).
+///
+/// The following commands are defined (on master only):
+/// - /B4/rangeOut/setEnabled true|false
+/// - /B4/rangeOut/setSafetyMargin value unit
+/// - /B4/rangeOut/setMeasureOnly true|false
+
+class B4RangeOut
+{
+  public:
+    static B4RangeOut* Instance();
+    ~B4RangeOut();
+
+    // Called from the run and event actions
+    void BeginOfRun();
+    void BeginOfEvent();
+    void EndOfRun(G4bool isMaster);
+
+    // Called from the run action constructor on each thread
+    void RegisterAccumulables();
+
+    // Called by the panel sensitive detectors at each step;
+    // returns the energy to be deposited locally and the residual range
+    // of the stopped track
+    G4double Apply(G4Step* step, G4double& residualRange);
+
+    // set/get methods
+    void   SetEnabled(G4bool enabled);
+    G4bool GetEnabled() const;
+    void   SetSafetyMargin(G4double margin);
+    void   SetMeasureOnly(G4bool measureOnly);
+    G4bool GetMeasureOnly() const;
+
+  private:
+    B4RangeOut();
+
+    // Counters of this thread, registered with the accumulable manager
+    struct Counters {
+      G4Accumulable<G4double> fNofSteps { "RangeOutSteps", 0. };
+      G4Accumulable<G4double> fNofTracks { "RangeOutTracks", 0. };
+      G4Accumulable<G4double> fEnergy { "RangeOutEnergy", 0. };
+      G4Accumulable<G4double> fNofSavedSteps { "RangeOutSavedSteps", 0. };
+    };
+
+    G4double DoApply(G4Step* step, G4double& residualRange);
+    G4bool   IsFlagged(const G4Step* step) const;
+
+    static B4RangeOut* fgInstance;
+    static G4ThreadLocal Counters* fgCounters;
+    // flagged track IDs and their time at the range-out step
+    static G4ThreadLocal std::unordered_map<G4int, G4double>* fgFlagged;
+
+    G4GenericMessenger* fMessenger;
+    G4bool   fEnabled;
+    G4double fSafetyMargin;
+    G4bool   fMeasureOnly;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline G4double B4RangeOut::Apply(G4Step* step, G4double& residualRange) {
+  residualRange = 0.;
+  return fEnabled ? DoApply(step, residualRange) : 0.;
+}
+
+inline void B4RangeOut::SetEnabled(G4bool enabled) {
+  fEnabled = enabled;
+}
+
+inline G4bool B4RangeOut::GetEnabled() const {
+  return fEnabled;
+}
+
+inline void B4RangeOut::SetSafetyMargin(G4double margin) {
+  fSafetyMargin = margin;
+}
+
+inline void B4RangeOut::SetMeasureOnly(G4bool measureOnly) {
+  fMeasureOnly = measureOnly;
+}
+
+inline G4bool B4RangeOut::GetMeasureOnly() const {
+  return fMeasureOnly;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -30,23 +30,144 @@
 
 #include "B4RunAction.hh"
 #include "B4Analysis.hh"
+#include "B4OutputLayout.hh"
+#include "B4StartupReport.hh"
+#include "B4SharedHistograms.hh"
+#include "B4NavigationBenchmark.hh"
+#include "B4MemoryProbe.hh"
+#include "B4cCheckpoint.hh"
+#include "B4cMemoryReport.hh"
+#include "B4cSiliconResponse.hh"
+#include "B4cScoringMesh.hh"
+#include "B4RangeOut.hh"
+#include "B4cEventKeeper.hh"
+#include "B4SubEventSplitter.hh"
+#include "B4cNeutronCapture.hh"
+#include "B4cOpticalReadout.hh"
+#include "B4cTrigger.hh"
+#include "B4cShield.hh"
+#include "B4cEventRecord.hh"
 
 #include "G4Run.hh"
 #include "G4RunManager.hh"
+#include "G4MTRunManager.hh"
 #include "G4UnitsTable.hh"
+#include "G4AccumulableManager.hh"
 #include "G4SystemOfUnits.hh"
 
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <regex>
+
+namespace {
+  // Number of event batches handed to each worker thread per run.
+  // Short events make the default sqrt(nEvents/nThreads) batching 
+  // dominated by the master-worker communication.
+  const G4int kBatchesPerThread = 10;
+
+  // Returns the output type, given by the file name extension 
+  // or by the default file type
+  G4String GetFileType(const G4String& fileName) {
+    auto extension = std::filesystem::path(fileName.c_str()).extension();
+    if ( ! extension.empty() ) return extension.string().substr(1);
+    return G4AnalysisManager::Instance()->GetDefaultFileType();
+  }
+
+  // Sums the size of the files written for the given output file name:
+  // name.type, and for the types writing several files 
+  // name_t<N>.type, name_h1_<h1>.type, name_nt_<ntuple>[_t<N>].type
+  G4double GetOutputSize(const G4String& fileName, const G4String& fileType,
+                         G4int& nofFiles) {
+    std::filesystem::path path(fileName.c_str());
+    auto directory = path.parent_path();
+    if ( directory.empty() ) directory = ".";
+    auto stem = std::regex_replace(path.stem().string(), 
+                                   std::regex(R"([.^$|()\[\]{}*+?\\])"), 
+                                   R"(\$&)");
+    std::regex pattern(
+      stem + "(_t[0-9]+|_(h1|nt)_.+)?\\." + fileType.c_str());
+
+    G4double size = 0.;
+    nofFiles = 0;
+    std::error_code error;
+    for ( const auto& entry 
+            : std::filesystem::directory_iterator(directory, error) ) {
+      if ( ! entry.is_regular_file(error) ||
+           ! std::regex_match(entry.path().filename().string(), pattern) ) {
+        continue;
+      }
+      size += entry.file_size(error);
+      ++nofFiles;
+    }
+    return size;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String B4RunAction::fgFileTag;
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 B4RunAction::B4RunAction()
- : G4UserRunAction()
+ : G4UserRunAction(),
+   fTunedEventModulo(0),
+   fRunStart(),
+   fOutputTime("OutputTime", 0.),
+   fNofDigits(),
+   fNofSteps("NofSteps", 0.),
+   fNofTracks("NofTracks", 0.),
+   fLiveTime("LiveTime", 0.),
+   fWeightedEdep(),
+   fWeightedEdep2()
 { 
   // set printing event number per each event
   G4RunManager::GetRunManager()->SetPrintProgress(1);     
 
+  // Register the time spent in filling and writing the output,
+  // summed over the threads
+  G4AccumulableManager::Instance()->RegisterAccumulable(fOutputTime);
+
+  // Register the number of digits per panel
+  // (the vector is not resized after the registration)
+  fNofDigits.reserve(B4cEventRecord::kNofPanels);
+  for ( std::size_t i=0; i<B4cEventRecord::kNofPanels; ++i ) {
+    fNofDigits.emplace_back("NofDigits" + std::to_string(i), 0.);
+    G4AccumulableManager::Instance()->RegisterAccumulable(fNofDigits.back());
+  }
+
+  // Register the step and track counts of the navigation benchmark
+  G4AccumulableManager::Instance()->RegisterAccumulable(fNofSteps);
+  G4AccumulableManager::Instance()->RegisterAccumulable(fNofTracks);
+
+  // Register the live time of the cosmic muons
+  G4AccumulableManager::Instance()->RegisterAccumulable(fLiveTime);
+
+  // Register the sums of the weighted deposits of the biased shield 
+  // transport, and of their squares, per panel
+  fWeightedEdep.reserve(B4cEventRecord::kNofPanels);
+  fWeightedEdep2.reserve(B4cEventRecord::kNofPanels);
+  for ( std::size_t i=0; i<B4cEventRecord::kNofPanels; ++i ) {
+    fWeightedEdep.emplace_back("WeightedEdep" + std::to_string(i), 0.);
+    fWeightedEdep2.emplace_back("WeightedEdep2_" + std::to_string(i), 0.);
+    G4AccumulableManager::Instance()->RegisterAccumulable(
+      fWeightedEdep.back());
+    G4AccumulableManager::Instance()->RegisterAccumulable(
+      fWeightedEdep2.back());
+  }
+
+  // Register the counters of the range-out policy, of the neutron capture,
+  // of the optical readout and of the trigger, kept by their classes
+  B4RangeOut::Instance()->RegisterAccumulables();
+  B4cNeutronCapture::Instance()->RegisterAccumulables();
+  B4cOpticalReadout::Instance()->RegisterAccumulables();
+  B4cTrigger::Instance()->RegisterAccumulables();
+
   // Create analysis manager
-  // The choice of analysis technology is done via selectin of a namespace
-  // in B4Analysis.hh
+  // The choice of analysis technology is done at run time, 
+  // see B4Analysis.hh
   auto analysisManager = G4AnalysisManager::Instance();
   G4cout << "Using " << analysisManager->GetType() << G4endl;
 
@@ -54,13 +175,16 @@ B4RunAction::B4RunAction()
   //analysisManager->SetHistoDirectoryName("histograms");
   //analysisManager->SetNtupleDirectoryName("ntuple");
   analysisManager->SetVerboseLevel(1);
-  analysisManager->SetNtupleMerging(true);
-    // Note: merging ntuples is available only with Root output
+  // Default output file name and type, can be changed via 
+  // /analysis/setFileName and /analysis/setDefaultFileType
+  analysisManager->SetDefaultFileType("root");
+  analysisManager->SetFileName("B4");
 
   // Book histograms, ntuple
   //
   
   // Creating histograms
+  // (in the order of B4OutputLayout::kH1Names)
   analysisManager->CreateH1("Eabs","Edep in RHS detector", 100, 0.000001, 5.*MeV);
   analysisManager->CreateH1("Egap","Edep in LHS detector", 100, 0.000001, 5.*MeV);
   analysisManager->CreateH1("Labs","trackL in absorber", 100, 0., 1*cm);
@@ -82,41 +206,204 @@ B4RunAction::B4RunAction()
 
   // Creating ntuple
   //
-  analysisManager->CreateNtuple("B4", "Edep and TrackL");
-  analysisManager->CreateNtupleDColumn("Eabs");
-  analysisManager->CreateNtupleDColumn("Egap");
-  analysisManager->CreateNtupleDColumn("Labs");
-  analysisManager->CreateNtupleDColumn("Lgap");
+  analysisManager->CreateNtuple(B4OutputLayout::kNtupleName, "Edep and TrackL");
+  for ( const auto& column : B4OutputLayout::kNtupleColumns ) {
+    analysisManager->CreateNtupleDColumn(column);
+  }
+  analysisManager->FinishNtuple();
+
+  // Creating the digits ntuple
+  //
+  analysisManager->CreateNtuple(B4OutputLayout::kDigiNtupleName, "Panel digits");
+  for ( const auto& column : B4OutputLayout::kDigiNtupleColumns ) {
+    analysisManager->CreateNtupleIColumn(column);
+  }
   analysisManager->FinishNtuple();
+
+  // Creating the optical readout ntuple
+  //
+  analysisManager->CreateNtuple(B4OutputLayout::kOpticalNtupleName, 
+                                "Panel photoelectrons");
+  for ( const auto& column : B4OutputLayout::kOpticalNtupleColumns ) {
+    analysisManager->CreateNtupleIColumn(column);
+  }
+  analysisManager->FinishNtuple();
+
+  // The objects written are selected at each run
+  analysisManager->SetActivation(true);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 B4RunAction::~B4RunAction()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String B4RunAction::TagFileName(const G4String& fileName, 
+                                  const G4String& tag)
 {
-  delete G4AnalysisManager::Instance();  
+  // a tag already present is moved before the extension, so that the
+  // name is tagged once
+  auto dot = fileName.rfind('.');
+  auto slash = fileName.rfind('/');
+  if ( dot == std::string::npos || 
+       ( slash != std::string::npos && dot < slash ) ) {
+    dot = fileName.size();
+  }
+  std::string stem = fileName.substr(0, dot);
+  auto position = stem.find(tag);
+  if ( position != std::string::npos ) stem.erase(position, tag.size());
+  return stem + tag + fileName.substr(dot);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void B4RunAction::BeginOfRunAction(const G4Run* /*run*/)
+void B4RunAction::TuneEventModulo(G4int nofEvents)
+{
+  // Applies only to the MT and tasking run managers
+  auto mtRunManager 
+    = dynamic_cast<G4MTRunManager*>(G4RunManager::GetRunManager());
+  if ( ! mtRunManager || nofEvents <= 0 ) return;
+
+  // Keep the value set by the user via /run/eventModulo
+  auto eventModulo = mtRunManager->GetEventModulo();
+  if ( eventModulo > 0 && eventModulo != fTunedEventModulo ) return;
+
+  auto nofThreads = std::max(mtRunManager->GetNumberOfThreads(), 1);
+  eventModulo = std::max(nofEvents / (nofThreads * kBatchesPerThread), 1);
+  mtRunManager->SetEventModulo(eventModulo);
+  // One seed per batch instead of one per event
+  G4MTRunManager::SetSeedOncePerCommunication(1);
+  fTunedEventModulo = eventModulo;
+
+  G4cout << "### Event modulo set to " << eventModulo 
+         << " (" << nofEvents << " events, " << nofThreads << " threads)" 
+         << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4RunAction::BeginOfRunAction(const G4Run* run)
 { 
+  // tune the event batching before the workers start the event loop
+  if ( isMaster ) {
+    // refuse the features whose event state is not merged
+    B4SubEventSplitter::Instance()->BeginOfRun();
+
+    TuneEventModulo(run->GetNumberOfEventToBeProcessed());
+
+    // the physics tables are built at the start of the first run
+    B4StartupReport::Mark("first run initialization");
+    B4StartupReport::Print();
+
+    // book the shared histograms before the workers fill them
+    B4SharedHistograms::Instance()->BeginOfRun(B4OutputLayout::kSpectrumNames);
+
+    // collect the voxelization statistics of the closed geometry
+    B4NavigationBenchmark::Instance()->BeginOfRun();
+
+    // clear the keys of the kept events
+    B4cEventKeeper::Instance()->BeginOfRun();
+
+    fRunStart = std::chrono::steady_clock::now();
+  }
+
   //inform the runManager to save random number seed
   //G4RunManager::GetRunManager()->SetRandomNumberStore(true);
+  // (the events are seeded by B4EventSeeder from their key)
+
+  // Restore the checkpointed events when resuming
+  B4cCheckpoint::Instance()->BeginOfRun(run, isMaster);
+
+  // Clear the dose and fluence maps
+  B4cScoringMesh::Instance()->BeginOfRun(isMaster);
+
+  // Clear the tracks flagged by the range-out policy
+  B4RangeOut::Instance()->BeginOfRun();
+
+  // Clear the neutron records, read the capture table
+  B4cNeutronCapture::Instance()->BeginOfRun(isMaster);
+
+  // Clear the optical map sums, read the optical map
+  auto opticalReadout = B4cOpticalReadout::Instance();
+  opticalReadout->BeginOfRun(isMaster);
+
+  // Collect the panels of the trigger
+  B4cTrigger::Instance()->BeginOfRun(isMaster);
+
+  // Fill the importances of the shield cells
+  B4cShield::Instance()->BeginOfRun(isMaster);
   
+  // Reset the accumulables, including the counters of the features above
+  G4AccumulableManager::Instance()->Reset();
+
   // Get analysis manager
   auto analysisManager = G4AnalysisManager::Instance();
 
+  // Tag the file name set for this run, on each thread
+  if ( fgFileTag.size() ) {
+    analysisManager->SetFileName(
+      TagFileName(analysisManager->GetFileName(), fgFileTag));
+  }
+
+  // Merging ntuples is available only with Root output
+  auto fileType = GetFileType(analysisManager->GetFileName());
+  analysisManager->SetNtupleMerging(fileType == "root");
+
+  // Select the written objects
+  auto response = B4cSiliconResponse::Instance();
+  auto writeHits = ! response->GetDigitsOnly();
+  for ( G4int id=0; id<analysisManager->GetNofH1s(); ++id ) {
+    analysisManager->SetH1Activation(id, writeHits);
+  }
+  analysisManager->SetNtupleActivation(0, writeHits);
+  analysisManager->SetNtupleActivation(1, response->GetEnabled());
+  analysisManager->SetNtupleActivation(2, opticalReadout->IsActive() && 
+                                          ! opticalReadout->IsBuilding());
+
   // Open an output file
   //
-  G4String fileName = "B4";
-  analysisManager->OpenFile(fileName);
+  analysisManager->OpenFile();
+
+  // Record the memory of this thread
+  B4cMemoryReport::Instance()->Write(run, "begin", isMaster);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void B4RunAction::EndOfRunAction(const G4Run* /*run*/)
+void B4RunAction::PrintPerformance(const G4Run* run, G4double runTime) const
 {
+  auto nofEvents = run->GetNumberOfEvent();
+
+  // one line per run, to be collected from the logs of several jobs
+  // (the precision of G4cout is restored)
+  auto precision = G4cout.precision();
+  G4cout << G4endl << "### Performance [" << B4StartupReport::GetLabel() 
+         << "] run " << run->GetRunID() << ": "
+         << std::fixed << std::setprecision(3) 
+         << "startup " << B4StartupReport::GetTotalTime() << " s, "
+         << nofEvents << " events in " << runTime << " s, "
+         << std::setprecision(1)
+         << ( runTime > 0. ? nofEvents / runTime : 0. ) << " events/s, "
+         << "RSS " << B4MemoryProbe::Format(B4MemoryProbe::GetResidentSize())
+         << " MB, peak " 
+         << B4MemoryProbe::Format(B4MemoryProbe::GetPeakResidentSize())
+         << " MB" << std::defaultfloat << G4endl;
+  G4cout.precision(precision);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4RunAction::EndOfRunAction(const G4Run* run)
+{
+  // time of the event loop, before the output is written
+  auto runTime = std::chrono::duration<G4double>(
+                   std::chrono::steady_clock::now() - fRunStart).count();
+
+  // close the checkpoint files, removed when the run is completed
+  B4cCheckpoint::Instance()->EndOfRun(run, isMaster);
+
   // print histogram statistics
   //
   auto analysisManager = G4AnalysisManager::Instance();
@@ -199,8 +486,140 @@ void B4RunAction::EndOfRunAction(const G4Run* /*run*/)
 
   // save histograms & ntuple
   //
+  auto writeStart = std::chrono::steady_clock::now();
   analysisManager->Write();
   analysisManager->CloseFile();
+  AddOutputTime(std::chrono::duration<G4double>(
+                  std::chrono::steady_clock::now() - writeStart).count());
+
+  // merge the dose and fluence maps, written by master
+  B4cScoringMesh::Instance()->EndOfRun(isMaster, 
+                                       analysisManager->GetFileName());
+
+  // print the range-out counters
+  B4RangeOut::Instance()->EndOfRun(isMaster);
+
+  // merge the neutron records, print the statistics
+  B4cNeutronCapture::Instance()->EndOfRun(isMaster);
+
+  // merge the optical map, print the photoelectrons or write the map
+  B4cOpticalReadout::Instance()->EndOfRun(isMaster);
+
+  // print the trigger counters
+  B4cTrigger::Instance()->EndOfRun(isMaster);
+
+  B4cMemoryReport::Instance()->Write(run, "end", isMaster);
+
+  // merge the accumulables of the workers to master, the workers end 
+  // their run (and write their output) before master
+  G4AccumulableManager::Instance()->Merge();
+
+  if ( isMaster ) {
+    PrintPerformance(run, runTime);
+    PrintOutputPerformance(run);
+    PrintDigitization(run);
+    PrintLiveTime(run);
+    PrintWeightedEdep(run);
+    B4SharedHistograms::Instance()->EndOfRun(analysisManager->GetFileName());
+    B4NavigationBenchmark::Instance()->EndOfRun(run, fNofTracks.GetValue(),
+                                                fNofSteps.GetValue(), runTime);
+    B4cEventKeeper::Instance()->EndOfRun(run, analysisManager->GetFileName());
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4RunAction::PrintOutputPerformance(const G4Run* run) const
+{
+  auto fileName = G4AnalysisManager::Instance()->GetFileName();
+  auto fileType = GetFileType(fileName);
+  G4int nofFiles = 0;
+  auto size = GetOutputSize(fileName, fileType, nofFiles);
+  auto outputTime = fOutputTime.GetValue();
+  auto nofEvents = run->GetNumberOfEvent();
+
+  // one line per run, to be collected from the logs of several jobs
+  // (the precision of G4cout is restored)
+  auto precision = G4cout.precision();
+  G4cout << "### Output [" << fileType << "] run " << run->GetRunID() << ": "
+         << std::fixed << std::setprecision(3)
+         << size / (1024.*1024.) << " MB in " << nofFiles << " files, "
+         << "filled and written in " << outputTime << " s, "
+         << std::setprecision(1)
+         << ( outputTime > 0. ? size / outputTime : 0. ) << " bytes/s, "
+         << ( outputTime > 0. ? nofEvents / outputTime : 0. ) << " events/s"
+         << std::defaultfloat << G4endl;
+  G4cout.precision(precision);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4RunAction::PrintDigitization(const G4Run* run) const
+{
+  auto response = B4cSiliconResponse::Instance();
+  auto nofEvents = run->GetNumberOfEvent();
+  if ( ! response->GetEnabled() || nofEvents == 0 ) return;
+
+  // the digit rate of a panel is given by the source rate and 
+  // the fraction of events with a digit
+  auto sourceRate = response->GetSourceRate();
+  G4cout << G4endl << " ----> digits per panel (threshold " 
+         << G4BestUnit(response->GetThreshold(), "Energy") << ")" << G4endl;
+  for ( std::size_t i=0; i<fNofDigits.size(); ++i ) {
+    auto nofDigits = fNofDigits[i].GetValue();
+    auto rate = sourceRate * nofDigits / nofEvents;
+    G4cout << " " << B4OutputLayout::kDigiNtupleColumns[i+1] << " : " 
+           << nofDigits << " digits";
+    if ( sourceRate > 0. ) {
+      G4cout << ", rate " << rate * s << " /s, live fraction " 
+             << response->GetLiveFraction(rate);
+    }
+    G4cout << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4RunAction::AddWeightedEdep(const B4cEventRecord& record)
+{
+  for ( std::size_t i=0; i<B4cEventRecord::kNofPanels; ++i ) {
+    auto value = record.fWeight[i] * record.fEdep[i];
+    fWeightedEdep[i] += value;
+    fWeightedEdep2[i] += value * value;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4RunAction::PrintWeightedEdep(const G4Run* run) const
+{
+  auto nofEvents = run->GetNumberOfEvent();
+  if ( ! B4cShield::Instance()->GetBiasing() || nofEvents == 0 ) return;
+
+  // the mean per primary and its error, from the spread of the events
+  G4cout << G4endl << " ----> weighted deposits per primary (" 
+         << nofEvents << " primaries)" << G4endl;
+  for ( std::size_t i=0; i<fWeightedEdep.size(); ++i ) {
+    auto mean = fWeightedEdep[i].GetValue() / nofEvents;
+    auto variance = fWeightedEdep2[i].GetValue() / nofEvents - mean * mean;
+    auto error = std::sqrt(std::max(variance, 0.) / nofEvents);
+    G4cout << " " << B4OutputLayout::kSpectrumNames[i] << " : " 
+           << G4BestUnit(mean, "Energy") << " +- " 
+           << G4BestUnit(error, "Energy") << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4RunAction::PrintLiveTime(const G4Run* run) const
+{
+  auto liveTime = fLiveTime.GetValue();
+  if ( liveTime <= 0. ) return;
+
+  auto nofEvents = run->GetNumberOfEvent();
+  G4cout << "### Cosmic muons: " << nofEvents << " muons, rate " 
+         << nofEvents / ( liveTime/s ) << " Hz, live time " 
+         << G4BestUnit(liveTime, "Time") << G4endl;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
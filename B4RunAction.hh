@@ -32,8 +32,14 @@
 #define B4RunAction_h 1
 
 #include "G4UserRunAction.hh"
+#include "G4Accumulable.hh"
 #include "globals.hh"
 
+#include <chrono>
+#include <vector>
+
+struct B4cEventRecord;
+
 class G4Run;
 
 /// Run action class
@@ -48,11 +54,69 @@ class G4Run;
 /// - Track length in gap
 /// The same values are also saved in the ntuple.
 /// The histograms and ntuple are saved in the output file in a format
-/// accoring to a selected technology in B4Analysis.hh.
+/// according to the output type selected at run time (see B4Analysis.hh).
 ///
 /// In EndOfRunAction(), the accumulated statistic and computed 
 /// dispersion is printed.
 ///
+/// In multi-threaded and tasking mode, BeginOfRunAction() on master 
+/// sets the event modulo so that each worker receives about ten batches
+/// of events per run, unless it was set via /run/eventModulo.
+///
+/// In a sharded run, the output file name set for the run, by the command
+/// line or by /analysis/setFileName, is tagged with the shard on each 
+/// thread at the start of the run.
+///
+/// The run checkpointing (B4cCheckpoint) is started and terminated 
+/// with the run.
+///
+/// At the beginning and at the end of each run, each thread writes its 
+/// memory record (see B4cMemoryReport).
+///
+/// At the end of each run, master prints a performance summary line 
+/// (start-up time, events/s and resident memory), tagged with the 
+/// physics list, which can be compared between jobs.
+///
+/// The ntuples are merged with the Root output. The time spent in 
+/// filling and writing the output is accumulated over the threads, and 
+/// master prints the output size and the written bytes/s and events/s.
+///
+/// The digits of the panels (see B4cSiliconResponse) are written in a
+/// second ntuple; when only the digits are requested, the histograms and
+/// the first ntuple are deactivated. The digits are counted per panel 
+/// over the threads, and master prints the digit rates and the live 
+/// fractions of the panels.
+///
+/// When the navigation benchmark is enabled, the steps and the tracks
+/// are counted over the threads and master prints the navigation 
+/// statistics (see B4NavigationBenchmark).
+///
+/// The dose and fluence maps of the mesh (see B4cScoringMesh) are 
+/// merged at the end of run of each thread and written by master.
+///
+/// The counters of the tracks stopped in the panels (see B4RangeOut),
+/// the neutron capture statistics (see B4cNeutronCapture) and the 
+/// trigger counters (see B4cTrigger) are merged in the same way and 
+/// printed by master.
+///
+/// Master writes the index of the events kept by B4cEventKeeper.
+///
+/// When the transport through the shield is biased (see B4cShield), the
+/// importances of its cells are set at the start of each run, and the 
+/// weighted deposits of the panels are summed over the threads; master
+/// prints their means per primary with their statistical errors.
+///
+/// With the cosmic muon generator (see B4CosmicGenerator), the live time
+/// represented by the muons is summed over the threads and printed by 
+/// master.
+///
+/// The photoelectrons of the optical readout of the gap, or the optical
+/// map in build mode (see B4cOpticalReadout), are merged over the 
+/// threads; the optical ntuple is activated in full and lookup modes.
+///
+/// Master also books the fine-binned spectra shared by the threads
+/// (B4SharedHistograms) at the start of run and writes them at the end.
+///
 
 class B4RunAction : public G4UserRunAction
 {
@@ -62,9 +126,75 @@ class B4RunAction : public G4UserRunAction
 
     virtual void BeginOfRunAction(const G4Run*);
     virtual void   EndOfRunAction(const G4Run*);
+
+    // Add the time spent in filling the output on this thread
+    void AddOutputTime(G4double time);
+    // Count a digit of the given panel on this thread
+    void AddDigit(G4int panel);
+    // Count a step, and a track at its first step, on this thread
+    void AddStep(G4bool firstStep);
+    // Add the live time represented by a cosmic muon on this thread
+    void AddLiveTime(G4double time);
+    // Add the weighted panel deposits of an event on this thread
+    void AddWeightedEdep(const B4cEventRecord& record);
+
+    // Set the tag of the output file names (the shard of a sharded run)
+    static void SetFileTag(const G4String& tag);
+    static const G4String& GetFileTag();
+
+    // Inserts the tag in the file name, before its extension, once
+    static G4String TagFileName(const G4String& fileName, 
+                                const G4String& tag);
+
+  private:
+    void TuneEventModulo(G4int nofEvents);
+    void PrintPerformance(const G4Run* run, G4double runTime) const;
+    void PrintOutputPerformance(const G4Run* run) const;
+    void PrintDigitization(const G4Run* run) const;
+    void PrintLiveTime(const G4Run* run) const;
+    void PrintWeightedEdep(const G4Run* run) const;
+
+    static G4String fgFileTag;
+
+    G4int fTunedEventModulo;
+    std::chrono::steady_clock::time_point fRunStart;
+    G4Accumulable<G4double> fOutputTime;
+    std::vector<G4Accumulable<G4double>> fNofDigits;
+    G4Accumulable<G4double> fNofSteps;
+    G4Accumulable<G4double> fNofTracks;
+    G4Accumulable<G4double> fLiveTime;
+    std::vector<G4Accumulable<G4double>> fWeightedEdep;
+    std::vector<G4Accumulable<G4double>> fWeightedEdep2;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+inline void B4RunAction::SetFileTag(const G4String& tag) {
+  fgFileTag = tag;
+}
+
+inline const G4String& B4RunAction::GetFileTag() {
+  return fgFileTag;
+}
+
+inline void B4RunAction::AddOutputTime(G4double time) {
+  fOutputTime += time;
+}
+
+inline void B4RunAction::AddDigit(G4int panel) {
+  fNofDigits[panel] += 1.;
+}
+
+inline void B4RunAction::AddStep(G4bool firstStep) {
+  fNofSteps += 1.;
+  if ( firstStep ) fNofTracks += 1.;
+}
+
+inline void B4RunAction::AddLiveTime(G4double time) {
+  fLiveTime += time;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 #endif
 
@@ -0,0 +1,214 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4ScanDriver.cc
+/// \brief Implementation of the B4ScanDriver class
+
+#include "B4ScanDriver.hh"
+#include "B4Analysis.hh"
+#include "B4RunAction.hh"
+#include "B4cDetectorConstruction.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4UImanager.hh"
+#include "G4UIcommand.hh"
+#include "G4StateManager.hh"
+#include "G4RunManager.hh"
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+B4ScanDriver::B4ScanDriver()
+ : fMessenger(nullptr),
+   fCommand(),
+   fValues()
+{
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/scan/", "In-process parameter scan");
+
+  auto& commandCmd 
+    = fMessenger->DeclareMethod("setCommand", &B4ScanDriver::SetCommand,
+        "Set the command applied at each point, {} is replaced by the value.");
+  commandCmd.SetParameterName("command", false);
+  commandCmd.command->SetToBeBroadcasted(false);
+
+  auto& valuesCmd 
+    = fMessenger->DeclareMethod("setValues", &B4ScanDriver::SetValues,
+                                "Set the list of the scan values.");
+  valuesCmd.SetParameterName("values", false);
+  valuesCmd.command->SetToBeBroadcasted(false);
+
+  auto& rangeCmd 
+    = fMessenger->DeclareMethod("setRange", &B4ScanDriver::SetRange,
+        "Set nPoints scan values from first to last: first last nPoints.");
+  rangeCmd.SetParameterName("range", false);
+  rangeCmd.command->SetToBeBroadcasted(false);
+
+  auto& runCmd 
+    = fMessenger->DeclareMethod("run", &B4ScanDriver::Run,
+                                "Run the scan with nEvents per point.");
+  runCmd.SetParameterName("nEvents", false);
+  runCmd.SetRange("nEvents>0");
+  runCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4ScanDriver::~B4ScanDriver()
+{ 
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4ScanDriver::SetValues(const G4String& values)
+{
+  fValues.clear();
+  std::istringstream input(values);
+  G4String value;
+  while ( input >> value ) fValues.push_back(value);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4ScanDriver::SetRange(const G4String& range)
+{
+  G4double first = 0.;
+  G4double last = 0.;
+  G4int nofPoints = 0;
+  std::istringstream input(range);
+  if ( ! ( input >> first >> last >> nofPoints ) || nofPoints < 1 ) {
+    G4ExceptionDescription msg;
+    msg << "Wrong scan range \"" << range 
+        << "\", expected: first last nPoints.";
+    G4Exception("B4ScanDriver::SetRange()",
+      "MyCode0009", JustWarning, msg);
+    return;
+  }
+
+  fValues.clear();
+  for ( G4int i=0; i<nofPoints; ++i ) {
+    auto value 
+      = ( nofPoints > 1 ) ? first + (last - first) * i / (nofPoints - 1) 
+                          : first;
+    fValues.push_back(G4UIcommand::ConvertToString(value));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4ScanDriver::Run(G4int nofEvents)
+{
+  if ( fCommand.empty() || fValues.empty() ) {
+    G4ExceptionDescription msg;
+    msg << "The scan command and values must be set before running a scan.";
+    G4Exception("B4ScanDriver::Run()",
+      "MyCode0009", JustWarning, msg);
+    return;
+  }
+
+  using clock = std::chrono::steady_clock;
+  auto UImanager = G4UImanager::GetUIpointer();
+
+  // The kernel and the physics are initialized once for the whole scan
+  if ( G4StateManager::GetStateManager()->GetCurrentState() 
+         == G4State_PreInit ) {
+    UImanager->ApplyCommand("/run/initialize");
+  }
+
+  auto detector = dynamic_cast<const B4cDetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  auto nofRejectedBefore 
+    = detector ? detector->GetNofRejectedChanges() : 0;
+
+  auto fileName = G4AnalysisManager::Instance()->GetFileName();
+  auto width = std::to_string(fValues.size() - 1).size();
+  std::vector<G4double> times;
+
+  for ( std::size_t i=0; i<fValues.size(); ++i ) {
+    auto command = fCommand;
+    auto placeholder = command.find("{}");
+    if ( placeholder != std::string::npos ) {
+      command.replace(placeholder, 2, fValues[i]);
+    }
+    else {
+      command += " " + fValues[i];
+    }
+
+    if ( UImanager->ApplyCommand(command) != 0 ) {
+      G4ExceptionDescription msg;
+      msg << "Scan command \"" << command << "\" failed, scan stopped.";
+      G4Exception("B4ScanDriver::Run()",
+        "MyCode0009", JustWarning, msg);
+      break;
+    }
+
+    // A geometry value rejected by the detector construction would run
+    // the previous geometry again: the point is skipped, without output
+    auto nofRejected 
+      = detector ? detector->GetNofRejectedChanges() : nofRejectedBefore;
+    if ( nofRejected != nofRejectedBefore ) {
+      nofRejectedBefore = nofRejected;
+      G4ExceptionDescription msg;
+      msg << "Scan point " << i << " \"" << command 
+          << "\" rejected by the geometry, point skipped.";
+      G4Exception("B4ScanDriver::Run()",
+        "MyCode0009", JustWarning, msg);
+      times.push_back(-1.);
+      continue;
+    }
+
+    std::ostringstream tag;
+    tag << "_scan" << std::setw(width) << std::setfill('0') << i;
+    UImanager->ApplyCommand(
+      "/analysis/setFileName " 
+      + B4RunAction::TagFileName(fileName, tag.str()));
+
+    G4cout << G4endl << "### Scan point " << i << ": " << command << G4endl;
+    auto start = clock::now();
+    UImanager->ApplyCommand(
+      "/run/beamOn " + G4UIcommand::ConvertToString(nofEvents));
+    times.push_back(
+      std::chrono::duration<G4double>(clock::now() - start).count());
+  }
+
+  // Restore the output file name
+  UImanager->ApplyCommand("/analysis/setFileName " + fileName);
+
+  G4cout << G4endl << "### Scan of " << fCommand << G4endl;
+  for ( std::size_t i=0; i<times.size(); ++i ) {
+    G4cout << "  " << std::setw(width) << i << "  " << std::setw(12) 
+           << fValues[i] << "  ";
+    if ( times[i] < 0. ) {
+      G4cout << "skipped" << G4endl;
+    }
+    else {
+      G4cout << times[i] << " s" << G4endl;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,84 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4ScanDriver.hh
+/// \brief Definition of the B4ScanDriver class
+
+#ifndef B4ScanDriver_h
+#define B4ScanDriver_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class G4GenericMessenger;
+
+/// In-process parameter scan.
+///
+/// For each scan point a UI command is applied with the point value and a
+/// run is started, with its output file tagged with _scanNN. All points 
+/// are run in the same process: the kernel and the physics tables are 
+/// initialized once, and a command changing the geometry (/B4/det/) only
+/// triggers the rebuild of the geometry before the next run.
+///
+/// A point whose geometry value is rejected by the detector construction
+/// (overlapping panels) is skipped with a warning and writes no output.
+///
+/// The scan value replaces {} in the command, or is appended to it. 
+/// The following commands are defined (on master only):
+/// - /B4/scan/setCommand command   (e.g. "/B4/det/setAbsoThickness {} mm")
+/// - /B4/scan/setValues v1 v2 ...
+/// - /B4/scan/setRange first last nPoints
+/// - /B4/scan/run nEvents
+
+class B4ScanDriver
+{
+  public:
+    B4ScanDriver();
+    ~B4ScanDriver();
+
+    // Run the scan with the given number of events per point
+    void Run(G4int nofEvents);
+
+    // set methods
+    void SetCommand(const G4String& command);
+    void SetValues(const G4String& values);
+    void SetRange(const G4String& range);
+
+  private:
+    G4GenericMessenger* fMessenger;
+    G4String fCommand;
+    std::vector<G4String> fValues;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B4ScanDriver::SetCommand(const G4String& command) {
+  fCommand = command;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,151 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4SharedH1.cc
+/// \brief Implementation of the B4SharedH1 class
+
+#include "B4SharedH1.hh"
+
+#include "G4Threading.hh"
+
+#include <algorithm>
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4SharedH1::B4SharedH1(const G4String& name, G4int nofBins, 
+                       G4double min, G4double max, G4bool logBinning, 
+                       G4int nofStripes)
+ : fName(name),
+   fNofBins(std::max(nofBins, 1)),
+   fMin(min),
+   fMax(max),
+   fLogBinning(logBinning),
+   fScale(0.),
+   fNofStripes(std::max(nofStripes, 1)),
+   fStripeLines(0),
+   fLines()
+{
+  if ( fLogBinning ) {
+    fScale = fNofBins / std::log(fMax / fMin);
+  }
+  else {
+    fScale = fNofBins / (fMax - fMin);
+  }
+
+  // the bins plus the underflow and the overflow, 
+  // rounded up to whole cache lines
+  fStripeLines = ( fNofBins + 2 + kCountsPerLine - 1 ) / kCountsPerLine;
+  fLines.reset(new Stripe[fStripeLines * fNofStripes]());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4SharedH1::~B4SharedH1()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int B4SharedH1::GetBin(G4double value) const
+{
+  // -1 for the underflow, fNofBins for the overflow 
+  if ( value < fMin || ( fLogBinning && value <= 0. ) ) return -1;
+  if ( value >= fMax ) return fNofBins;
+
+  auto position = fLogBinning ? std::log(value / fMin) : value - fMin;
+  return std::min(G4int(position * fScale), fNofBins - 1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4SharedH1::Fill(G4double value)
+{
+  // the master thread (-1) in sequential mode uses the first stripe
+  auto threadID = std::max(G4Threading::G4GetThreadId(), 0);
+  auto slot = std::size_t(GetBin(value) + 1);
+  auto line = std::size_t(threadID % fNofStripes) * fStripeLines 
+            + slot / kCountsPerLine;
+
+  fLines[line].fCounts[slot % kCountsPerLine]
+    .fetch_add(1, std::memory_order_relaxed);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4SharedH1::Reset()
+{
+  for ( std::size_t i=0; i<fStripeLines * fNofStripes; ++i ) {
+    for ( auto& count : fLines[i].fCounts ) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t B4SharedH1::GetBinContent(G4int bin) const
+{
+  if ( bin < -1 || bin > fNofBins ) return 0;
+
+  auto slot = std::size_t(bin + 1);
+  std::uint64_t content = 0;
+  for ( G4int stripe=0; stripe<fNofStripes; ++stripe ) {
+    auto line = std::size_t(stripe) * fStripeLines + slot / kCountsPerLine;
+    content 
+      += fLines[line].fCounts[slot % kCountsPerLine]
+           .load(std::memory_order_relaxed);
+  }
+  return content;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t B4SharedH1::GetEntries() const
+{
+  std::uint64_t entries = 0;
+  for ( G4int bin=-1; bin<=fNofBins; ++bin ) {
+    entries += GetBinContent(bin);
+  }
+  return entries;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4SharedH1::GetLowEdge(G4int bin) const
+{
+  if ( fLogBinning ) {
+    return fMin * std::exp(bin / fScale);
+  }
+  return fMin + bin / fScale;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t B4SharedH1::GetMemorySize() const
+{
+  return fStripeLines * fNofStripes * sizeof(Stripe);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
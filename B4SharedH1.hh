@@ -0,0 +1,113 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4SharedH1.hh
+/// \brief Definition of the B4SharedH1 class
+
+#ifndef B4SharedH1_h
+#define B4SharedH1_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// One-dimensional histogram of counts shared by all threads.
+///
+/// The bins are filled with relaxed atomic increments, so that a single
+/// histogram serves all the threads and needs no merge at the end of run.
+/// The counts are split in a fixed number of stripes, each allocated on
+/// its own cache lines, and a thread fills the stripe given by its 
+/// thread ID: the threads filling the same bin do not all contend on 
+/// the same cache line, and the memory does not depend on the number of
+/// threads. The bins are of fixed width, or logarithmic.
+
+class B4SharedH1
+{
+  public:
+    B4SharedH1(const G4String& name, G4int nofBins, 
+               G4double min, G4double max, G4bool logBinning, 
+               G4int nofStripes);
+    ~B4SharedH1();
+
+    // Thread-safe fill
+    void Fill(G4double value);
+
+    // Clear the counts, when no thread is filling
+    void Reset();
+
+    // Counts summed over the stripes;
+    // bin -1 is the underflow, bin nofBins the overflow
+    std::uint64_t GetBinContent(G4int bin) const;
+    std::uint64_t GetEntries() const;
+
+    G4double GetLowEdge(G4int bin) const;
+
+    // Memory of the counts in bytes
+    std::size_t GetMemorySize() const;
+
+    // get methods
+    const G4String& GetName() const;
+    G4int GetNofBins() const;
+
+  private:
+    static constexpr std::size_t kCacheLine = 64;
+    static constexpr std::size_t kCountsPerLine 
+      = kCacheLine / sizeof(std::uint64_t);
+
+    // Counts of the bins, underflow and overflow, 
+    // aligned on a cache line
+    struct alignas(kCacheLine) Stripe {
+      std::atomic<std::uint64_t> fCounts[kCountsPerLine];
+    };
+
+    G4int GetBin(G4double value) const;
+
+    G4String fName;
+    G4int    fNofBins;
+    G4double fMin;
+    G4double fMax;
+    G4bool   fLogBinning;
+    G4double fScale;      ///< bins per unit of (log) value
+    G4int    fNofStripes;
+    std::size_t fStripeLines; ///< cache lines per stripe
+    std::unique_ptr<Stripe[]> fLines;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline const G4String& B4SharedH1::GetName() const {
+  return fName;
+}
+
+inline G4int B4SharedH1::GetNofBins() const {
+  return fNofBins;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
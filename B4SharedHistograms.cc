@@ -0,0 +1,193 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4SharedHistograms.cc
+/// \brief Implementation of the B4SharedHistograms class
+
+#include "B4SharedHistograms.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4SharedHistograms* B4SharedHistograms::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4SharedHistograms* B4SharedHistograms::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4SharedHistograms();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4SharedHistograms::B4SharedHistograms()
+ : fMessenger(nullptr),
+   fEnabled(true),
+   fNofBins(16384),
+   fMin(0.),
+   fMax(5.*MeV),
+   fLogBinning(false),
+   fNofStripes(4),
+   fHistograms()
+{
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/sharedH1/", 
+                             "Histograms shared by all threads");
+
+  auto& enabledCmd 
+    = fMessenger->DeclareMethod("setEnabled", &B4SharedHistograms::SetEnabled,
+                                "Fill the shared histograms.");
+  enabledCmd.SetParameterName("enabled", true);
+  enabledCmd.SetDefaultValue("true");
+  enabledCmd.command->SetToBeBroadcasted(false);
+
+  auto& nbinsCmd 
+    = fMessenger->DeclareProperty("setNbins", fNofBins,
+                                  "Set the number of bins.");
+  nbinsCmd.SetParameterName("nBins", false);
+  nbinsCmd.SetRange("nBins>0");
+  nbinsCmd.command->SetToBeBroadcasted(false);
+
+  auto& minCmd 
+    = fMessenger->DeclarePropertyWithUnit("setMin", "MeV", fMin,
+                                          "Set the lower edge.");
+  minCmd.SetParameterName("min", false);
+  minCmd.command->SetToBeBroadcasted(false);
+
+  auto& maxCmd 
+    = fMessenger->DeclarePropertyWithUnit("setMax", "MeV", fMax,
+                                          "Set the upper edge.");
+  maxCmd.SetParameterName("max", false);
+  maxCmd.command->SetToBeBroadcasted(false);
+
+  auto& logCmd 
+    = fMessenger->DeclareProperty("setLogBinning", fLogBinning,
+                                  "Use logarithmic bins.");
+  logCmd.SetParameterName("logBinning", true);
+  logCmd.SetDefaultValue("true");
+  logCmd.command->SetToBeBroadcasted(false);
+
+  auto& stripesCmd 
+    = fMessenger->DeclareProperty("setNofStripes", fNofStripes,
+                                  "Set the number of copies of the counts "
+                                  "shared by the threads.");
+  stripesCmd.SetParameterName("nStripes", false);
+  stripesCmd.SetRange("nStripes>0");
+  stripesCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4SharedHistograms::~B4SharedHistograms()
+{ 
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4SharedHistograms::BeginOfRun(const std::vector<G4String>& names)
+{
+  // The histograms are booked again at each run, before the workers
+  // start filling them, so that the binning can change between runs
+  fHistograms.clear();
+  if ( ! fEnabled ) return;
+
+  if ( fMin >= fMax || ( fLogBinning && fMin <= 0. ) ) {
+    G4ExceptionDescription msg;
+    msg << "Wrong binning [" << fMin/MeV << ", " << fMax/MeV << "] MeV"
+        << ( fLogBinning ? " (logarithmic)" : "" ) 
+        << ", the shared histograms are not filled.";
+    G4Exception("B4SharedHistograms::BeginOfRun()",
+      "MyCode0012", JustWarning, msg);
+    return;
+  }
+
+  for ( const auto& name : names ) {
+    fHistograms.emplace_back(
+      new B4SharedH1(name, fNofBins, fMin, fMax, fLogBinning, fNofStripes));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4SharedHistograms::EndOfRun(const G4String& outputFileName) const
+{
+  if ( fHistograms.empty() ) return;
+
+  std::filesystem::path path(outputFileName.c_str());
+  path.replace_filename(path.stem().string() + "_spectra.csv");
+  std::ofstream file(path);
+  if ( ! file ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << path.string() << ".";
+    G4Exception("B4SharedHistograms::EndOfRun()",
+      "MyCode0012", JustWarning, msg);
+    return;
+  }
+
+  // one row per bin, with the underflow and the overflow rows first
+  file << "lowEdge_MeV,highEdge_MeV";
+  for ( const auto& histogram : fHistograms ) {
+    file << "," << histogram->GetName();
+  }
+  file << "\n" << std::setprecision(9);
+  auto nofBins = fHistograms.front()->GetNofBins();
+  for ( auto bin : { -1, nofBins } ) {
+    file << ( bin < 0 ? "underflow," : "overflow," );
+    for ( const auto& histogram : fHistograms ) {
+      file << "," << histogram->GetBinContent(bin);
+    }
+    file << "\n";
+  }
+  const auto& first = *fHistograms.front();
+  for ( G4int bin=0; bin<nofBins; ++bin ) {
+    file << first.GetLowEdge(bin)/MeV << "," << first.GetLowEdge(bin+1)/MeV;
+    for ( const auto& histogram : fHistograms ) {
+      file << "," << histogram->GetBinContent(bin);
+    }
+    file << "\n";
+  }
+
+  std::size_t memory = 0;
+  for ( const auto& histogram : fHistograms ) {
+    memory += histogram->GetMemorySize();
+  }
+  G4cout << "### Shared histograms: " << fHistograms.size() << " x " 
+         << nofBins << " bins, " << memory / (1024.*1024.) << " MB, "
+         << first.GetEntries() << " entries in " << first.GetName() 
+         << ", written in " << path.string() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
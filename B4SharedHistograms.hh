@@ -0,0 +1,108 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4SharedHistograms.hh
+/// \brief Definition of the B4SharedHistograms class
+
+#ifndef B4SharedHistograms_h
+#define B4SharedHistograms_h 1
+
+#include "B4SharedH1.hh"
+
+#include "globals.hh"
+
+#include <memory>
+#include <vector>
+
+class G4GenericMessenger;
+
+/// Store of fine-binned histograms shared by all threads (B4SharedH1).
+///
+/// The histograms are booked on master at the start of each run with the
+/// current binning, filled concurrently by the workers and written on 
+/// master at the end of run in a CSV file <output>_spectra.csv, with one
+/// row per bin and one column per histogram. They complement the 
+/// thread-local histograms of the analysis manager: their memory does 
+/// not grow with the number of threads and they need no merge.
+///
+/// The binning is shared by all threads, the following commands are 
+/// therefore executed on master only:
+/// - /B4/sharedH1/setEnabled true|false
+/// - /B4/sharedH1/setNbins nBins
+/// - /B4/sharedH1/setMin value unit
+/// - /B4/sharedH1/setMax value unit
+/// - /B4/sharedH1/setLogBinning true|false
+/// - /B4/sharedH1/setNofStripes nStripes
+
+class B4SharedHistograms
+{
+  public:
+    static B4SharedHistograms* Instance();
+    ~B4SharedHistograms();
+
+    // Called from the run action on master
+    void BeginOfRun(const std::vector<G4String>& names);
+    void EndOfRun(const G4String& outputFileName) const;
+
+    // Thread-safe fill of the histogram with the given index, 
+    // in the order of the booked names
+    void Fill(G4int id, G4double value);
+
+    // set/get methods
+    void   SetEnabled(G4bool enabled);
+    G4bool GetEnabled() const;
+
+  private:
+    B4SharedHistograms();
+
+    static B4SharedHistograms* fgInstance;
+
+    G4GenericMessenger* fMessenger;
+    G4bool   fEnabled;
+    G4int    fNofBins;
+    G4double fMin;
+    G4double fMax;
+    G4bool   fLogBinning;
+    G4int    fNofStripes;
+    std::vector<std::unique_ptr<B4SharedH1>> fHistograms;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B4SharedHistograms::SetEnabled(G4bool enabled) {
+  fEnabled = enabled;
+}
+
+inline G4bool B4SharedHistograms::GetEnabled() const {
+  return fEnabled;
+}
+
+inline void B4SharedHistograms::Fill(G4int id, G4double value) {
+  if ( id < G4int(fHistograms.size()) ) fHistograms[id]->Fill(value);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
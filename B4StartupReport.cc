@@ -0,0 +1,114 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4StartupReport.cc
+/// \brief Implementation of the B4StartupReport class
+
+#include "B4StartupReport.hh"
+#include "B4MemoryProbe.hh"
+
+#include <iomanip>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4StartupReport::Clock::time_point B4StartupReport::fgStart;
+B4StartupReport::Clock::time_point B4StartupReport::fgLast;
+std::vector<B4StartupReport::Phase> B4StartupReport::fgPhases;
+G4String B4StartupReport::fgLabel;
+G4bool B4StartupReport::fgPrinted = false;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4StartupReport::Start()
+{
+  fgStart = fgLast = Clock::now();
+  fgPhases.clear();
+  fgPrinted = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4StartupReport::Mark(const G4String& phase)
+{
+  if ( fgPrinted ) return;
+
+  auto now = Clock::now();
+  fgPhases.push_back(
+    { phase, std::chrono::duration<G4double>(now - fgLast).count(),
+      B4MemoryProbe::GetResidentSize() });
+  fgLast = now;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4StartupReport::SetLabel(const G4String& label)
+{
+  fgLabel = label;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const G4String& B4StartupReport::GetLabel()
+{
+  return fgLabel;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4StartupReport::GetTotalTime()
+{
+  return std::chrono::duration<G4double>(fgLast - fgStart).count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4StartupReport::Print()
+{
+  if ( fgPrinted || fgPhases.empty() ) return;
+  fgPrinted = true;
+
+  // the precision of G4cout is restored for the following printouts
+  auto precision = G4cout.precision();
+  G4cout << G4endl << "--------------------Start-up time--------------------"
+         << G4endl;
+  if ( fgLabel.size() ) {
+    G4cout << " " << fgLabel << G4endl;
+  }
+  for ( const auto& phase : fgPhases ) {
+    G4cout << " " << std::setw(28) << std::left << phase.fName << std::right
+           << std::setw(10) << std::fixed << std::setprecision(3) 
+           << phase.fTime << " s" << std::setw(9) 
+           << B4MemoryProbe::Format(phase.fResidentSize) << " MB" 
+           << G4endl;
+  }
+  G4cout << " " << std::setw(28) << std::left << "total" << std::right 
+         << std::setw(10) << std::setprecision(3) << GetTotalTime() 
+         << " s" << G4endl;
+  G4cout << "-----------------------------------------------------" 
+         << std::defaultfloat << G4endl;
+  G4cout.precision(precision);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,73 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4StartupReport.hh
+/// \brief Definition of the B4StartupReport class
+
+#ifndef B4StartupReport_h
+#define B4StartupReport_h 1
+
+#include "globals.hh"
+
+#include <chrono>
+#include <vector>
+
+/// Wall-clock time of the start-up phases of the job.
+///
+/// The phases are closed in order with Mark(), on the master thread; 
+/// each phase lasts from the end of the previous one, and the resident
+/// memory at its end is recorded. The report is printed by Print(), 
+/// once the first run has started. The label identifies the job 
+/// configuration (the physics list) in the performance summaries.
+
+class B4StartupReport
+{
+  public:
+    static void Start();
+    static void Mark(const G4String& phase);
+    static void Print();
+
+    static void SetLabel(const G4String& label);
+    static const G4String& GetLabel();
+    // Returns the time from Start() to the last phase
+    static G4double GetTotalTime();
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+      G4String fName;
+      G4double fTime;
+      G4double fResidentSize;
+    };
+
+    static Clock::time_point fgStart;
+    static Clock::time_point fgLast;
+    static std::vector<Phase> fgPhases;
+    static G4String fgLabel;
+    static G4bool fgPrinted;
+};
+
+#endif
@@ -0,0 +1,172 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4SubEventSplitter.cc
+/// \brief Implementation of the B4SubEventSplitter class
+
+#include "B4SubEventSplitter.hh"
+#include "B4RangeOut.hh"
+#include "B4cCheckpoint.hh"
+#include "B4cEventKeeper.hh"
+#include "B4cNeutronCapture.hh"
+#include "B4cOpticalReadout.hh"
+#include "B4cTrigger.hh"
+
+#include "G4Track.hh"
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Version.hh"
+
+#if G4VERSION_NUMBER >= 1120
+#include "G4SubEvtRunManager.hh"
+#endif
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4SubEventSplitter* B4SubEventSplitter::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4SubEventSplitter* B4SubEventSplitter::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4SubEventSplitter();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4SubEventSplitter::B4SubEventSplitter()
+ : fMessenger(nullptr),
+   fEnabled(false),
+   fMinEnergy(1.*MeV)
+{
+  // The splitting is decided by the run manager on master:
+  // the commands are executed on master only
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/subEvent/", 
+                             "Sub-event parallel processing");
+
+  auto& enabledCmd 
+    = fMessenger->DeclareMethod("setEnabled", &B4SubEventSplitter::SetEnabled,
+                                "Split the events in sub-events of at most "
+                                "the given number of tracks.");
+  enabledCmd.SetParameterName("maxTracks", false);
+  enabledCmd.SetRange("maxTracks>0");
+  enabledCmd.SetStates(G4State_PreInit);
+  enabledCmd.command->SetToBeBroadcasted(false);
+
+  auto& energyCmd 
+    = fMessenger->DeclarePropertyWithUnit("setMinEnergy", "MeV", fMinEnergy,
+                                          "Set the minimum kinetic energy "
+                                          "of the sub-event tracks.");
+  energyCmd.SetParameterName("minEnergy", false);
+  energyCmd.SetRange("minEnergy>=0.");
+  energyCmd.SetStates(G4State_PreInit, G4State_Idle);
+  energyCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4SubEventSplitter::~B4SubEventSplitter()
+{ 
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4SubEventSplitter::SetEnabled(G4int maxTracks)
+{
+  if ( fEnabled ) return;
+
+#if G4VERSION_NUMBER >= 1120
+  auto runManager 
+    = dynamic_cast<G4SubEvtRunManager*>(G4RunManager::GetRunManager());
+  if ( runManager ) {
+    runManager->RegisterSubEventType(kSubEventType, maxTracks);
+    fEnabled = true;
+    return;
+  }
+#endif
+
+  G4ExceptionDescription msg;
+  msg << "The sub-events need the sub-event run manager (-r subevent, "
+      << "Geant4 11.2 or later), the events are not split.";
+  G4Exception("B4SubEventSplitter::SetEnabled()",
+    "MyCode0019", JustWarning, msg);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4SubEventSplitter::BeginOfRun() const
+{
+  if ( ! fEnabled ) return;
+
+  // The modules whose per-event state is kept on each thread
+  G4String features;
+  auto rangeOut = B4RangeOut::Instance();
+  if ( rangeOut->GetEnabled() && rangeOut->GetMeasureOnly() ) {
+    features += " range-out measurement,";
+  }
+  if ( B4cOpticalReadout::Instance()->IsActive() ) {
+    features += " optical readout,";
+  }
+  auto checkpoint = B4cCheckpoint::Instance();
+  if ( checkpoint->GetPeriod() > 0 || checkpoint->GetResume() ) {
+    features += " checkpoints,";
+  }
+  if ( B4cEventKeeper::Instance()->GetEnabled() ) {
+    features += " event keeping,";
+  }
+  if ( B4cNeutronCapture::Instance()->IsRecording() ) {
+    features += " neutron capture recording,";
+  }
+  if ( B4cTrigger::Instance()->GetEnabled() ) {
+    // the trigger delays the tracks instead of splitting them
+    features += " trigger,";
+  }
+  if ( features.empty() ) return;
+
+  features.pop_back();
+  G4ExceptionDescription msg;
+  msg << "The sub-event splitting cannot be used with:" << features 
+      << "." << G4endl << "Their event state is not merged, the run is "
+      << "aborted.";
+  G4Exception("B4SubEventSplitter::BeginOfRun()",
+    "MyCode0019", RunMustBeAborted, msg);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4SubEventSplitter::Select(const G4Track* track) const
+{
+  // the secondaries carrying enough energy to be worth a transfer
+  return fEnabled && track->GetParentID() > 0 && 
+         track->GetKineticEnergy() >= fMinEnergy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,98 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4SubEventSplitter.hh
+/// \brief Definition of the B4SubEventSplitter class
+
+#ifndef B4SubEventSplitter_h
+#define B4SubEventSplitter_h 1
+
+#include "globals.hh"
+
+class G4Track;
+class G4GenericMessenger;
+
+/// Splitting of the heavy events into sub-events, processed in parallel
+/// by the workers of the sub-event run manager (-r subevent, available
+/// from Geant4 11.2).
+///
+/// The secondaries above the minimum kinetic energy are stacked by 
+/// B4cStackingAction as sub-event tracks instead of being tracked by 
+/// the thread of their event; the run manager packs them in sub-events 
+/// of at most the given number of tracks, which any worker can process.
+/// The panel hits of each sub-event are merged back into its event by 
+/// B4cEventAction before the end of the event, so that the event 
+/// quantities, their outputs and the digits are those of the whole 
+/// event; the event action is therefore also registered on master, 
+/// where the sub-events are merged.
+///
+/// The per-event state of the optional modules which is kept on each 
+/// thread is not merged: the runs with the splitting enabled together 
+/// with the range-out measurement, the optical readout, the checkpoints,
+/// the event keeping or the neutron capture recording are aborted at 
+/// the start of run, as are those with the trigger, whose delayed 
+/// tracks are not split.
+///
+/// The following commands are defined (on master only):
+/// - /B4/subEvent/setEnabled maxTracks   (PreInit)
+/// - /B4/subEvent/setMinEnergy value unit
+
+class B4SubEventSplitter
+{
+  public:
+    // The type of the sub-events, as registered in the run manager
+    static constexpr G4int kSubEventType = 0;
+
+    static B4SubEventSplitter* Instance();
+    ~B4SubEventSplitter();
+
+    // Called from the run action on master
+    void BeginOfRun() const;
+
+    // Called from the stacking action
+    G4bool Select(const G4Track* track) const;
+
+    // set/get methods
+    void   SetEnabled(G4int maxTracks);
+    G4bool GetEnabled() const;
+
+  private:
+    B4SubEventSplitter();
+
+    static B4SubEventSplitter* fgInstance;
+
+    G4GenericMessenger* fMessenger;
+    G4bool   fEnabled;
+    G4double fMinEnergy;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline G4bool B4SubEventSplitter::GetEnabled() const {
+  return fEnabled;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
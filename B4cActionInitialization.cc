@@ -32,6 +32,15 @@
 #include "B4PrimaryGeneratorAction.hh"
 #include "B4RunAction.hh"
 #include "B4cEventAction.hh"
+#include "B4cSteppingAction.hh"
+#include "B4cStackingAction.hh"
+
+#include "G4RunManager.hh"
+#include "G4Version.hh"
+
+#if G4VERSION_NUMBER >= 1120
+#include "G4SubEvtRunManager.hh"
+#endif
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -48,16 +57,27 @@ B4cActionInitialization::~B4cActionInitialization()
 
 void B4cActionInitialization::BuildForMaster() const
 {
-  SetUserAction(new B4RunAction);
+  auto runAction = new B4RunAction;
+  SetUserAction(runAction);
+
+#if G4VERSION_NUMBER >= 1120
+  // The sub-events are merged in their event by the event action on master
+  if ( dynamic_cast<G4SubEvtRunManager*>(G4RunManager::GetRunManager()) ) {
+    SetUserAction(new B4cEventAction(runAction));
+  }
+#endif
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void B4cActionInitialization::Build() const
 {
-  SetUserAction(new B4PrimaryGeneratorAction);
-  SetUserAction(new B4RunAction);
-  SetUserAction(new B4cEventAction);
+  auto runAction = new B4RunAction;
+  SetUserAction(new B4PrimaryGeneratorAction(runAction));
+  SetUserAction(runAction);
+  SetUserAction(new B4cEventAction(runAction));
+  SetUserAction(new B4cSteppingAction(runAction));
+  SetUserAction(new B4cStackingAction);
 }  
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -44,7 +44,8 @@ G4ThreadLocal G4Allocator<B4cCalorHit>* B4cCalorHitAllocator = 0;
 B4cCalorHit::B4cCalorHit()
  : G4VHit(),
    fEdep(0.),
-   fTrackLength(0.)
+   fTrackLength(0.),
+   fWeightedEdep(0.)
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -58,6 +59,7 @@ B4cCalorHit::B4cCalorHit(const B4cCalorHit& right)
 {
   fEdep        = right.fEdep;
   fTrackLength = right.fTrackLength;
+  fWeightedEdep = right.fWeightedEdep;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -66,6 +68,7 @@ const B4cCalorHit& B4cCalorHit::operator=(const B4cCalorHit& right)
 {
   fEdep        = right.fEdep;
   fTrackLength = right.fTrackLength;
+  fWeightedEdep = right.fWeightedEdep;
 
   return *this;
 }
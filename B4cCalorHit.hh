@@ -42,6 +42,10 @@
 /// It defines data members to store the the energy deposit and track lengths
 /// of charged particles in a selected volume:
 /// - fEdep, fTrackLength
+///
+/// The deposit is not weighted; the weights of the tracks (see 
+/// B4cShield) are summed with the deposit, and GetWeight() gives their
+/// mean weighted by the deposit.
 
 class B4cCalorHit : public G4VHit
 {
@@ -62,15 +66,18 @@ class B4cCalorHit : public G4VHit
     virtual void Print();
 
     // methods to handle data
-    void Add(G4double de, G4double dl);
+    void Add(G4double de, G4double dl, G4double weight = 1.);
 
     // get methods
     G4double GetEdep() const;
     G4double GetTrackLength() const;
+    G4double GetWeightedEdep() const;
+    G4double GetWeight() const;
       
   private:
     G4double fEdep;        ///< Energy deposit in the sensitive volume
     G4double fTrackLength; ///< Track length in the  sensitive volume
+    G4double fWeightedEdep; ///< Energy deposit times the track weight
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -99,9 +106,10 @@ inline void B4cCalorHit::operator delete(void *hit)
   B4cCalorHitAllocator->FreeSingle((B4cCalorHit*) hit);
 }
 
-inline void B4cCalorHit::Add(G4double de, G4double dl) {
+inline void B4cCalorHit::Add(G4double de, G4double dl, G4double weight) {
   fEdep += de; 
   fTrackLength += dl;
+  fWeightedEdep += weight * de;
 }
 
 inline G4double B4cCalorHit::GetEdep() const { 
@@ -112,6 +120,14 @@ inline G4double B4cCalorHit::GetTrackLength() const {
   return fTrackLength; 
 }
 
+inline G4double B4cCalorHit::GetWeightedEdep() const { 
+  return fWeightedEdep; 
+}
+
+inline G4double B4cCalorHit::GetWeight() const { 
+  return fEdep > 0. ? fWeightedEdep / fEdep : 1.; 
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 #endif
@@ -29,6 +29,8 @@
 /// \brief Implementation of the B4cCalorimeterSD class
 
 #include "B4cCalorimeterSD.hh"
+#include "B4RangeOut.hh"
+#include "B4cShield.hh"
 #include "G4HCofThisEvent.hh"
 #include "G4Step.hh"
 #include "G4ThreeVector.hh"
@@ -88,8 +90,17 @@ G4bool B4cCalorimeterSD::ProcessHits(G4Step* step,
     stepLength = step->GetStepLength();
   }
 
+  // the energy and the residual range of a track stopped in the panel
+  G4double residualRange = 0.;
+  edep += B4RangeOut::Instance()->Apply(step, residualRange);
+  stepLength += residualRange;
+
   if ( edep==0. && stepLength == 0. ) return false;      
 
+  // the weight of the track when the shield transport is biased,
+  // applied when the event is filled
+  auto weight = B4cShield::Instance()->GetWeight(step->GetTrack());
+
   auto touchable = (step->GetPreStepPoint()->GetTouchable());
     
   // Get calorimeter cell id 
@@ -109,8 +120,8 @@ G4bool B4cCalorimeterSD::ProcessHits(G4Step* step,
     = (*fHitsCollection)[fHitsCollection->entries()-1];
   
   // Add values
-  hit->Add(edep, stepLength);
-  hitTotal->Add(edep, stepLength); 
+  hit->Add(edep, stepLength, weight);
+  hitTotal->Add(edep, stepLength, weight); 
       
   return true;
 }
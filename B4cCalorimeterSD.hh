@@ -46,7 +46,11 @@ class G4HCofThisEvent;
 /// hit for accounting the total quantities in all layers.
 ///
 /// The values are accounted in hits in ProcessHits() function which is called
-/// by Geant4 kernel at each step.
+/// by Geant4 kernel at each step. The energy of the tracks ranging out in
+/// the panel is deposited at once when enabled (see B4RangeOut). When the
+/// transport through the shield is biased (see B4cShield), the track 
+/// weight is accumulated in the hits next to the values, which are not
+/// weighted.
 
 class B4cCalorimeterSD : public G4VSensitiveDetector
 {
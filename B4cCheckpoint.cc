@@ -0,0 +1,365 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cCheckpoint.cc
+/// \brief Implementation of the B4cCheckpoint class
+
+#include "B4cCheckpoint.hh"
+#include "B4EventSeeder.hh"
+#include "B4NavigationBenchmark.hh"
+#include "B4RangeOut.hh"
+#include "B4cNeutronCapture.hh"
+#include "B4cOpticalReadout.hh"
+#include "B4cScoringMesh.hh"
+
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+  const char kMagic[8] = "B4CKPT2";
+
+  // Fixed-size header identifying the run of a checkpoint file
+  struct Header {
+    char          magic[8];
+    std::int64_t  runSeed;
+    std::int64_t  eventOffset;
+    std::int32_t  nofEvents;
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+struct B4cCheckpoint::Writer
+{
+  std::ofstream fFile;
+  G4String fFileName;
+  G4int fNofUnflushed = 0;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cCheckpoint* B4cCheckpoint::fgInstance = nullptr;
+G4ThreadLocal B4cCheckpoint::Writer* B4cCheckpoint::fgWriter = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cCheckpoint* B4cCheckpoint::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4cCheckpoint();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cCheckpoint::B4cCheckpoint()
+ : fMessenger(nullptr),
+   fDirectory("checkpoints"),
+   fPeriod(0),
+   fResume(false),
+   fRunID(-1),
+   fNofEvents(0),
+   fRestoredRecords()
+{
+  // The checkpoint settings are shared by all threads, the commands are 
+  // therefore executed on master only
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/checkpoint/", "Run checkpointing");
+
+  auto& dirCmd 
+    = fMessenger->DeclareMethod("setDirectory", &B4cCheckpoint::SetDirectory,
+                                "Set the directory of the checkpoint files.");
+  dirCmd.SetParameterName("dirName", false);
+  dirCmd.command->SetToBeBroadcasted(false);
+
+  auto& periodCmd 
+    = fMessenger->DeclareMethod("setPeriod", &B4cCheckpoint::SetPeriod,
+                                "Set the number of events per thread between "
+                                "checkpoints (0 disables checkpointing).");
+  periodCmd.SetParameterName("nEvents", false);
+  periodCmd.SetRange("nEvents>=0");
+  periodCmd.command->SetToBeBroadcasted(false);
+
+  auto& resumeCmd 
+    = fMessenger->DeclareMethod("resume", &B4cCheckpoint::SetResume,
+                                "Resume the next run from its checkpoints.");
+  resumeCmd.SetParameterName("resume", true);
+  resumeCmd.SetDefaultValue("true");
+  resumeCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cCheckpoint::~B4cCheckpoint()
+{ 
+  CloseWriter();
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String B4cCheckpoint::GetFilePrefix(G4int runID) const
+{
+  auto seeder = B4EventSeeder::Instance();
+
+  std::ostringstream prefix;
+  prefix << "B4-run" << runID 
+         << "-seed" << seeder->GetRunSeed() 
+         << "-offset" << seeder->GetEventOffset() << "-";
+  return prefix.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cCheckpoint::BeginOfRun(const G4Run* run, G4bool isMaster)
+{
+  // The run parameters and the restored events are set on master,
+  // before the workers start processing events, and are read-only
+  // during the event loop
+  if ( ! isMaster ) return;
+
+  fRunID = run->GetRunID();
+  fNofEvents = run->GetNumberOfEventToBeProcessed();
+  fRestoredRecords.clear();
+
+  if ( fPeriod > 0 ) {
+    std::error_code error;
+    std::filesystem::create_directories(fDirectory.c_str(), error);
+  }
+
+  if ( ! fResume ) return;
+
+  // The step and track counts of the restored events are unknown
+  if ( B4NavigationBenchmark::Instance()->GetEnabled() ) {
+    G4ExceptionDescription msg;
+    msg << "The navigation benchmark cannot be used with resume: the steps"
+        << " of the restored events are not checkpointed." << G4endl
+        << "The run is aborted.";
+    G4Exception("B4cCheckpoint::BeginOfRun()",
+      "MyCode0007", RunMustBeAborted, msg);
+    return;
+  }
+
+  LoadCheckpoints(run);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cCheckpoint::EndOfRun(const G4Run* run, G4bool isMaster)
+{
+  CloseWriter();
+
+  // Workers have completed their event loop when the master ends the run
+  if ( ! isMaster ) return;
+
+  auto completed 
+    = run->GetNumberOfEvent() == run->GetNumberOfEventToBeProcessed();
+  if ( completed ) {
+    RemoveCheckpoints(run->GetRunID());
+  }
+  fRestoredRecords.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const B4cEventRecord* B4cCheckpoint::GetRestoredRecord(G4int eventID) const
+{
+  if ( fRestoredRecords.empty() ) return nullptr;
+
+  auto it = fRestoredRecords.find(eventID);
+  return ( it != fRestoredRecords.end() ) ? &(it->second) : nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cCheckpoint::Record(G4int eventID, const B4cEventRecord& record)
+{
+  if ( fPeriod <= 0 ) return;
+
+  // Open the file of this thread at its first event
+  if ( ! fgWriter ) {
+    fgWriter = new Writer();
+
+    std::ostringstream fileName;
+    fileName << fDirectory << "/" << GetFilePrefix(fRunID)
+             << "p" << ::getpid() << "-t" << G4Threading::G4GetThreadId() 
+             << ".ckpt";
+    fgWriter->fFileName = fileName.str();
+    fgWriter->fFile.open(fgWriter->fFileName, 
+                         std::ios::binary | std::ios::trunc);
+    if ( ! fgWriter->fFile ) {
+      G4ExceptionDescription msg;
+      msg << "Cannot open checkpoint file " << fgWriter->fFileName 
+          << ", the events of this thread are not checkpointed.";
+      G4Exception("B4cCheckpoint::Record()",
+        "MyCode0007", JustWarning, msg);
+    }
+    
+    auto seeder = B4EventSeeder::Instance();
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.runSeed = seeder->GetRunSeed();
+    header.eventOffset = seeder->GetEventOffset();
+    header.nofEvents = fNofEvents;
+    fgWriter->fFile.write(reinterpret_cast<const char*>(&header), 
+                          sizeof(header));
+  }
+
+  auto& file = fgWriter->fFile;
+  if ( ! file ) return;
+
+  std::int32_t id = eventID;
+  file.write(reinterpret_cast<const char*>(&id), sizeof(id));
+  file.write(reinterpret_cast<const char*>(record.fEdep.data()), 
+             sizeof(record.fEdep));
+  file.write(reinterpret_cast<const char*>(record.fTrackLength.data()), 
+             sizeof(record.fTrackLength));
+  file.write(reinterpret_cast<const char*>(record.fWeight.data()), 
+             sizeof(record.fWeight));
+
+  if ( ++fgWriter->fNofUnflushed >= fPeriod ) {
+    file.flush();
+    fgWriter->fNofUnflushed = 0;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cCheckpoint::CloseWriter()
+{
+  if ( ! fgWriter ) return;
+
+  if ( fgWriter->fFile ) {
+    fgWriter->fFile.flush();
+  }
+  delete fgWriter;
+  fgWriter = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cCheckpoint::LoadCheckpoints(const G4Run* run)
+{
+  auto prefix = GetFilePrefix(run->GetRunID());
+  auto seeder = B4EventSeeder::Instance();
+  G4int nofFiles = 0;
+
+  std::error_code error;
+  for ( const auto& entry 
+          : std::filesystem::directory_iterator(fDirectory.c_str(), error) ) {
+    auto name = entry.path().filename().string();
+    if ( name.compare(0, prefix.size(), prefix) != 0 || 
+         entry.path().extension() != ".ckpt" ) continue;
+
+    std::ifstream file(entry.path(), std::ios::binary);
+    Header header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if ( ! file || 
+         std::memcmp(header.magic, kMagic, sizeof(header.magic)) != 0 ||
+         header.runSeed != seeder->GetRunSeed() ||
+         header.eventOffset != seeder->GetEventOffset() ||
+         header.nofEvents != fNofEvents ) {
+      G4ExceptionDescription msg;
+      msg << "Checkpoint file " << entry.path().string() 
+          << " does not match this run, it is ignored.";
+      G4Exception("B4cCheckpoint::LoadCheckpoints()",
+        "MyCode0007", JustWarning, msg);
+      continue;
+    }
+
+    // A record truncated by the interruption is dropped
+    std::int32_t eventID;
+    B4cEventRecord record;
+    while ( file.read(reinterpret_cast<char*>(&eventID), sizeof(eventID)) &&
+            file.read(reinterpret_cast<char*>(record.fEdep.data()), 
+                      sizeof(record.fEdep)) &&
+            file.read(reinterpret_cast<char*>(record.fTrackLength.data()), 
+                      sizeof(record.fTrackLength)) &&
+            file.read(reinterpret_cast<char*>(record.fWeight.data()), 
+                      sizeof(record.fWeight)) ) {
+      if ( eventID >= 0 && eventID < fNofEvents ) {
+        fRestoredRecords[eventID] = record;
+      }
+    }
+    ++nofFiles;
+  }
+
+  G4cout << "### Run " << run->GetRunID() << " resumed: " 
+         << fRestoredRecords.size() << " of " << fNofEvents 
+         << " events restored from " << nofFiles << " checkpoint files in "
+         << fDirectory << G4endl;
+
+  // The accumulators outside the event record are not checkpointed
+  if ( fRestoredRecords.empty() ) return;
+
+  G4String features;
+  if ( B4cScoringMesh::Instance()->GetEnabled() ) features += " mesh";
+  if ( B4cOpticalReadout::Instance()->IsActive() ) features += " optical";
+  if ( B4cNeutronCapture::Instance()->GetEnabled() ) features += " neutron";
+  if ( B4RangeOut::Instance()->GetEnabled() ) features += " range-out";
+  if ( ! features.empty() ) {
+    G4ExceptionDescription msg;
+    msg << "The outputs of" << features << " are not checkpointed:" << G4endl
+        << "they do not include the " << fRestoredRecords.size() 
+        << " restored events.";
+    G4Exception("B4cCheckpoint::LoadCheckpoints()",
+      "MyCode0007", JustWarning, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cCheckpoint::RemoveCheckpoints(G4int runID) const
+{
+  auto prefix = GetFilePrefix(runID);
+
+  std::vector<std::filesystem::path> paths;
+  std::error_code error;
+  for ( const auto& entry 
+          : std::filesystem::directory_iterator(fDirectory.c_str(), error) ) {
+    auto name = entry.path().filename().string();
+    if ( name.compare(0, prefix.size(), prefix) == 0 ) {
+      paths.push_back(entry.path());
+    }
+  }
+  for ( const auto& path : paths ) {
+    std::filesystem::remove(path, error);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
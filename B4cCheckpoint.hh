@@ -0,0 +1,151 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cCheckpoint.hh
+/// \brief Definition of the B4cCheckpoint class
+
+#ifndef B4cCheckpoint_h
+#define B4cCheckpoint_h 1
+
+#include "B4cEventRecord.hh"
+
+#include "globals.hh"
+
+#include <map>
+
+class G4Run;
+class G4GenericMessenger;
+
+/// Periodic checkpointing of a run and resume after an interruption.
+///
+/// Each thread records the quantities of its completed events 
+/// (B4cEventRecord) in its own checkpoint file, which is flushed every 
+/// period events. No engine status is saved: the events are seeded from
+/// their key.
+/// As the events are seeded from (run seed, run ID, event ID) by 
+/// B4EventSeeder, an event does not depend on the events processed 
+/// before it on the same thread, and recording the completed events is 
+/// sufficient to resume a run in any threading configuration.
+///
+/// When the run is started again with resume set, the same run seed and
+/// the same number of events, the recorded events are not simulated 
+/// again: no primaries are generated for them and the event action fills
+/// the histograms and the ntuple with the recorded quantities. The 
+/// histograms, the main ntuple and the digits (seeded from the event key
+/// by B4cDigitizer) are then identical to those of an uninterrupted run.
+/// So are the run totals derived from the event records or the event 
+/// keys: the digit counts, the live time of the cosmic muons (counted 
+/// for the restored events too) and the weighted deposits of the 
+/// biased shield. The step and track counts of the navigation benchmark
+/// cannot be restored: resuming a run with the benchmark enabled is 
+/// refused.
+///
+/// Only the event records are checkpointed: the scoring mesh, the optical
+/// readout, the neutron capture statistics and the range-out counters 
+/// cover only the events simulated after the resume, and a warning is 
+/// issued when they are enabled. For these outputs the resumed run is 
+/// not equivalent to an uninterrupted run. The checkpoint files are 
+/// removed at the end of a completed run.
+///
+/// The following commands are defined (on master only):
+/// - /B4/checkpoint/setDirectory dirName
+/// - /B4/checkpoint/setPeriod nEvents  (0 disables checkpointing)
+/// - /B4/checkpoint/resume true|false
+
+class B4cCheckpoint
+{
+  public:
+    static B4cCheckpoint* Instance();
+    ~B4cCheckpoint();
+
+    // Called from the run action
+    void BeginOfRun(const G4Run* run, G4bool isMaster);
+    void EndOfRun(const G4Run* run, G4bool isMaster);
+
+    // Returns the restored quantities of the event, or nullptr
+    const B4cEventRecord* GetRestoredRecord(G4int eventID) const;
+
+    // Records the quantities of a completed event on the calling thread
+    void Record(G4int eventID, const B4cEventRecord& record);
+
+    // set/get methods
+    void     SetDirectory(const G4String& directory);
+    G4String GetDirectory() const;
+    void     SetPeriod(G4int nofEvents);
+    G4int    GetPeriod() const;
+    void     SetResume(G4bool resume);
+    G4bool   GetResume() const;
+
+  private:
+    B4cCheckpoint();
+
+    struct Writer;
+
+    G4String GetFilePrefix(G4int runID) const;
+    void LoadCheckpoints(const G4Run* run);
+    void RemoveCheckpoints(G4int runID) const;
+    void CloseWriter();
+
+    static B4cCheckpoint* fgInstance;
+    static G4ThreadLocal Writer* fgWriter;
+
+    G4GenericMessenger* fMessenger;
+    G4String fDirectory;
+    G4int    fPeriod;
+    G4bool   fResume;
+    G4int    fRunID;
+    G4int    fNofEvents;
+    std::map<G4int, B4cEventRecord> fRestoredRecords;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B4cCheckpoint::SetDirectory(const G4String& directory) {
+  fDirectory = directory;
+}
+
+inline G4String B4cCheckpoint::GetDirectory() const {
+  return fDirectory;
+}
+
+inline void B4cCheckpoint::SetPeriod(G4int nofEvents) {
+  fPeriod = nofEvents;
+}
+
+inline G4int B4cCheckpoint::GetPeriod() const {
+  return fPeriod;
+}
+
+inline void B4cCheckpoint::SetResume(G4bool resume) {
+  fResume = resume;
+}
+
+inline G4bool B4cCheckpoint::GetResume() const {
+  return fResume;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,54 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cCopyNumberFilter.hh
+/// \brief Definition of the B4cCopyNumberFilter class
+
+#ifndef B4cCopyNumberFilter_h
+#define B4cCopyNumberFilter_h 1
+
+#include "G4VSDFilter.hh"
+
+/// Sensitive detector filter accepting the steps in the physical volumes
+/// of a given copy number.
+///
+/// It selects the panel of a sensitive detector when several panels 
+/// are copies of the same logical volume.
+
+class B4cCopyNumberFilter : public G4VSDFilter
+{
+  public:
+    B4cCopyNumberFilter(const G4String& name, G4int copyNo);
+    virtual ~B4cCopyNumberFilter();
+
+    virtual G4bool Accept(const G4Step* step) const;
+
+  private:
+    G4int fCopyNo;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
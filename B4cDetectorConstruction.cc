@@ -5,23 +5,82 @@
 
 #include "B4cDetectorConstruction.hh"
 #include "B4cCalorimeterSD.hh"
+#include "B4cCopyNumberFilter.hh"
+#include "B4cNeutronCapture.hh"
+#include "B4cNeutronCaptureModel.hh"
+#include "B4cShield.hh"
+#include "B4Cache.hh"
 #include "G4Material.hh"
+#include "G4MaterialPropertiesTable.hh"
 #include "G4NistManager.hh"
 
 #include "G4Box.hh"
+#include "G4SubtractionSolid.hh"
 #include "G4LogicalVolume.hh"
 #include "G4PVPlacement.hh"
 #include "G4PVReplica.hh"
+#include "G4GeometryManager.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
 #include "G4GlobalMagFieldMessenger.hh"
 #include "G4AutoDelete.hh"
 
 #include "G4SDManager.hh"
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
 
 #include "G4VisAttributes.hh"
 #include "G4Colour.hh"
 
 #include "G4PhysicalConstants.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  // Describes the logical volume and its placement tree: the solids, the
+  // materials and the placement of each daughter
+  void DescribeTree(const G4LogicalVolume* logicalVolume, 
+                    std::ostream& description) {
+    auto material = logicalVolume->GetMaterial();
+    description << logicalVolume->GetName() << " " 
+                << ( material ? material->GetName() : "none" ) << " " 
+                << ( material ? material->GetDensity() : 0. ) << G4endl
+                << *logicalVolume->GetSolid();
+    for ( std::size_t i=0; i<logicalVolume->GetNoDaughters(); ++i ) {
+      auto daughter = logicalVolume->GetDaughter(i);
+      description << daughter->GetName() << " " << daughter->GetCopyNo()
+                  << " " << daughter->GetObjectTranslation() << " " 
+                  << daughter->GetObjectRotationValue() 
+                  << " " << daughter->GetMultiplicity() << G4endl;
+      DescribeTree(daughter->GetLogicalVolume(), description);
+    }
+  }
+
+  // Checks the daughters of each logical volume of the tree once
+  G4bool CheckTreeOverlaps(const G4LogicalVolume* logicalVolume, 
+                           std::set<const G4LogicalVolume*>& checked) {
+    if ( ! checked.insert(logicalVolume).second ) return false;
+
+    G4bool overlaps = false;
+    for ( std::size_t i=0; i<logicalVolume->GetNoDaughters(); ++i ) {
+      auto daughter = logicalVolume->GetDaughter(i);
+      overlaps = daughter->CheckOverlaps() || overlaps;
+      overlaps 
+        = CheckTreeOverlaps(daughter->GetLogicalVolume(), checked) || overlaps;
+    }
+    return overlaps;
+  }
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -33,22 +92,184 @@ G4GlobalMagFieldMessenger* B4cDetectorConstruction::fMagFieldMessenger = 0;
 B4cDetectorConstruction::B4cDetectorConstruction()
  : G4VUserDetectorConstruction(),
    fCheckOverlaps(true),
-   fNofLayers(-1)
+   fCacheOverlapsCheck(false),
+   fPrintMaterials(true),
+   fMaterialsDefined(false),
+   fNofLayers(-1),
+   fAbsoThickness(2.5*mm),
+   fPanelOffset(32.5*mm),
+   fSharedVolumes(false),
+   fSmartless(2.),
+   fLArGap(false),
+   fPanelMaterial("G4_Si"),
+   fNofRejectedChanges(0),
+   fMessenger(nullptr)
 {
+  // The geometry is shared by all threads, the commands are 
+  // therefore executed on master only
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/det/", "Detector geometry control");
+
+  auto& thicknessCmd 
+    = fMessenger->DeclareMethodWithUnit("setAbsoThickness", "mm",
+        &B4cDetectorConstruction::SetAbsoThickness,
+        "Set the half-thickness of the detector panels.");
+  thicknessCmd.SetParameterName("thickness", false);
+  thicknessCmd.SetRange("thickness>0.");
+  thicknessCmd.command->SetToBeBroadcasted(false);
+
+  auto& offsetCmd 
+    = fMessenger->DeclareMethodWithUnit("setPanelOffset", "mm",
+        &B4cDetectorConstruction::SetPanelOffset,
+        "Set the distance of the detector panels from the centre.");
+  offsetCmd.SetParameterName("offset", false);
+  offsetCmd.SetRange("offset>0.");
+  offsetCmd.command->SetToBeBroadcasted(false);
+
+  auto& sharedCmd 
+    = fMessenger->DeclareMethod("setSharedVolumes",
+        &B4cDetectorConstruction::SetSharedVolumes,
+        "Place the panels of the same shape as copies of one logical volume.");
+  sharedCmd.SetParameterName("shared", true);
+  sharedCmd.SetDefaultValue("true");
+  sharedCmd.command->SetToBeBroadcasted(false);
+
+  auto& smartlessCmd 
+    = fMessenger->DeclareMethod("setSmartless",
+        &B4cDetectorConstruction::SetSmartless,
+        "Set the smartless parameter of the world voxelization "
+        "(average number of voxels per daughter).");
+  smartlessCmd.SetParameterName("smartless", false);
+  smartlessCmd.SetRange("smartless>0.");
+  smartlessCmd.command->SetToBeBroadcasted(false);
+
+  auto& gapCmd 
+    = fMessenger->DeclareMethod("setLArGap",
+        &B4cDetectorConstruction::SetLArGap,
+        "Fill the space enclosed by the panels with liquid argon.");
+  gapCmd.SetParameterName("larGap", true);
+  gapCmd.SetDefaultValue("true");
+  gapCmd.command->SetToBeBroadcasted(false);
+
+  auto& materialCmd 
+    = fMessenger->DeclareMethod("setPanelMaterial",
+        &B4cDetectorConstruction::SetPanelMaterial,
+        "Set the material of the detector panels (defined or NIST name).");
+  materialCmd.SetParameterName("name", false);
+  materialCmd.command->SetToBeBroadcasted(false);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 B4cDetectorConstruction::~B4cDetectorConstruction()
 { 
+  delete fMessenger;
 }  
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void B4cDetectorConstruction::SetAbsoThickness(G4double thickness)
+{
+  if ( ! CheckPanels(thickness, fPanelOffset) ) {
+    ++fNofRejectedChanges;
+    return;
+  }
+
+  fAbsoThickness = thickness;
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cDetectorConstruction::SetPanelOffset(G4double offset)
+{
+  if ( ! CheckPanels(fAbsoThickness, offset) ) {
+    ++fNofRejectedChanges;
+    return;
+  }
+
+  fPanelOffset = offset;
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cDetectorConstruction::SetSharedVolumes(G4bool shared)
+{
+  fSharedVolumes = shared;
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cDetectorConstruction::SetSmartless(G4double smartless)
+{
+  fSmartless = smartless;
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cDetectorConstruction::SetLArGap(G4bool larGap)
+{
+  fLArGap = larGap;
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cDetectorConstruction::SetPanelMaterial(const G4String& name)
+{
+  if ( ! G4Material::GetMaterial(name, false) &&
+       ! G4NistManager::Instance()->FindOrBuildMaterial(name) ) {
+    G4ExceptionDescription msg;
+    msg << "Material " << name << " not found, the panel material "
+        << "is not changed.";
+    G4Exception("B4cDetectorConstruction::SetPanelMaterial()",
+      "MyCode0008", JustWarning, msg);
+    return;
+  }
+
+  fPanelMaterial = name;
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4cDetectorConstruction::CheckPanels(G4double thickness, 
+                                            G4double offset) const
+{
+  // The panels span 3 cm around the axes, they overlap 
+  // when their inner faces are closer to the centre
+  if ( offset - thickness >= 3*cm ) return true;
+
+  G4ExceptionDescription msg;
+  msg << "The panels of half-thickness " << G4BestUnit(thickness, "Length")
+      << " at " << G4BestUnit(offset, "Length") 
+      << " from the centre would overlap, the geometry is not changed.";
+  G4Exception("B4cDetectorConstruction::CheckPanels()",
+    "MyCode0008", JustWarning, msg);
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 G4VPhysicalVolume* B4cDetectorConstruction::Construct()
 {
-  // Define materials 
-  DefineMaterials();
+  // Define materials (once, the geometry can be rebuilt between runs)
+  if ( ! fMaterialsDefined ) {
+    DefineMaterials();
+    fMaterialsDefined = true;
+  }
+
+  // Delete the previous geometry when it is rebuilt
+  // (only the mass geometry, the parallel worlds are kept)
+  G4GeometryManager::GetInstance()->OpenGeometry();
+  auto previousWorld 
+    = G4PhysicalVolumeStore::GetInstance()->GetVolume("World", false);
+  if ( previousWorld ) {
+    DeleteVolumes(previousWorld);
+  }
   
   // Define volumes
   return DefineVolumes();
@@ -56,26 +277,88 @@ G4VPhysicalVolume* B4cDetectorConstruction::Construct()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void B4cDetectorConstruction::DeleteVolumes(G4VPhysicalVolume* worldPV) const
+{
+  // Collect the volumes placed in the world, then delete them
+  // (they are removed from their stores by their destructors)
+  std::set<G4VPhysicalVolume*> physicalVolumes = { worldPV };
+  std::set<G4LogicalVolume*> logicalVolumes;
+  std::vector<G4LogicalVolume*> toVisit = { worldPV->GetLogicalVolume() };
+  while ( ! toVisit.empty() ) {
+    auto logicalVolume = toVisit.back();
+    toVisit.pop_back();
+    if ( ! logicalVolumes.insert(logicalVolume).second ) continue;
+    for ( std::size_t i=0; i<logicalVolume->GetNoDaughters(); ++i ) {
+      auto daughter = logicalVolume->GetDaughter(i);
+      physicalVolumes.insert(daughter);
+      toVisit.push_back(daughter->GetLogicalVolume());
+    }
+  }
+
+  // (with the constituents of the boolean solids of the shield)
+  std::set<G4VSolid*> solids;
+  for ( auto logicalVolume : logicalVolumes ) {
+    auto solid = logicalVolume->GetSolid();
+    solids.insert(solid);
+    for ( G4int i=0; i<2 && solid->GetConstituentSolid(i); ++i ) {
+      solids.insert(solid->GetConstituentSolid(i));
+    }
+  }
+  for ( auto physicalVolume : physicalVolumes ) delete physicalVolume;
+  for ( auto logicalVolume : logicalVolumes ) delete logicalVolume;
+  for ( auto solid : solids ) delete solid;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void B4cDetectorConstruction::DefineMaterials()
 { 
   // Silicon material defined using NIST Manager
   auto nistManager = G4NistManager::Instance();
   nistManager->FindOrBuildMaterial("G4_Si");
   
-  // Liquid argon material - used previously for gap filling, omitted for this
-  // simulation
+  // Liquid argon material - used for the optional gap filling
   G4double a;  // mass of a mole;
   G4double z;  // z=mean number of protons;  
   G4double density; 
-  new G4Material("liquidArgon", z=18., a= 39.95*g/mole, density= 1.390*g/cm3);
+  auto liquidArgon
+    = new G4Material("liquidArgon", z=18., a= 39.95*g/mole, 
+                     density= 1.390*g/cm3);
          // The argon by NIST Manager is a gas with a different density
 
+  // Scintillation at 128 nm, used when the optical physics is registered
+  // (see B4cOpticalReadout)
+  std::vector<G4double> photonEnergies = { 9.0*eV, 9.69*eV, 10.5*eV };
+  auto larProperties = new G4MaterialPropertiesTable();
+  larProperties->AddProperty("RINDEX", photonEnergies, { 1.38, 1.38, 1.38 });
+  larProperties->AddProperty("ABSLENGTH", photonEnergies, 
+                             { 20.*m, 20.*m, 20.*m });
+  larProperties->AddProperty("RAYLEIGH", photonEnergies, 
+                             { 90.*cm, 90.*cm, 90.*cm });
+  larProperties->AddProperty("SCINTILLATIONCOMPONENT1", photonEnergies, 
+                             { 0., 1., 0. });
+  larProperties->AddProperty("SCINTILLATIONCOMPONENT2", photonEnergies, 
+                             { 0., 1., 0. });
+  larProperties->AddConstProperty("SCINTILLATIONYIELD", 40000./MeV);
+  larProperties->AddConstProperty("RESOLUTIONSCALE", 1.);
+  larProperties->AddConstProperty("SCINTILLATIONTIMECONSTANT1", 6.*ns);
+  larProperties->AddConstProperty("SCINTILLATIONTIMECONSTANT2", 1500.*ns);
+  larProperties->AddConstProperty("SCINTILLATIONYIELD1", 0.25);
+  larProperties->AddConstProperty("SCINTILLATIONYIELD2", 0.75);
+  liquidArgon->SetMaterialPropertiesTable(larProperties);
+
+  // Standard rock - used for the optional shield layers (see B4cShield)
+  new G4Material(B4cShield::kRockName, z=11., a=22.*g/mole, 
+                 density= 2.65*g/cm3);
+
   // Vacuum
   new G4Material("Galactic", z=1., a=1.01*g/mole,density= universe_mean_density,
                   kStateGas, 2.73*kelvin, 3.e-18*pascal);
 
   // Print materials
-  G4cout << *(G4Material::GetMaterialTable()) << G4endl;
+  if ( fPrintMaterials ) {
+    G4cout << *(G4Material::GetMaterialTable()) << G4endl;
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -84,18 +367,25 @@ G4VPhysicalVolume* B4cDetectorConstruction::DefineVolumes()
 {
   // Geometry parameters
   fNofLayers = 1;
-  G4double absoThickness = 2.5*mm;
+  G4double absoThickness = fAbsoThickness;
   G4double gapThickness = 50.*mm;
   G4double calorSizeXY  = 50.*cm;
 
   auto layerThickness = absoThickness + gapThickness;
   auto calorThickness = fNofLayers * layerThickness;
-  auto worldSizeXY = 50*mm;
-  auto worldSizeZ  = 50*mm; 
+  auto cavitySize = std::max(50*mm, fPanelOffset + absoThickness);
+  auto shield = B4cShield::Instance();
+  shield->SetInnerHalfSize(cavitySize);
+  auto worldSizeXY = cavitySize + shield->GetThickness();
+  auto worldSizeZ  = cavitySize + shield->GetThickness(); 
   
   // Get materials
   auto defaultMaterial = G4Material::GetMaterial("Galactic");
-  auto absorberMaterial = G4Material::GetMaterial("G4_Si");
+  auto absorberMaterial = G4Material::GetMaterial(fPanelMaterial, false);
+  if ( ! absorberMaterial ) {
+    absorberMaterial 
+      = G4NistManager::Instance()->FindOrBuildMaterial(fPanelMaterial);
+  }
   auto gapMaterial = G4Material::GetMaterial("liquidArgon");
   
   if ( ! defaultMaterial || ! absorberMaterial || ! gapMaterial ) {
@@ -130,170 +420,158 @@ G4VPhysicalVolume* B4cDetectorConstruction::DefineVolumes()
                  fCheckOverlaps);  // checking overlaps 
   
 
-  //                               
-  //                               
-  // Absorber RHS
-  //
-  auto absorberS 
-    = new G4Box("Abso",            // its name
-                 3*cm, 3*cm, absoThickness); // its size
-                         
-  auto absorberLV
-    = new G4LogicalVolume(
-                 absorberS,        // its solid
-                 absorberMaterial, // its material
-                 "AbsoLV");        // its name
-                                   
-   new G4PVPlacement(
-                 0,                // no rotation
-                 G4ThreeVector(0., 0., 32.5), // its position
-                 absorberLV,       // its logical volume                         
-                 "Abso",           // its name
-                 worldLV,          // its mother  volume
-                 false,            // no boolean operation
-                 0,                // copy number
-                 fCheckOverlaps);  // checking overlaps 
-
   //
+  // Absorber panels: RHS, LHS, bottom, front, back, top right, top left
+  // (in the order of the hits collections, the copy number of each 
+  // placement is its index)
   //
-  // Absorber LHS
-  //
-  auto absorber2S
-    = new G4Box("Abso2",            // its name
-                 3*cm, 3*cm, absoThickness); // its size
-
-  auto absorber2LV
-    = new G4LogicalVolume(
-                 absorber2S,        // its solid
-                 absorberMaterial, // its material
-                 "Abso2LV");        // its name
-
-   new G4PVPlacement(
+  struct Panel {
+    G4String suffix;
+    G4ThreeVector halfSize;
+    G4ThreeVector position;
+  };
+  const std::vector<Panel> panels = {
+    { "",  { 3*cm, 3*cm, absoThickness },    { 0., 0., fPanelOffset } },
+    { "2", { 3*cm, 3*cm, absoThickness },    { 0., 0., -fPanelOffset } },
+    { "3", { 3*cm, absoThickness, 3*cm },    { 0., -fPanelOffset, 0. } },
+    { "4", { absoThickness, 3.*cm, 3*cm },   { fPanelOffset, 0., 0. } },
+    { "5", { absoThickness, 3.*cm, 3*cm },   { -fPanelOffset, 0., 0. } },
+    { "6", { 3.*cm, absoThickness, 1.45*cm }, { 0., fPanelOffset, 15.5 } },
+    { "7", { 3.*cm, absoThickness, 1.45*cm }, { 0., fPanelOffset, -15.5 } }
+  };
+
+  // Each panel has its own logical volume, or the panels of the same 
+  // shape share one
+  std::vector<std::pair<G4ThreeVector, G4LogicalVolume*>> sharedLVs;
+  std::vector<G4LogicalVolume*> panelLVs;
+  for ( std::size_t i=0; i<panels.size(); ++i ) {
+    const auto& panel = panels[i];
+
+    G4LogicalVolume* absorberLV = nullptr;
+    if ( fSharedVolumes ) {
+      for ( const auto& sharedLV : sharedLVs ) {
+        if ( sharedLV.first == panel.halfSize ) absorberLV = sharedLV.second;
+      }
+    }
+
+    if ( ! absorberLV ) {
+      auto name = fSharedVolumes 
+                ? "Panel" + std::to_string(sharedLVs.size()) 
+                : "Abso" + panel.suffix;
+      auto absorberS 
+        = new G4Box(name,              // its name
+                    panel.halfSize.x(), panel.halfSize.y(), 
+                    panel.halfSize.z()); // its size
+
+      absorberLV
+        = new G4LogicalVolume(
+                    absorberS,         // its solid
+                    absorberMaterial,  // its material
+                    name + "LV");      // its name
+      sharedLVs.push_back({ panel.halfSize, absorberLV });
+    }
+
+    new G4PVPlacement(
                  0,                // no rotation
-                 G4ThreeVector(0., 0., -32.5), // its position
-                 absorber2LV,       // its logical volume
-                 "Abso2",           // its name
+                 panel.position,   // its position
+                 absorberLV,       // its logical volume
+                 "Abso" + panel.suffix, // its name
                  worldLV,          // its mother  volume
                  false,            // no boolean operation
-                 0,                // copy number
+                 G4int(i),         // copy number
                  fCheckOverlaps);  // checking overlaps
+    panelLVs.push_back(absorberLV);
+  }
 
- //
   //
-  // Absorber Bottom
+  // Liquid argon gap, filling the space enclosed by the panels
+  // (for the optical readout, see B4cOpticalReadout)
   //
-  auto absorber3S
-    = new G4Box("Abso3",            // its name
-                 3*cm, absoThickness, 3*cm); // its size
-
-  auto absorber3LV
-    = new G4LogicalVolume(
-                 absorber3S,        // its solid
-                 absorberMaterial, // its material
-                 "Abso3LV");        // its name
-
-   new G4PVPlacement(
+  if ( fLArGap ) {
+    auto gapHalfSize = std::min(fPanelOffset - absoThickness, 3*cm);
+    auto gapS 
+      = new G4Box("Gap",             // its name
+                  gapHalfSize, gapHalfSize, gapHalfSize); // its size
+
+    auto gapLV
+      = new G4LogicalVolume(
+                  gapS,              // its solid
+                  gapMaterial,       // its material
+                  "GapLV");          // its name
+
+    new G4PVPlacement(
                  0,                // no rotation
-                 G4ThreeVector(0., -32.5, 0.), // its position
-                 absorber3LV,       // its logical volume
-                 "Abso3",           // its name
+                 G4ThreeVector(),  // at the centre
+                 gapLV,            // its logical volume
+                 "Gap",            // its name
                  worldLV,          // its mother  volume
                  false,            // no boolean operation
                  0,                // copy number
                  fCheckOverlaps);  // checking overlaps
-
+  }
 
   //
-  // Absorber Front
+  // Shield layers, hollow boxes around the space of the panels from the 
+  // inside out (see B4cShield)
   //
-  auto absorber4S
-    = new G4Box("Abso4",            // its name
-                 absoThickness, 3.*cm, 3*cm); // its size
-
-  auto absorber4LV
-    = new G4LogicalVolume(
-                 absorber4S,        // its solid
-                 absorberMaterial, // its material
-                 "Abso4LV");        // its name
-
-   new G4PVPlacement(
+  auto layerInnerSize = cavitySize;
+  const auto& shieldLayers = shield->GetLayers();
+  for ( std::size_t i=0; i<shieldLayers.size(); ++i ) {
+    const auto& layer = shieldLayers[i];
+    auto layerMaterial = G4Material::GetMaterial(layer.fMaterial, false);
+    if ( ! layerMaterial ) {
+      layerMaterial 
+        = G4NistManager::Instance()->FindOrBuildMaterial(layer.fMaterial);
+    }
+    auto layerOuterSize = layerInnerSize + layer.fThickness;
+
+    auto name = "Shield" + std::to_string(i);
+    auto outerS 
+      = new G4Box(name + "Outer",    // its name
+                  layerOuterSize, layerOuterSize, 
+                  layerOuterSize);   // its size
+    auto innerS 
+      = new G4Box(name + "Inner",    // its name
+                  layerInnerSize, layerInnerSize, 
+                  layerInnerSize);   // its size
+    auto layerS 
+      = new G4SubtractionSolid(name, outerS, innerS);
+
+    auto layerLV
+      = new G4LogicalVolume(
+                  layerS,            // its solid
+                  layerMaterial,     // its material
+                  name + "LV");      // its name
+
+    new G4PVPlacement(
                  0,                // no rotation
-                 G4ThreeVector(32.5, 0., 0.), // its position
-                 absorber4LV,       // its logical volume
-                 "Abso4",           // its name
-                 worldLV,          // its mother  volume
-                 false,            // no boolean operation
-                 0,                // copy number
-                 fCheckOverlaps);  // checking overlaps
- 
-
-  //
-  // Absorber Back
-  //
-  auto absorber5S
-    = new G4Box("Abso5",            // its name
-                 absoThickness, 3.*cm, 3*cm); // its size
-
-  auto absorber5LV
-    = new G4LogicalVolume(
-                 absorber5S,        // its solid
-                 absorberMaterial, // its material
-                 "Abso5LV");        // its name
-
-   new G4PVPlacement(
-                 0,                // no rotation
-                 G4ThreeVector(-32.5, 0., 0.), // its position
-                 absorber5LV,       // its logical volume
-                 "Abso5",           // its name
-                 worldLV,          // its mother  volume
-                 false,            // no boolean operation
-                 0,                // copy number
-                 fCheckOverlaps);  // checking overlaps
-
-  //
-  // Absorber Top Right
-  //
-  auto absorber6S
-    = new G4Box("Abso6",            // its name
-                 3.*cm, absoThickness, 1.45*cm); // its size
-
-  auto absorber6LV
-    = new G4LogicalVolume(
-                 absorber6S,        // its solid
-                 absorberMaterial, // its material
-                 "Abso6LV");        // its name
-
-   new G4PVPlacement(
-                 0,                // no rotation
-                 G4ThreeVector(0., 32.5, 15.5), // its position
-                 absorber6LV,       // its logical volume
-                 "Abso6",           // its name
-                 worldLV,          // its mother  volume
-                 false,            // no boolean operation
-                 0,                // copy number
-                 fCheckOverlaps);  // checking overlaps
-  //
-  // Absorber Top Left
-  //
-  auto absorber7S
-    = new G4Box("Abso7",            // its name
-                 3.*cm, absoThickness, 1.45*cm); // its size
-
-  auto absorber7LV
-    = new G4LogicalVolume(
-                 absorber7S,        // its solid
-                 absorberMaterial, // its material
-                 "Abso7LV");        // its name
-
-   new G4PVPlacement(
-                 0,                // no rotation
-                 G4ThreeVector(0., 32.5,  -15.5), // its position
-                 absorber7LV,       // its logical volume
-                 "Abso7",           // its name
+                 G4ThreeVector(),  // at the centre
+                 layerLV,          // its logical volume
+                 name,             // its name
                  worldLV,          // its mother  volume
                  false,            // no boolean operation
                  0,                // copy number
                  fCheckOverlaps);  // checking overlaps
+    layerInnerSize = layerOuterSize;
+  }
+
+  // Target region of the panels, where the neutron capture is 
+  // parametrized (see B4cNeutronCapture); the volumes of a previous 
+  // geometry are removed from it when they are deleted
+  if ( B4cNeutronCapture::Instance()->GetEnabled() ) {
+    auto targetRegion 
+      = G4RegionStore::GetInstance()->GetRegion(
+          B4cNeutronCapture::kRegionName, false);
+    if ( ! targetRegion ) {
+      targetRegion = new G4Region(B4cNeutronCapture::kRegionName);
+    }
+    for ( auto panelLV : panelLVs ) {
+      targetRegion->AddRootLogicalVolume(panelLV);
+    }
+  }
+
+  // Voxelization of the panels in the world
+  worldLV->SetSmartless(fSmartless);
   
   //                                        
   // Visualization attributes
@@ -304,6 +582,13 @@ G4VPhysicalVolume* B4cDetectorConstruction::DefineVolumes()
   simpleBoxVisAtt->SetVisibility(true);
   worldLV->SetVisAttributes(simpleBoxVisAtt);
 
+  //
+  // Check overlaps once for this geometry
+  //
+  if ( fCacheOverlapsCheck ) {
+    CheckOverlapsOnce(worldLV);
+  }
+
   //
   // Always return the physical World
   //
@@ -312,45 +597,71 @@ G4VPhysicalVolume* B4cDetectorConstruction::DefineVolumes()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void B4cDetectorConstruction::CheckOverlapsOnce(G4LogicalVolume* worldLV) const
+{
+  // Describe the whole placement tree, the key of the check in the cache
+  std::ostringstream description;
+  DescribeTree(worldLV, description);
+  auto marker = B4Cache::GetDirectory() + "/overlaps-" 
+              + B4Cache::GetKey(description.str());
+
+  if ( std::ifstream(marker.c_str()) ) {
+    G4cout << "Checking overlaps skipped, geometry already checked in " 
+           << marker << G4endl;
+    return;
+  }
+
+  std::set<const G4LogicalVolume*> checked;
+  auto overlaps = CheckTreeOverlaps(worldLV, checked);
+
+  // Remember only the geometries without overlaps
+  if ( ! overlaps ) {
+    std::ofstream(marker.c_str()) << description.str();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void B4cDetectorConstruction::ConstructSDandField()
 {
   // G4SDManager::GetSDMpointer()->SetVerboseLevel(1);
 
   // 
   // Sensitive detectors
+  // (created once, and attached again when the geometry is rebuilt)
+  // Each detector accepts only the steps in the copy of its panel, 
+  // so that the panels sharing a logical volume are attached 
+  // several detectors (via G4MultiSensitiveDetector)
+  //
+  const G4int nofPanels = 7;
+  for ( G4int i=1; i<=nofPanels; ++i ) {
+    auto suffix = ( i > 1 ) ? std::to_string(i) : std::string();
+    auto sdName = "AbsorberSD" + suffix;
+
+    auto absoSD = G4SDManager::GetSDMpointer()->FindSensitiveDetector(
+                    sdName, false);
+    if ( ! absoSD ) {
+      absoSD = new B4cCalorimeterSD(
+                 sdName, "AbsorberHitsCollection" + suffix, fNofLayers);
+      absoSD->SetFilter(new B4cCopyNumberFilter(sdName + "Filter", i-1));
+      G4SDManager::GetSDMpointer()->AddNewDetector(absoSD);
+    }
+    auto absoPV 
+      = G4PhysicalVolumeStore::GetInstance()->GetVolume("Abso" + suffix);
+    SetSensitiveDetector(absoPV->GetLogicalVolume(), absoSD);
+  }
+
+  //
+  // Neutron capture model of the target region (created once per thread)
   //
-  auto absoSD 
-    = new B4cCalorimeterSD("AbsorberSD", "AbsorberHitsCollection", fNofLayers);
-  G4SDManager::GetSDMpointer()->AddNewDetector(absoSD);
-  SetSensitiveDetector("AbsoLV",absoSD);
-
-auto absoSD2
-    = new B4cCalorimeterSD("AbsorberSD2", "AbsorberHitsCollection2", fNofLayers);
-  G4SDManager::GetSDMpointer()->AddNewDetector(absoSD2);
-  SetSensitiveDetector("Abso2LV",absoSD2);
-
-auto absoSD3
-    = new B4cCalorimeterSD("AbsorberSD3", "AbsorberHitsCollection3", fNofLayers);
-  G4SDManager::GetSDMpointer()->AddNewDetector(absoSD3);
-  SetSensitiveDetector("Abso3LV",absoSD3);
-
-auto absoSD4
-    = new B4cCalorimeterSD("AbsorberSD4", "AbsorberHitsCollection4", fNofLayers);
-  G4SDManager::GetSDMpointer()->AddNewDetector(absoSD4);
-  SetSensitiveDetector("Abso4LV",absoSD4);
-
-auto absoSD5
-    = new B4cCalorimeterSD("AbsorberSD5", "AbsorberHitsCollection5", fNofLayers);
-  G4SDManager::GetSDMpointer()->AddNewDetector(absoSD5);
-  SetSensitiveDetector("Abso5LV",absoSD5);
-auto absoSD6
-    = new B4cCalorimeterSD("AbsorberSD6", "AbsorberHitsCollection6", fNofLayers);
-  G4SDManager::GetSDMpointer()->AddNewDetector(absoSD6);
-  SetSensitiveDetector("Abso6LV",absoSD6);
-auto absoSD7
-    = new B4cCalorimeterSD("AbsorberSD7", "AbsorberHitsCollection7", fNofLayers);
-  G4SDManager::GetSDMpointer()->AddNewDetector(absoSD7);
-  SetSensitiveDetector("Abso7LV",absoSD7);
+  auto targetRegion 
+    = G4RegionStore::GetInstance()->GetRegion(
+        B4cNeutronCapture::kRegionName, false);
+  if ( targetRegion && ! targetRegion->GetFastSimulationManager() ) {
+    auto model 
+      = new B4cNeutronCaptureModel("NeutronCaptureModel", targetRegion);
+    G4AutoDelete::Register(model);
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -35,7 +35,9 @@
 #include "globals.hh"
 
 class G4VPhysicalVolume;
+class G4LogicalVolume;
 class G4GlobalMagFieldMessenger;
+class G4GenericMessenger;
 
 /// Detector construction class to define materials and geometry.
 /// The calorimeter is a box made of a given number of layers. A layer consists
@@ -52,6 +54,45 @@ class G4GlobalMagFieldMessenger;
 /// are created and associated with the Absorber and Gap volumes.
 /// In addition a transverse uniform magnetic field is defined 
 /// via G4GlobalMagFieldMessenger class.
+///
+/// For fast start-up in batch jobs, the printing of the material table can
+/// be switched off, and the overlaps check at each placement can be 
+/// replaced with a single check of the whole geometry, which is skipped 
+/// when the same geometry was already found free of overlaps (see B4Cache).
+/// The geometry is identified by its whole placement tree: the solids,
+/// the materials, the translations and rotations of all the volumes.
+///
+/// The half-thickness of the panels and their distance from the centre
+/// can be changed between runs; only the mass geometry is then rebuilt, 
+/// the materials, the parallel worlds and the physics tables are kept. 
+/// The following commands are defined:
+/// - /B4/det/setAbsoThickness value unit
+/// - /B4/det/setPanelOffset value unit
+///
+/// For the navigation benchmarks (see B4NavigationBenchmark), the panels
+/// of the same shape can be placed as copies of one shared logical volume
+/// instead of each having its own, and the smartless parameter of the 
+/// world voxelization can be changed:
+/// - /B4/det/setSharedVolumes true|false
+/// - /B4/det/setSmartless value
+///
+/// The material of the panels (silicon by default) can be changed, e.g.
+/// for a hydrogenous plastic scintillator target of the inverse beta 
+/// decay generator (see B4IbdGenerator); the silicon response of the 
+/// digitization is then not meaningful:
+/// - /B4/det/setPanelMaterial name
+///
+/// The space enclosed by the panels can be filled with scintillating 
+/// liquid argon (the "Gap" volume, see B4cOpticalReadout):
+/// - /B4/det/setLArGap true|false
+///
+/// The panels can be surrounded by the layers of a shield (rock, lead,
+/// copper, see B4cShield), hollow boxes placed in the world around the 
+/// space of the panels; the world is enlarged to contain them.
+///
+/// When the neutron capture parametrization is enabled (see 
+/// B4cNeutronCapture), the panels form the target region, to which the
+/// fast simulation model B4cNeutronCaptureModel is attached.
 
 class B4cDetectorConstruction : public G4VUserDetectorConstruction
 {
@@ -62,12 +103,31 @@ class B4cDetectorConstruction : public G4VUserDetectorConstruction
   public:
     virtual G4VPhysicalVolume* Construct();
     virtual void ConstructSDandField();
+
+    // set methods
+    void SetPrintMaterials(G4bool value);
+    void SetCacheOverlapsCheck(G4bool value);
+    void SetAbsoThickness(G4double thickness);
+    void SetPanelOffset(G4double offset);
+    void SetSharedVolumes(G4bool shared);
+    void SetSmartless(G4double smartless);
+    void SetLArGap(G4bool larGap);
+    void SetPanelMaterial(const G4String& name);
+
+    // get methods
+    G4double GetAbsoThickness() const;
+    G4double GetPanelOffset() const;
+    // number of the geometry changes rejected so far (see B4ScanDriver)
+    G4int    GetNofRejectedChanges() const;
      
   private:
     // methods
     //
     void DefineMaterials();
     G4VPhysicalVolume* DefineVolumes();
+    void DeleteVolumes(G4VPhysicalVolume* worldPV) const;
+    void CheckOverlapsOnce(G4LogicalVolume* worldLV) const;
+    G4bool CheckPanels(G4double thickness, G4double offset) const;
   
     // data members
     //
@@ -75,10 +135,45 @@ class B4cDetectorConstruction : public G4VUserDetectorConstruction
                                       // magnetic field messenger
 
     G4bool  fCheckOverlaps; // option to activate checking of volumes overlaps
+    G4bool  fCacheOverlapsCheck; // option to check overlaps once per geometry
+    G4bool  fPrintMaterials; // option to print the material table
+    G4bool  fMaterialsDefined; // materials are defined only once
     G4int   fNofLayers;     // number of layers
+    G4double fAbsoThickness; // half-thickness of the panels
+    G4double fPanelOffset;   // distance of the panels from the centre
+    G4bool   fSharedVolumes; // panels of the same shape share their volume
+    G4double fSmartless;     // smartless of the world voxelization
+    G4bool   fLArGap;        // liquid argon gap enclosed by the panels
+    G4String fPanelMaterial; // material of the panels
+    G4int    fNofRejectedChanges; // panel changes rejected by CheckPanels
+
+    G4GenericMessenger* fMessenger;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+inline void B4cDetectorConstruction::SetPrintMaterials(G4bool value) {
+  fPrintMaterials = value;
+}
+
+inline void B4cDetectorConstruction::SetCacheOverlapsCheck(G4bool value) {
+  fCacheOverlapsCheck = value;
+  fCheckOverlaps = ! value;
+}
+
+inline G4double B4cDetectorConstruction::GetAbsoThickness() const {
+  return fAbsoThickness;
+}
+
+inline G4double B4cDetectorConstruction::GetPanelOffset() const {
+  return fPanelOffset;
+}
+
+inline G4int B4cDetectorConstruction::GetNofRejectedChanges() const {
+  return fNofRejectedChanges;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 #endif
 
@@ -0,0 +1,106 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cDigi.hh
+/// \brief Definition of the B4cDigi class
+
+#ifndef B4cDigi_h
+#define B4cDigi_h 1
+
+#include "G4VDigi.hh"
+#include "G4TDigiCollection.hh"
+#include "G4Allocator.hh"
+#include "G4Threading.hh"
+
+/// Digit of a detector panel, produced by B4cDigitizer
+///
+/// It defines data members to store the panel index, in the order of 
+/// the hits collections, the ADC value and the energy reconstructed
+/// from the ADC value:
+/// - fPanel, fAdc, fEnergy
+
+class B4cDigi : public G4VDigi
+{
+  public:
+    B4cDigi(G4int panel, G4int adc, G4double energy);
+    virtual ~B4cDigi();
+
+    inline void* operator new(size_t);
+    inline void  operator delete(void*);
+
+    // methods from base class
+    virtual void Draw() {}
+    virtual void Print();
+
+    // get methods
+    G4int    GetPanel() const;
+    G4int    GetAdc() const;
+    G4double GetEnergy() const;
+      
+  private:
+    G4int    fPanel;  ///< Index of the panel
+    G4int    fAdc;    ///< ADC value
+    G4double fEnergy; ///< Energy reconstructed from the ADC value
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+using B4cDigitsCollection = G4TDigiCollection<B4cDigi>;
+
+extern G4ThreadLocal G4Allocator<B4cDigi>* B4cDigiAllocator;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void* B4cDigi::operator new(size_t)
+{
+  if (!B4cDigiAllocator) {
+    B4cDigiAllocator = new G4Allocator<B4cDigi>;
+  }
+  return (void *) B4cDigiAllocator->MallocSingle();
+}
+
+inline void B4cDigi::operator delete(void *digi)
+{
+  if (!B4cDigiAllocator) {
+    B4cDigiAllocator = new G4Allocator<B4cDigi>;
+  }
+  B4cDigiAllocator->FreeSingle((B4cDigi*) digi);
+}
+
+inline G4int B4cDigi::GetPanel() const { 
+  return fPanel; 
+}
+
+inline G4int B4cDigi::GetAdc() const { 
+  return fAdc; 
+}
+
+inline G4double B4cDigi::GetEnergy() const { 
+  return fEnergy; 
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
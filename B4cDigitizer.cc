@@ -0,0 +1,78 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cDigitizer.cc
+/// \brief Implementation of the B4cDigitizer class
+
+#include "B4cDigitizer.hh"
+#include "B4cDigi.hh"
+#include "B4cSiliconResponse.hh"
+#include "B4EventSeeder.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cDigitizer::B4cDigitizer(const G4String& name)
+ : G4VDigitizerModule(name),
+   fRecord(),
+   fEngine()
+{
+  collectionName.push_back("PanelDigits");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cDigitizer::~B4cDigitizer()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cDigitizer::SetEventRecord(const G4Event* event, 
+                                  const B4cEventRecord& record)
+{
+  fRecord = record;
+  B4EventSeeder::Instance()->SeedStream(
+    event, B4EventSeeder::kDigitizationStream, &fEngine);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cDigitizer::Digitize()
+{
+  auto response = B4cSiliconResponse::Instance();
+  auto digits = new B4cDigitsCollection(GetName(), collectionName[0]);
+
+  for ( std::size_t i=0; i<B4cEventRecord::kNofPanels; ++i ) {
+    auto energy = response->Measure(fRecord.fEdep[i], &fEngine);
+    if ( energy < response->GetThreshold() ) continue;
+
+    auto adc = response->ToAdc(energy);
+    digits->insert(new B4cDigi(G4int(i), adc, response->ToEnergy(adc)));
+  }
+
+  // the collection is owned by the event
+  StoreDigiCollection(digits);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
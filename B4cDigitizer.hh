@@ -0,0 +1,75 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cDigitizer.hh
+/// \brief Definition of the B4cDigitizer class
+
+#ifndef B4cDigitizer_h
+#define B4cDigitizer_h 1
+
+#include "G4VDigitizerModule.hh"
+
+#include "B4cEventRecord.hh"
+
+#include "CLHEP/Random/MixMaxRng.h"
+
+class G4Event;
+
+/// Digitizer module of the detector panels.
+///
+/// It converts the energy deposits of the panels in digits 
+/// (B4cDigitsCollection "PanelDigits") with the response defined by 
+/// B4cSiliconResponse. The energy deposits are taken from the event 
+/// record set by the event action, so that the events restored from 
+/// a checkpoint are digitized as well.
+///
+/// The fluctuations are drawn from an engine of the digitizer, seeded 
+/// for each event from a derived stream of the event key (see 
+/// B4EventSeeder): the digits of an event do not depend on the numbers
+/// drawn by the simulation before, and they are reproduced when the 
+/// event is replayed or restored from a checkpoint.
+///
+/// A digitizer is created on each thread by the event action.
+
+class B4cDigitizer : public G4VDigitizerModule
+{
+  public:
+    B4cDigitizer(const G4String& name);
+    virtual ~B4cDigitizer();
+
+    virtual void Digitize();
+
+    void SetEventRecord(const G4Event* event, const B4cEventRecord& record);
+
+  private:
+    B4cEventRecord fRecord;
+    CLHEP::MixMaxRng fEngine;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
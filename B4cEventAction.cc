@@ -31,23 +31,45 @@
 #include "B4cEventAction.hh"
 #include "B4cCalorimeterSD.hh"
 #include "B4cCalorHit.hh"
+#include "B4cCheckpoint.hh"
+#include "B4cDigi.hh"
+#include "B4cDigitizer.hh"
+#include "B4cEventKeeper.hh"
+#include "B4cNeutronCapture.hh"
+#include "B4cOpticalReadout.hh"
+#include "B4cShield.hh"
+#include "B4cSiliconResponse.hh"
+#include "B4cTrigger.hh"
+#include "B4RangeOut.hh"
+#include "B4RunAction.hh"
+#include "B4SharedHistograms.hh"
 #include "B4Analysis.hh"
 
 #include "G4RunManager.hh"
 #include "G4Event.hh"
 #include "G4SDManager.hh"
 #include "G4HCofThisEvent.hh"
+#include "G4DigiManager.hh"
 #include "G4UnitsTable.hh"
 
 #include "Randomize.hh"
+#include <chrono>
 #include <iomanip>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-B4cEventAction::B4cEventAction()
+B4cEventAction::B4cEventAction(B4RunAction* runAction)
  : G4UserEventAction(),
-   fAbsHCID(-1)
-{}
+   fRunAction(runAction),
+   fDigitizer(nullptr),
+   fAbsHCID(-1),
+   fDigitsCID(-1)
+{
+  // the digitizer module is owned by the digitization manager
+  // of this thread
+  fDigitizer = new B4cDigitizer("B4cDigitizer");
+  G4DigiManager::GetDMpointer()->AddNewModule(fDigitizer);
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -56,12 +78,21 @@ B4cEventAction::~B4cEventAction()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+B4cCalorHitsCollection* 
+B4cEventAction::FindHitsCollection(G4int hcID, const G4Event* event) const
+{
+  auto hce = event->GetHCofThisEvent();
+  if ( ! hce || hcID < 0 ) return nullptr;
+
+  return static_cast<B4cCalorHitsCollection*>(hce->GetHC(hcID));
+}    
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 B4cCalorHitsCollection* 
 B4cEventAction::GetHitsCollection(G4int hcID, const G4Event* event) const
 {
-  auto hitsCollection 
-    = static_cast<B4cCalorHitsCollection*>(
-        event->GetHCofThisEvent()->GetHC(hcID));
+  auto hitsCollection = FindHitsCollection(hcID, event);
   
   if ( ! hitsCollection ) {
     G4ExceptionDescription msg;
@@ -95,7 +126,10 @@ void B4cEventAction::PrintEventStatistics(
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void B4cEventAction::BeginOfEventAction(const G4Event* /*event*/)
-{}
+{
+  B4RangeOut::Instance()->BeginOfEvent();
+  B4cOpticalReadout::Instance()->BeginOfEvent();
+}
 
 
 
@@ -109,8 +143,8 @@ void B4cEventAction::BeginOfEventAction(const G4Event* /*event*/)
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void B4cEventAction::EndOfEventAction(const G4Event* event)
-{  
+void B4cEventAction::GetHitsCollectionIDs()
+{
   // Get hits collections IDs (only once)
   if ( fAbsHCID == -1 ) {
     fAbsHCID 
@@ -128,7 +162,56 @@ void B4cEventAction::EndOfEventAction(const G4Event* event)
     fTopLHCID
       = G4SDManager::GetSDMpointer()->GetCollectionID("AbsorberHitsCollection7");
     }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+#if G4VERSION_NUMBER >= 1120
+void B4cEventAction::MergeSubEvent(G4Event* masterEvent, 
+                                   const G4Event* subEvent)
+{
+  GetHitsCollectionIDs();
+
+  // Add the panel totals of the sub-event to those of its event
+  // (a sub-event which did not reach a panel may have no collection)
+  for ( auto hcID : { fAbsHCID, fGapHCID, fBotHCID, fBackHCID, fFrontHCID, 
+                      fTopRHCID, fTopLHCID } ) {
+    auto masterHC = FindHitsCollection(hcID, masterEvent);
+    auto subEventHC = FindHitsCollection(hcID, subEvent);
+    if ( ! masterHC || ! masterHC->entries() ||
+         ! subEventHC || ! subEventHC->entries() ) continue;
+
+    auto subEventHit = (*subEventHC)[subEventHC->entries()-1];
+    (*masterHC)[masterHC->entries()-1]->Add(subEventHit->GetEdep(), 
+                                            subEventHit->GetTrackLength(),
+                                            subEventHit->GetWeight());
+  }
+}
+#endif
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cEventAction::EndOfEventAction(const G4Event* event)
+{  
+#if G4VERSION_NUMBER >= 1120
+  // The sub-events are merged in their event
+  if ( event->GetMotherEvent() ) return;
+#endif
+
+  // Complete the neutron records of the capture table
+  auto neutronCapture = B4cNeutronCapture::Instance();
+  if ( neutronCapture->IsRecording() ) {
+    neutronCapture->EndOfEvent(event->IsAborted());
+  }
+
+  // The events aborted by the trigger are only counted
+  auto trigger = B4cTrigger::Instance();
+  if ( event->IsAborted() ) {
+    trigger->EndOfEvent(event, nullptr);
+    return;
+  }
+
+  GetHitsCollectionIDs();
 
   // Get hits collections
 
@@ -149,77 +232,167 @@ void B4cEventAction::EndOfEventAction(const G4Event* event)
   auto topRHit = (*topRHC)[topRHC->entries()-1];
   auto topLHit = (*topLHC)[topLHC->entries()-1];
 
-  // Print per event (modulo n)
+  // Collect the event quantities, 
+  // or take them from the checkpoint if the event was restored
   //
   auto eventID = event->GetEventID();
-  auto printModulo = G4RunManager::GetRunManager()->GetPrintProgress();
-  if ( ( printModulo > 0 ) && ( eventID % printModulo == 0 ) ) {
-    G4cout << "---> End of event: " << eventID << G4endl;     
- 
-  // Define retrieval of deposited energies
-//  edepAbso = absoHit->GetEdep();
-//  edepGap = gapHit->GetEdep();
-//  edepTotal = edepAbso + edepGap;
+  auto checkpoint = B4cCheckpoint::Instance();
+  B4cEventRecord record;
+  if ( auto restored = checkpoint->GetRestoredRecord(eventID) ) {
+    record = *restored;
+  }
+  else {
+    const B4cCalorHit* hits[B4cEventRecord::kNofPanels] 
+      = { absoHit, gapHit, botHit, backHit, frontHit, topRHit, topLHit };
+    for ( std::size_t i=0; i<B4cEventRecord::kNofPanels; ++i ) {
+      record.fEdep[i] = hits[i]->GetEdep();
+      record.fTrackLength[i] = hits[i]->GetTrackLength();
+      record.fWeight[i] = hits[i]->GetWeight();
+    }
+  }
+  checkpoint->Record(eventID, record);
 
+  // With the biased shield transport, the clones of a track deposit in 
+  // the same event: only the weighted deposits are tallied
+  if ( B4cShield::Instance()->GetBiasing() ) {
+    fRunAction->AddWeightedEdep(record);
+    return;
+  }
 
+  // The events which do not fire the trigger are only counted, as if 
+  // they were aborted
+  trigger->EndOfEvent(event, &record);
+  if ( trigger->GetEnabled() && ! trigger->Fires(record.fEdep) ) return;
 
-    PrintEventStatistics(
-    //  edepTotal, absoHit->GetTrackLength());
-      absoHit->GetEdep(), absoHit->GetTrackLength());
-      gapHit->GetEdep(), gapHit->GetTrackLength();
-      botHit->GetEdep(), botHit->GetTrackLength(); 
-      backHit->GetEdep(), backHit->GetTrackLength();
-      frontHit->GetEdep(), frontHit->GetTrackLength();
-      topRHit->GetEdep(), topRHit->GetTrackLength();
-      topLHit->GetEdep(), topLHit->GetTrackLength(); 
+  // Keep the key of the event if it is selected
+  B4cEventKeeper::Instance()->Select(event, record);
 
+  // Print per event (modulo n)
+  //
+  auto printModulo = G4RunManager::GetRunManager()->GetPrintProgress();
+  if ( ( printModulo > 0 ) && ( eventID % printModulo == 0 ) ) {
+    G4cout << "---> End of event: " << eventID << G4endl;     
 
- }
+    PrintEventStatistics(record.fEdep[0], record.fTrackLength[0]);
+  }
   
-  // Fill histograms, ntuple
+  // Digitize the panels
   //
+  const B4cDigitsCollection* digits = nullptr;
+  if ( B4cSiliconResponse::Instance()->GetEnabled() ) {
+    digits = Digitize(event, record);
+  }
 
+  // Fill histograms, ntuples
+  //
+  auto fillStart = std::chrono::steady_clock::now();
+  FillAnalysis(record);
+  FillDigits(eventID, digits);
+  FillOptical(eventID, B4cOpticalReadout::Instance()->EndOfEvent());
+  fRunAction->AddOutputTime(std::chrono::duration<G4double>(
+                              std::chrono::steady_clock::now() - fillStart)
+                              .count());
+}  
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cEventAction::FillAnalysis(const B4cEventRecord& record) const
+{
   // get analysis manager
   auto analysisManager = G4AnalysisManager::Instance();
- 
 
+  const auto& edep = record.fEdep;
+  const auto& trackLength = record.fTrackLength;
+
+  // the panel quantities in the order of B4OutputLayout::kH1Names,
+  // which is also that of the ntuple columns
+  G4double values[2*B4cEventRecord::kNofPanels] 
+    = { edep[0], edep[1], trackLength[0], trackLength[1] };
+  for ( std::size_t i=2; i<B4cEventRecord::kNofPanels; ++i ) {
+    values[2*i] = edep[i];
+    values[2*i+1] = trackLength[i];
+  }
+
+  // fill histograms, ntuple
+  for ( G4int id=0; id<G4int(2*B4cEventRecord::kNofPanels); ++id ) {
+    analysisManager->FillH1(id, values[id]);
+    analysisManager->FillNtupleDColumn(id, values[id]);
+  }
+
+  // filling total energy into histogram
+  for ( auto panelEdep : edep ) {
+    analysisManager->FillH1(14, panelEdep);
+  }
+
+  // filling the shared fine-binned spectra of the panels with a deposit
+  auto sharedHistograms = B4SharedHistograms::Instance();
+  for ( std::size_t i=0; i<edep.size(); ++i ) {
+    if ( edep[i] > 0. ) sharedHistograms->Fill(G4int(i), edep[i]);
+  }
+
+  analysisManager->AddNtupleRow();  
+}  
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-  // fill histograms
-  analysisManager->FillH1(0, absoHit->GetEdep());
-  analysisManager->FillH1(1, gapHit->GetEdep());
-  analysisManager->FillH1(2, absoHit->GetTrackLength());
-  analysisManager->FillH1(3, gapHit->GetTrackLength());
-  analysisManager->FillH1(4, botHit->GetEdep());
-  analysisManager->FillH1(5, botHit->GetTrackLength());
-  analysisManager->FillH1(6, backHit->GetEdep());
-  analysisManager->FillH1(7, backHit->GetTrackLength());
-  analysisManager->FillH1(8, frontHit->GetEdep());
-  analysisManager->FillH1(9, frontHit->GetTrackLength());
-  analysisManager->FillH1(10, topRHit->GetEdep());
-  analysisManager->FillH1(11, topRHit->GetTrackLength());
-  analysisManager->FillH1(12, topLHit->GetEdep());
-  analysisManager->FillH1(13, topLHit->GetTrackLength());
+const B4cDigitsCollection* 
+B4cEventAction::Digitize(const G4Event* event, const B4cEventRecord& record)
+{
+  auto digiManager = G4DigiManager::GetDMpointer();
+  if ( fDigitsCID == -1 ) {
+    fDigitsCID = digiManager->GetDigiCollectionID("B4cDigitizer/PanelDigits");
+  }
 
-// filling total energy into histogram
-  analysisManager->FillH1(14, absoHit->GetEdep());
-  analysisManager->FillH1(14, gapHit->GetEdep());
-  analysisManager->FillH1(14, botHit->GetEdep());
-  analysisManager->FillH1(14, topRHit->GetEdep());
-  analysisManager->FillH1(14, topLHit->GetEdep());
-  analysisManager->FillH1(14, backHit->GetEdep());
-  analysisManager->FillH1(14, frontHit->GetEdep());
+  fDigitizer->SetEventRecord(event, record);
+  fDigitizer->Digitize();
 
+  return static_cast<const B4cDigitsCollection*>(
+           digiManager->GetDigiCollection(fDigitsCID));
+}
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void B4cEventAction::FillDigits(G4int eventID, 
+                                const B4cDigitsCollection* digits) const
+{
+  // no row for the events without digit
+  if ( ! digits || digits->entries() == 0 ) return;
 
+  auto analysisManager = G4AnalysisManager::Instance();
+  const G4int ntupleID = 1;
+
+  // columns: event ID, then the ADC value of each panel
+  G4int adcs[B4cEventRecord::kNofPanels] = {};
+  for ( std::size_t i=0; i<digits->entries(); ++i ) {
+    auto digi = (*digits)[i];
+    adcs[digi->GetPanel()] = digi->GetAdc();
+    fRunAction->AddDigit(digi->GetPanel());
+  }
+  analysisManager->FillNtupleIColumn(ntupleID, 0, eventID);
+  for ( std::size_t i=0; i<B4cEventRecord::kNofPanels; ++i ) {
+    analysisManager->FillNtupleIColumn(ntupleID, G4int(i)+1, adcs[i]);
+  }
+  analysisManager->AddNtupleRow(ntupleID);
+}
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-  // fill ntuple
-  analysisManager->FillNtupleDColumn(0, absoHit->GetEdep());
-  analysisManager->FillNtupleDColumn(1, gapHit->GetEdep());
-  analysisManager->FillNtupleDColumn(2, absoHit->GetTrackLength());
-  analysisManager->FillNtupleDColumn(3, gapHit->GetTrackLength());
-  analysisManager->AddNtupleRow();  
-}  
+void B4cEventAction::FillOptical(G4int eventID, 
+       const B4cOpticalReadout::Photoelectrons* photoelectrons) const
+{
+  // no row without the optical readout
+  if ( ! photoelectrons ) return;
+
+  auto analysisManager = G4AnalysisManager::Instance();
+  const G4int ntupleID = 2;
+
+  // columns: event ID, then the photoelectrons of each panel
+  analysisManager->FillNtupleIColumn(ntupleID, 0, eventID);
+  for ( std::size_t i=0; i<photoelectrons->size(); ++i ) {
+    analysisManager->FillNtupleIColumn(ntupleID, G4int(i)+1, 
+                                       (*photoelectrons)[i]);
+  }
+  analysisManager->AddNtupleRow(ntupleID);
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -34,31 +34,68 @@
 #include "G4UserEventAction.hh"
 
 #include "B4cCalorHit.hh"
+#include "B4cEventRecord.hh"
+#include "B4cDigi.hh"
+#include "B4cOpticalReadout.hh"
 
 #include "globals.hh"
+#include "G4Version.hh"
+
+class B4RunAction;
+class B4cDigitizer;
 
 /// Event action class
 ///
 /// In EndOfEventAction(), it prints the accumulated quantities of the energy 
 /// deposit and track lengths of charged particles in Absober and Gap layers 
-/// stored in the hits collections.
+/// stored in the hits collections, passes them to the checkpoint and 
+/// fills the histograms and the ntuple. The events restored from a 
+/// checkpoint are filled with their recorded quantities. When the 
+/// digitization is enabled, the quantities are then digitized by 
+/// B4cDigitizer and the digits are filled in the digits ntuple. With the
+/// optical readout of the gap (see B4cOpticalReadout), the photoelectrons
+/// of each panel are filled in the optical ntuple. The filling time is 
+/// added to the output time of the run action.
+///
+/// When the events are split in sub-events (see B4SubEventSplitter), 
+/// the panel totals of each sub-event are added to those of its event
+/// in MergeSubEvent(), on master, and the event is processed in 
+/// EndOfEventAction() once complete. The collections missing from a 
+/// sub-event are skipped.
+///
+/// The events aborted by the trigger (see B4cTrigger), or which do not 
+/// fire it, are only counted.
 
 class B4cEventAction : public G4UserEventAction
 {
 public:
-  B4cEventAction();
+  B4cEventAction(B4RunAction* runAction);
   virtual ~B4cEventAction();
 
   virtual void  BeginOfEventAction(const G4Event* event);
   virtual void    EndOfEventAction(const G4Event* event);
+#if G4VERSION_NUMBER >= 1120
+  virtual void MergeSubEvent(G4Event* masterEvent, const G4Event* subEvent);
+#endif
     
 private:
   // methods
+  B4cCalorHitsCollection* FindHitsCollection(G4int hcID,
+                                             const G4Event* event) const;
   B4cCalorHitsCollection* GetHitsCollection(G4int hcID,
                                             const G4Event* event) const;
   void PrintEventStatistics(G4double absoEdep, G4double absoTrackLength) const;
+  void FillAnalysis(const B4cEventRecord& record) const;
+  const B4cDigitsCollection* Digitize(const G4Event* event,
+                                      const B4cEventRecord& record);
+  void FillDigits(G4int eventID, const B4cDigitsCollection* digits) const;
+  void GetHitsCollectionIDs();
+  void FillOptical(G4int eventID, 
+       const B4cOpticalReadout::Photoelectrons* photoelectrons) const;
   
   // data members                   
+  B4RunAction* fRunAction;
+  B4cDigitizer* fDigitizer;
   G4int  fAbsHCID;
   G4int  fGapHCID;
   G4int  fBotHCID;
@@ -66,6 +103,7 @@ private:
   G4int  fTopLHCID;
   G4int  fFrontHCID;
   G4int  fBackHCID;
+  G4int  fDigitsCID;
 };
                      
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,327 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cEventKeeper.cc
+/// \brief Implementation of the B4cEventKeeper class
+
+#include "B4cEventKeeper.hh"
+#include "B4SubEventSplitter.hh"
+
+#include "G4Run.hh"
+#include "G4Event.hh"
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4UIcommand.hh"
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Version.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cEventKeeper* B4cEventKeeper::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cEventKeeper* B4cEventKeeper::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4cEventKeeper();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cEventKeeper::B4cEventKeeper()
+ : fMessenger(nullptr),
+   fEnabled(false),
+   fReplaying(false),
+   fMinPanels(2),
+   fThreshold(50.*keV),
+   fMinEnergy(0.),
+   fMaxEnergy(std::numeric_limits<G4double>::max()),
+   fKeys(),
+   fMutex()
+{
+  // The selection is shared by all threads: 
+  // the commands are executed on master only
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/keep/", "Event keeping and replay");
+
+  auto& enabledCmd 
+    = fMessenger->DeclareMethod("setEnabled", &B4cEventKeeper::SetEnabled,
+                                "Keep the keys of the selected events.");
+  enabledCmd.SetParameterName("enabled", true);
+  enabledCmd.SetDefaultValue("true");
+  enabledCmd.SetStates(G4State_PreInit, G4State_Idle);
+  enabledCmd.command->SetToBeBroadcasted(false);
+
+  auto& panelsCmd 
+    = fMessenger->DeclareProperty("setMinPanels", fMinPanels,
+                                  "Set the number of panels above "
+                                  "threshold of a kept event.");
+  panelsCmd.SetParameterName("nofPanels", false);
+  panelsCmd.SetRange("nofPanels>=0");
+  panelsCmd.command->SetToBeBroadcasted(false);
+
+  auto& thresholdCmd 
+    = fMessenger->DeclarePropertyWithUnit("setThreshold", "keV", fThreshold,
+                                          "Set the panel threshold of the "
+                                          "coincidence.");
+  thresholdCmd.SetParameterName("threshold", false);
+  thresholdCmd.command->SetToBeBroadcasted(false);
+
+  auto& minEnergyCmd 
+    = fMessenger->DeclarePropertyWithUnit("setMinEnergy", "MeV", fMinEnergy,
+                                          "Set the minimum total energy "
+                                          "deposit of a kept event.");
+  minEnergyCmd.SetParameterName("minEnergy", false);
+  minEnergyCmd.command->SetToBeBroadcasted(false);
+
+  auto& maxEnergyCmd 
+    = fMessenger->DeclarePropertyWithUnit("setMaxEnergy", "MeV", fMaxEnergy,
+                                          "Set the maximum total energy "
+                                          "deposit of a kept event.");
+  maxEnergyCmd.SetParameterName("maxEnergy", false);
+  maxEnergyCmd.command->SetToBeBroadcasted(false);
+
+  auto& replayCmd 
+    = fMessenger->DeclareMethod("replay", &B4cEventKeeper::Replay,
+                                "Simulate again the events of an index: "
+                                "indexFile [eventID ...].");
+  replayCmd.SetParameterName("arguments", false);
+  replayCmd.SetStates(G4State_Idle);
+  replayCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cEventKeeper::~B4cEventKeeper()
+{ 
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cEventKeeper::BeginOfRun()
+{
+  fKeys.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cEventKeeper::EndOfRun(const G4Run* run, 
+                              const G4String& outputFileName)
+{
+  if ( ! fEnabled || fReplaying ) return;
+
+  std::filesystem::path path(outputFileName.c_str());
+  path.replace_filename(path.stem().string() + "_kept.txt");
+
+  // the events are processed in any order by the threads
+  std::sort(fKeys.begin(), fKeys.end(), 
+            [](const EventKey& a, const EventKey& b) {
+              return a.fEventID < b.fEventID; });
+  Write(path.string(), run);
+
+  G4cout << "### Kept events: " << fKeys.size() << " of " 
+         << run->GetNumberOfEvent() << ", written in " << path.string()
+         << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4cEventKeeper::IsSelected(const B4cEventRecord& record) const
+{
+  G4int nofPanels = 0;
+  G4double energy = 0.;
+  for ( auto edep : record.fEdep ) {
+    if ( edep > fThreshold ) ++nofPanels;
+    energy += edep;
+  }
+  return nofPanels >= fMinPanels && 
+         energy >= fMinEnergy && energy <= fMaxEnergy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cEventKeeper::Select(const G4Event* event, 
+                            const B4cEventRecord& record)
+{
+  if ( ! fEnabled || fReplaying || ! IsSelected(record) ) return;
+
+  auto key = B4EventSeeder::Instance()->GetEventKey(event);
+  std::lock_guard<std::mutex> lock(fMutex);
+  fKeys.push_back(key);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cEventKeeper::Write(const G4String& fileName, 
+                           const G4Run* run) const
+{
+  std::ofstream file(fileName.c_str());
+  if ( ! file ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fileName << ".";
+    G4Exception("B4cEventKeeper::Write()",
+      "MyCode0014", JustWarning, msg);
+    return;
+  }
+
+  // the configuration of the run, only the engine is checked at replay
+  auto seeder = B4EventSeeder::Instance();
+  file << "# engine " << G4Random::getTheEngine()->name() << "\n"
+       << "# run " << run->GetRunID() 
+       << " runSeed " << seeder->GetRunSeed()
+       << " eventOffset " << seeder->GetEventOffset()
+       << " events " << run->GetNumberOfEvent()
+       << " threads " 
+       << G4RunManager::GetRunManager()->GetNumberOfThreads() << "\n"
+       << "# selection minPanels " << fMinPanels
+       << " threshold " << fThreshold / keV << " keV"
+       << " minEnergy " << fMinEnergy / MeV << " MeV"
+       << " maxEnergy ";
+  if ( fMaxEnergy < std::numeric_limits<G4double>::max() ) {
+    file << fMaxEnergy / MeV << " MeV\n";
+  }
+  else {
+    file << "none\n";
+  }
+  file << "# " << G4Version << "\n"
+       << "# runSeed runID eventID\n";
+  for ( const auto& key : fKeys ) {
+    file << key.fRunSeed << " " << key.fRunID << " " << key.fEventID 
+         << "\n";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4cEventKeeper::Read(const G4String& fileName, 
+                            std::vector<EventKey>& keys) const
+{
+  std::ifstream file(fileName.c_str());
+  if ( ! file ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fileName << ".";
+    G4Exception("B4cEventKeeper::Read()",
+      "MyCode0014", JustWarning, msg);
+    return false;
+  }
+
+  std::string line;
+  while ( std::getline(file, line) ) {
+    std::istringstream input(line);
+    if ( line.compare(0, 9, "# engine ") == 0 ) {
+      auto engine = line.substr(9);
+      if ( engine != G4Random::getTheEngine()->name() ) {
+        G4ExceptionDescription msg;
+        msg << "The events of " << fileName << " were generated with the "
+            << engine << " engine, they cannot be replayed with "
+            << G4Random::getTheEngine()->name() << ".";
+        G4Exception("B4cEventKeeper::Read()",
+          "MyCode0014", JustWarning, msg);
+        return false;
+      }
+      continue;
+    }
+    if ( line.empty() || line[0] == '#' ) continue;
+
+    EventKey key;
+    if ( ! ( input >> key.fRunSeed >> key.fRunID >> key.fEventID ) ) {
+      G4ExceptionDescription msg;
+      msg << "Wrong line \"" << line << "\" in " << fileName << ".";
+      G4Exception("B4cEventKeeper::Read()",
+        "MyCode0014", JustWarning, msg);
+      return false;
+    }
+    keys.push_back(key);
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cEventKeeper::Replay(const G4String& arguments)
+{
+  // The tracks of the sub-events are not seeded from the event key
+  if ( B4SubEventSplitter::Instance()->GetEnabled() ) {
+    G4ExceptionDescription msg;
+    msg << "The events cannot be replayed with the sub-event splitting "
+        << "enabled.";
+    G4Exception("B4cEventKeeper::Replay()",
+      "MyCode0014", JustWarning, msg);
+    return;
+  }
+
+  std::istringstream input(arguments);
+  std::string fileName;
+  input >> fileName;
+
+  std::vector<EventKey> keys;
+  if ( ! Read(fileName, keys) ) return;
+
+  // Select the listed event IDs, all events of the index if none
+  std::set<G4long> eventIDs;
+  G4long eventID;
+  while ( input >> eventID ) eventIDs.insert(eventID);
+  if ( ! eventIDs.empty() ) {
+    keys.erase(std::remove_if(keys.begin(), keys.end(),
+                 [&eventIDs](const EventKey& key) {
+                   return eventIDs.count(key.fEventID) == 0; }),
+               keys.end());
+  }
+
+  if ( keys.empty() ) {
+    G4ExceptionDescription msg;
+    msg << "No event to replay in " << fileName << ".";
+    G4Exception("B4cEventKeeper::Replay()",
+      "MyCode0014", JustWarning, msg);
+    return;
+  }
+
+  G4cout << G4endl << "### Replay of " << keys.size() << " events from " 
+         << fileName << G4endl;
+
+  // The event i of the replay run is seeded from the i-th key
+  auto seeder = B4EventSeeder::Instance();
+  seeder->SetReplayKeys(keys);
+  fReplaying = true;
+  G4UImanager::GetUIpointer()->ApplyCommand(
+    "/run/beamOn " + G4UIcommand::ConvertToString(G4int(keys.size())));
+  fReplaying = false;
+  seeder->SetReplayKeys({});
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
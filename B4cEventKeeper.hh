@@ -0,0 +1,126 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cEventKeeper.hh
+/// \brief Definition of the B4cEventKeeper class
+
+#ifndef B4cEventKeeper_h
+#define B4cEventKeeper_h 1
+
+#include "B4EventSeeder.hh"
+#include "B4cEventRecord.hh"
+
+#include "globals.hh"
+
+#include <mutex>
+#include <vector>
+
+class G4Run;
+class G4Event;
+class G4GenericMessenger;
+
+/// Selection of interesting events and their replay.
+///
+/// At the end of each event, the event is kept when at least the given
+/// number of panels have an energy deposit above the threshold and the 
+/// total energy deposit is in the given window. Only the key from which
+/// the event was seeded (run seed, run ID, event ID, see B4EventSeeder)
+/// is kept; the keys collected by all threads are written by master at 
+/// the end of run in a text index <output>_kept.txt, one event per line,
+/// after a header with the configuration of the run (engine, run seed, 
+/// event offset, number of events and threads, selection, Geant4 
+/// version).
+///
+/// The replay command reads an index and simulates only its events, or 
+/// the listed event IDs, seeded from their original keys, so that they 
+/// can be inspected with /tracking/verbose or the visualization (see 
+/// replay.mac). The replay needs the same random engine, geometry and 
+/// source settings as the original run; no events are kept during it.
+/// The events split in sub-events (see B4SubEventSplitter) are not 
+/// reproduced from their keys, the replay is refused when the splitting
+/// is enabled.
+///
+/// The following commands are defined (on master only):
+/// - /B4/keep/setEnabled true|false
+/// - /B4/keep/setMinPanels n
+/// - /B4/keep/setThreshold value unit
+/// - /B4/keep/setMinEnergy value unit
+/// - /B4/keep/setMaxEnergy value unit
+/// - /B4/keep/replay indexFile [eventID ...]
+
+class B4cEventKeeper
+{
+  public:
+    static B4cEventKeeper* Instance();
+    ~B4cEventKeeper();
+
+    // Called from the run action on master
+    void BeginOfRun();
+    void EndOfRun(const G4Run* run, const G4String& outputFileName);
+
+    // Called from the event action on each thread
+    void Select(const G4Event* event, const B4cEventRecord& record);
+
+    // Simulate again the events of an index
+    void Replay(const G4String& arguments);
+
+    // set/get methods
+    void   SetEnabled(G4bool enabled);
+    G4bool GetEnabled() const;
+
+  private:
+    B4cEventKeeper();
+
+    using EventKey = B4EventSeeder::EventKey;
+
+    G4bool IsSelected(const B4cEventRecord& record) const;
+    void   Write(const G4String& fileName, const G4Run* run) const;
+    G4bool Read(const G4String& fileName, std::vector<EventKey>& keys) const;
+
+    static B4cEventKeeper* fgInstance;
+
+    G4GenericMessenger* fMessenger;
+    G4bool   fEnabled;
+    G4bool   fReplaying;
+    G4int    fMinPanels;
+    G4double fThreshold;
+    G4double fMinEnergy;
+    G4double fMaxEnergy;
+    std::vector<EventKey> fKeys;
+    std::mutex fMutex;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B4cEventKeeper::SetEnabled(G4bool enabled) {
+  fEnabled = enabled;
+}
+
+inline G4bool B4cEventKeeper::GetEnabled() const {
+  return fEnabled;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
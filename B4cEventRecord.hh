@@ -0,0 +1,55 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cEventRecord.hh
+/// \brief Definition of the B4cEventRecord structure
+
+#ifndef B4cEventRecord_h
+#define B4cEventRecord_h 1
+
+#include "globals.hh"
+
+#include <array>
+
+/// Quantities of one event filled in the histograms and the ntuple:
+/// the energy deposit and the track length of charged particles in each 
+/// detector panel, in the order of the hits collections
+/// AbsorberHitsCollection, AbsorberHitsCollection2, ... 7.
+///
+/// The quantities are not weighted. With the biased shield transport
+/// (see B4cShield), fWeight is the mean weight of the tracks over the 
+/// deposit of each panel, so that the weight times the deposit is the
+/// weighted deposit tallied by the run action.
+
+struct B4cEventRecord
+{
+  static constexpr std::size_t kNofPanels = 7;
+
+  std::array<G4double, kNofPanels> fEdep {};
+  std::array<G4double, kNofPanels> fTrackLength {};
+  std::array<G4double, kNofPanels> fWeight { 1., 1., 1., 1., 1., 1., 1. };
+};
+
+#endif
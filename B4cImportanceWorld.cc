@@ -0,0 +1,100 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cImportanceWorld.cc
+/// \brief Implementation of the B4cImportanceWorld class
+
+#include "B4cImportanceWorld.hh"
+#include "B4cShield.hh"
+
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4PVPlacement.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const G4String B4cImportanceWorld::kWorldName = "B4cImportanceWorld";
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cImportanceWorld::B4cImportanceWorld(const G4String& worldName)
+ : G4VUserParallelWorld(worldName),
+   fWorldSolid(nullptr)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cImportanceWorld::~B4cImportanceWorld()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cImportanceWorld::Construct()
+{
+  // Delete the cells of the previous geometry
+  auto worldPV = GetWorld();
+  auto worldLV = worldPV->GetLogicalVolume();
+  DeleteCells(worldPV);
+
+  // The world of the parallel world, with its own solid
+  // (it is created with the solid of the mass world, which is deleted
+  // when the mass geometry is rebuilt)
+  auto halfSizes = B4cShield::Instance()->GetCellHalfSizes();
+  auto worldS 
+    = new G4Box(kWorldName, halfSizes[0], halfSizes[0], halfSizes[0]);
+  worldLV->SetSolid(worldS);
+  delete fWorldSolid;
+  fWorldSolid = worldS;
+
+  // Cells, each placed in the previous one
+  auto motherLV = worldLV;
+  for ( std::size_t i=1; i<halfSizes.size(); ++i ) {
+    auto name = "ImportanceCell" + std::to_string(i);
+    auto cellS 
+      = new G4Box(name, halfSizes[i], halfSizes[i], halfSizes[i]);
+    auto cellLV = new G4LogicalVolume(cellS, nullptr, name + "LV");
+    new G4PVPlacement(0, G4ThreeVector(), cellLV, name, motherLV, false, 0);
+    motherLV = cellLV;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cImportanceWorld::DeleteCells(G4VPhysicalVolume* worldPV) const
+{
+  auto motherLV = worldPV->GetLogicalVolume();
+  if ( motherLV->GetNoDaughters() == 0 ) return;
+
+  auto cellPV = motherLV->GetDaughter(0);
+  DeleteCells(cellPV);
+
+  auto cellLV = cellPV->GetLogicalVolume();
+  auto cellS = cellLV->GetSolid();
+  motherLV->RemoveDaughter(cellPV);
+  delete cellPV;
+  delete cellLV;
+  delete cellS;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
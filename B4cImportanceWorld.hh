@@ -0,0 +1,63 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cImportanceWorld.hh
+/// \brief Definition of the B4cImportanceWorld class
+
+#ifndef B4cImportanceWorld_h
+#define B4cImportanceWorld_h 1
+
+#include "G4VUserParallelWorld.hh"
+
+class G4VPhysicalVolume;
+class G4VSolid;
+
+/// Parallel world of the importance cells of the shield (see B4cShield).
+///
+/// The cells are nested boxes, one level per cell from the outer face of
+/// the shield to the space of the panels, so that each cell is the only 
+/// daughter of the next one outward. Unlike the dose mesh, the cells 
+/// follow the shield: they are rebuilt each time the mass geometry is, 
+/// and the world of the parallel world gets its own box of the size of
+/// the mass world.
+
+class B4cImportanceWorld : public G4VUserParallelWorld
+{
+  public:
+    static const G4String kWorldName;
+
+    B4cImportanceWorld(const G4String& worldName);
+    virtual ~B4cImportanceWorld();
+
+    virtual void Construct();
+
+  private:
+    void DeleteCells(G4VPhysicalVolume* worldPV) const;
+
+    G4VSolid* fWorldSolid;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
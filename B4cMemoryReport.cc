@@ -0,0 +1,197 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cMemoryReport.cc
+/// \brief Implementation of the B4cMemoryReport class
+
+#include "B4cMemoryReport.hh"
+#include "B4cCalorHit.hh"
+#include "B4MemoryProbe.hh"
+#include "B4Analysis.hh"
+#include "B4OutputLayout.hh"
+#include "B4RunAction.hh"
+
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4MTRunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+#include "G4Track.hh"
+#include "G4DynamicParticle.hh"
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+namespace {
+  G4Mutex reportMutex = G4MUTEX_INITIALIZER;
+
+  // Size in bytes, or null when it is not available
+  G4String ToJson(G4double size) {
+    if ( size < 0. ) return "null";
+    std::ostringstream text;
+    text << size;
+    return text.str();
+  }
+
+  template <typename T>
+  G4double GetPoolSize(G4Allocator<T>* allocator) {
+    return allocator ? allocator->GetAllocatedSize() : 0.;
+  }
+
+  // Bins (with under- and overflow) times the per-bin sums of h1d:
+  // entries, Sw, Sw2, Sxw, Sx2w
+  G4double GetH1Size() {
+    auto analysisManager = G4AnalysisManager::Instance();
+    G4double size = 0.;
+    for ( G4int id=0; id<analysisManager->GetNofH1s(); ++id ) {
+      auto h1 = analysisManager->GetH1(id, false);
+      if ( ! h1 ) continue;
+      size += ( h1->axis().bins() + 2 ) 
+              * ( sizeof(std::size_t) + 4*sizeof(G4double) );
+    }
+    return size;
+  }
+
+  // Default Root basket size per column, times the columns of the active
+  // ntuples (their IDs follow the booking in B4RunAction)
+  G4double GetNtupleSize() {
+    const G4double kBasketSize = 32000.;
+    const std::vector<const std::vector<G4String>*> columns = {
+      &B4OutputLayout::kNtupleColumns, 
+      &B4OutputLayout::kDigiNtupleColumns,
+      &B4OutputLayout::kOpticalNtupleColumns };
+    auto analysisManager = G4AnalysisManager::Instance();
+    G4double size = 0.;
+    for ( G4int id=0; id<G4int(columns.size()); ++id ) {
+      if ( ! analysisManager->GetNtupleActivation(id) ) continue;
+      size += columns[id]->size() * kBasketSize;
+    }
+    return size;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cMemoryReport* B4cMemoryReport::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cMemoryReport* B4cMemoryReport::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4cMemoryReport();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cMemoryReport::B4cMemoryReport()
+ : fMessenger(nullptr),
+   fFileName(),
+   fSharedSize(0.),
+   fSplitRunID(-1)
+{
+  // The report is shared by all threads, the commands are 
+  // therefore executed on master only
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/memory/", "Memory report control");
+
+  auto& fileCmd 
+    = fMessenger->DeclareMethod("setReportFile", &B4cMemoryReport::SetFileName,
+        "Set the JSON lines report file (empty string disables the report).");
+  fileCmd.SetParameterName("fileName", true);
+  fileCmd.SetDefaultValue("");
+  fileCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cMemoryReport::~B4cMemoryReport()
+{ 
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cMemoryReport::Write(const G4Run* run, const G4String& phase, 
+                            G4bool isMaster)
+{
+  // The split is measured from the first run, also when it is not reported
+  auto rss = B4MemoryProbe::GetResidentSize();
+  if ( isMaster && phase == "begin" && fSplitRunID < 0 ) {
+    fSplitRunID = run->GetRunID();
+    fSharedSize = rss;
+  }
+
+  if ( fFileName.empty() ) return;
+
+  const auto& shard = B4RunAction::GetFileTag();
+
+  std::ostringstream record;
+  record << "{\"pid\":" << ::getpid()
+         << ",\"shard\":\"" << shard << "\""
+         << ",\"run\":" << run->GetRunID()
+         << ",\"phase\":\"" << phase << "\""
+         << ",\"thread\":" << G4Threading::G4GetThreadId()
+         << ",\"rss\":" << ToJson(rss)
+         << ",\"peakRss\":" << ToJson(B4MemoryProbe::GetPeakResidentSize())
+         << ",\"hitPool\":" << GetPoolSize(B4cCalorHitAllocator)
+         << ",\"trackPool\":" << GetPoolSize(aTrackAllocator())
+         << ",\"particlePool\":" << GetPoolSize(pDynamicParticleAllocator())
+         << ",\"h1\":" << GetH1Size()
+         << ",\"ntuple\":" << GetNtupleSize();
+
+  // Shared versus replicated split, on master and for the first run only
+  auto mtRunManager 
+    = dynamic_cast<G4MTRunManager*>(G4RunManager::GetRunManager());
+  auto nofWorkers = mtRunManager ? mtRunManager->GetNumberOfThreads() : 0;
+  if ( isMaster && phase == "end" && run->GetRunID() == fSplitRunID && 
+       rss >= 0. && fSharedSize >= 0. ) {
+    auto replicated 
+      = ( nofWorkers > 0 ) ? ( rss - fSharedSize ) / nofWorkers : 0.;
+    record << ",\"workers\":" << nofWorkers
+           << ",\"shared\":" << fSharedSize
+           << ",\"replicatedPerWorker\":" << replicated;
+
+    G4cout << "### Memory [run " << run->GetRunID() << "]: shared " 
+           << fSharedSize / (1024.*1024.) << " MB, replicated "
+           << replicated / (1024.*1024.) << " MB per worker (" 
+           << nofWorkers << " workers)" << G4endl;
+  }
+  record << "}";
+
+  auto fileName = fFileName;
+  if ( shard.size() ) fileName = B4RunAction::TagFileName(fileName, shard);
+
+  G4AutoLock lock(&reportMutex);
+  std::ofstream file(fileName, std::ios::app);
+  file << record.str() << std::endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,95 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cMemoryReport.hh
+/// \brief Definition of the B4cMemoryReport class
+
+#ifndef B4cMemoryReport_h
+#define B4cMemoryReport_h 1
+
+#include "globals.hh"
+
+class G4Run;
+class G4GenericMessenger;
+
+/// Memory accounting per thread, written as JSON lines.
+///
+/// The report is disabled by default. When a file is set, at the 
+/// beginning and at the end of each run, each thread (master and workers)
+/// appends one record with:
+/// - the process ID and the shard tag of the output files (pid, shard),
+///   which identify the records of parallel jobs; the file name is also
+///   tagged with the shard,
+/// - the process resident and peak resident sizes (rss, peakRss),
+/// - the bytes held by the thread allocator pools of the calorimeter 
+///   hits, the tracks and the dynamic particles (hitPool, trackPool, 
+///   particlePool),
+/// - an estimate of the bytes of the thread histograms (h1),
+/// - an estimate of the bytes of the thread ntuple buffers (ntuple): 
+///   one Root basket of 32000 bytes per column of the active ntuples.
+/// The sizes of the process are null when they are not available.
+/// The record of master at the end of the first run adds the shared 
+/// versus replicated split: the resident size when the first run starts,
+/// before the workers build their geometry and physics tables, is counted 
+/// as shared, and its growth until the end of the run is divided by the
+/// number of workers (replicatedPerWorker). A summary line is also 
+/// printed. The later runs start with the workers already built and do
+/// not report the split.
+///
+/// The following command is defined:
+/// - /B4/memory/setReportFile fileName  (empty string disables the report)
+
+class B4cMemoryReport
+{
+  public:
+    static B4cMemoryReport* Instance();
+    ~B4cMemoryReport();
+
+    // Append the record of the calling thread
+    void Write(const G4Run* run, const G4String& phase, G4bool isMaster);
+
+    // set methods
+    void SetFileName(const G4String& fileName);
+
+  private:
+    B4cMemoryReport();
+
+    static B4cMemoryReport* fgInstance;
+
+    G4GenericMessenger* fMessenger;
+    G4String fFileName;
+    G4double fSharedSize;
+    G4int fSplitRunID;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B4cMemoryReport::SetFileName(const G4String& fileName) {
+  fFileName = fileName;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
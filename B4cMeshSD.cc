@@ -0,0 +1,71 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cMeshSD.cc
+/// \brief Implementation of the B4cMeshSD class
+
+#include "B4cMeshSD.hh"
+#include "B4cScoringMesh.hh"
+#include "B4cShield.hh"
+
+#include "G4Step.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cMeshSD::B4cMeshSD(const G4String& name)
+ : G4VSensitiveDetector(name)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cMeshSD::~B4cMeshSD() 
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4cMeshSD::ProcessHits(G4Step* step, G4TouchableHistory*)
+{
+  auto edep = step->GetTotalEnergyDeposit();
+  auto stepLength = step->GetStepLength();
+  if ( edep == 0. && stepLength == 0. ) return false;
+
+  // voxel: replica along z, in the slice along y, in the slice along x
+  auto touchable = step->GetPreStepPoint()->GetTouchable();
+  auto iz = touchable->GetReplicaNumber(0);
+  auto iy = touchable->GetReplicaNumber(1);
+  auto ix = touchable->GetReplicaNumber(2);
+
+  // the energy is converted in dose by the mesh at the end of run,
+  // the fluence is the track length over the voxel volume
+  auto mesh = B4cScoringMesh::Instance();
+  auto volume = mesh->GetVoxelVolume();
+
+  // the weight of the track when the shield transport is biased
+  auto weight = B4cShield::Instance()->GetWeight(step->GetTrack());
+  mesh->Fill(ix, iy, iz, edep, stepLength / volume, weight);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
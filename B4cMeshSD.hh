@@ -0,0 +1,54 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cMeshSD.hh
+/// \brief Definition of the B4cMeshSD class
+
+#ifndef B4cMeshSD_h
+#define B4cMeshSD_h 1
+
+#include "G4VSensitiveDetector.hh"
+
+/// Sensitive detector of the voxels of the dose and fluence mesh.
+///
+/// In ProcessHits(), the voxel indices are given by the replica numbers
+/// of the step and the energy deposit and the fluence of the step are 
+/// accumulated in the map of the thread (see B4cScoringMesh), which 
+/// converts the energy in dose at the end of run, weighted by the track
+/// weight when the shield transport is biased (see B4cShield). 
+/// It creates no hits.
+
+class B4cMeshSD : public G4VSensitiveDetector
+{
+  public:
+    B4cMeshSD(const G4String& name);
+    virtual ~B4cMeshSD();
+  
+    virtual G4bool ProcessHits(G4Step* step, G4TouchableHistory* history);
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,493 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cNeutronCapture.cc
+/// \brief Implementation of the B4cNeutronCapture class
+
+#include "B4cNeutronCapture.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4VProcess.hh"
+#include "G4Neutron.hh"
+#include "G4ProcessManager.hh"
+#include "G4Gamma.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4RunManager.hh"
+#include "G4VModularPhysicsList.hh"
+#include "G4FastSimulationPhysics.hh"
+#include "G4GenericMessenger.hh"
+#include "G4AccumulableManager.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace {
+  // Energy bins of the table: 1/5 decade from 1e-10 MeV to 100 MeV
+  const G4int kNofBinsPerDecade = 5;
+  const G4double kMinLogEnergy = -10.;
+  const std::size_t kNofBins = 12 * kNofBinsPerDecade;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cNeutronCapture* B4cNeutronCapture::fgInstance = nullptr;
+G4ThreadLocal B4cNeutronCapture::Statistics* 
+  B4cNeutronCapture::fgStatistics = nullptr;
+G4ThreadLocal std::vector<B4cNeutronCapture::Record>* 
+  B4cNeutronCapture::fgRecords = nullptr;
+G4ThreadLocal B4cNeutronCapture::EventRecords* 
+  B4cNeutronCapture::fgEventRecords = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cNeutronCapture* B4cNeutronCapture::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4cNeutronCapture();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cNeutronCapture::B4cNeutronCapture()
+ : fMessenger(nullptr),
+   fEnabled(false),
+   fMode("full"),
+   fTableFile("neutron_capture.txt"),
+   fMaxEnergy(20.*MeV),
+   fRegion(nullptr),
+   fTable(),
+   fMergedRecords()
+{
+  // The parametrization is shared by all threads:
+  // the commands are executed on master only
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/neutron/", 
+                             "Neutron capture parametrization");
+
+  auto& enabledCmd 
+    = fMessenger->DeclareMethod("setEnabled", &B4cNeutronCapture::SetEnabled,
+                                "Define the target region and the fast "
+                                "simulation of the neutrons.");
+  enabledCmd.SetStates(G4State_PreInit);
+  enabledCmd.command->SetToBeBroadcasted(false);
+
+  auto& modeCmd 
+    = fMessenger->DeclareMethod("setMode", &B4cNeutronCapture::SetMode,
+                                "Track the neutrons fully, calibrate the "
+                                "table, validate it or use it.");
+  modeCmd.SetParameterName("mode", false);
+  modeCmd.SetCandidates("full calibrate validate fast");
+  modeCmd.SetStates(G4State_PreInit, G4State_Idle);
+  modeCmd.command->SetToBeBroadcasted(false);
+
+  auto& tableCmd 
+    = fMessenger->DeclareProperty("setTableFile", fTableFile,
+                                  "Set the file of the capture table.");
+  tableCmd.SetParameterName("fileName", false);
+  tableCmd.SetStates(G4State_PreInit, G4State_Idle);
+  tableCmd.command->SetToBeBroadcasted(false);
+
+  auto& energyCmd 
+    = fMessenger->DeclarePropertyWithUnit("setMaxEnergy", "MeV", fMaxEnergy,
+                                          "Set the maximum energy of the "
+                                          "parametrized neutrons.");
+  energyCmd.SetParameterName("maxEnergy", false);
+  energyCmd.SetRange("maxEnergy>0.");
+  energyCmd.SetStates(G4State_PreInit, G4State_Idle);
+  energyCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cNeutronCapture::~B4cNeutronCapture()
+{ 
+  delete fgStatistics;
+  fgStatistics = nullptr;
+  delete fgRecords;
+  fgRecords = nullptr;
+  delete fgEventRecords;
+  fgEventRecords = nullptr;
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCapture::SetEnabled()
+{
+  if ( fEnabled ) return;
+
+  auto physicsList = dynamic_cast<G4VModularPhysicsList*>(
+                       const_cast<G4VUserPhysicsList*>(
+                         G4RunManager::GetRunManager()->GetUserPhysicsList()));
+  if ( ! physicsList ) {
+    G4ExceptionDescription msg;
+    msg << "A modular physics list must be set before enabling "
+        << "the neutron capture parametrization.";
+    G4Exception("B4cNeutronCapture::SetEnabled()",
+      "MyCode0016", JustWarning, msg);
+    return;
+  }
+
+  auto fastSimulationPhysics = new G4FastSimulationPhysics();
+  fastSimulationPhysics->ActivateFastSimulation("neutron");
+  physicsList->RegisterPhysics(fastSimulationPhysics);
+  fEnabled = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCapture::SetMode(const G4String& mode)
+{
+  if ( mode != "full" && ! fEnabled ) {
+    G4ExceptionDescription msg;
+    msg << "The neutron capture parametrization must be enabled "
+        << "before the initialization, mode " << mode << " ignored.";
+    G4Exception("B4cNeutronCapture::SetMode()",
+      "MyCode0016", JustWarning, msg);
+    return;
+  }
+  fMode = mode;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t B4cNeutronCapture::GetBin(G4double energy)
+{
+  if ( energy <= 0. ) return 0;
+  auto bin 
+    = std::floor(( std::log10(energy/MeV) - kMinLogEnergy ) 
+                 * kNofBinsPerDecade);
+  return std::size_t(std::clamp(bin, 0., G4double(kNofBins - 1)));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCapture::Statistics::Add(const Record& record)
+{
+  fNofNeutrons += 1.;
+  fDeposit += record.fDeposit;
+  if ( ! record.fCaptured ) return;
+
+  fNofCaptures += 1.;
+  fTime += record.fTime;
+  fDisplacement += std::hypot(record.fLongitudinal, record.fTransverse);
+  for ( auto gamma : record.fGammas ) fGammaEnergy += gamma;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCapture::Statistics::Print(const G4String& label) const
+{
+  auto nofNeutrons = std::max(fNofNeutrons.GetValue(), 1.);
+  auto nofCaptures = std::max(fNofCaptures.GetValue(), 1.);
+  G4cout << "### Neutron capture [" << label << "]: " 
+         << fNofNeutrons.GetValue() << " neutrons, " 
+         << 100. * fNofCaptures.GetValue() / nofNeutrons
+         << " % captured, mean deposit " 
+         << G4BestUnit(fDeposit.GetValue()/nofNeutrons, "Energy")
+         << ", time " 
+         << G4BestUnit(fTime.GetValue()/nofCaptures, "Time") 
+         << ", displacement " 
+         << G4BestUnit(fDisplacement.GetValue()/nofCaptures, "Length") 
+         << ", gamma energy " 
+         << G4BestUnit(fGammaEnergy.GetValue()/nofCaptures, "Energy") 
+         << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCapture::BeginOfRun(G4bool isMaster)
+{
+  if ( ! fEnabled ) return;
+
+  // Master reads the table before the workers start the run
+  if ( isMaster ) {
+    fRegion = G4RegionStore::GetInstance()->GetRegion(kRegionName, false);
+    fMergedRecords.Reset();
+    if ( IsFast() ) ReadTable();
+
+    // Without the capture process, no neutron would be recorded as
+    // captured
+    auto processManager = G4Neutron::Definition()->GetProcessManager();
+    if ( IsRecording() && 
+         ! ( processManager && processManager->GetProcess("nCapture") ) ) {
+      G4ExceptionDescription msg;
+      msg << "The physics list has no neutron capture process (nCapture), "
+          << "the neutrons cannot be recorded." << G4endl
+          << "Use a hadronic physics list, e.g. -p FTFP_BERT_HP; the run "
+          << "is aborted.";
+      G4Exception("B4cNeutronCapture::BeginOfRun()",
+        "MyCode0016", RunMustBeAborted, msg);
+    }
+  }
+
+  // The statistics are reset by the run action
+  if ( ! fgRecords ) fgRecords = new std::vector<Record>();
+  fgRecords->clear();
+  if ( ! fgEventRecords ) fgEventRecords = new EventRecords();
+  *fgEventRecords = EventRecords();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCapture::EndOfRun(G4bool isMaster)
+{
+  if ( ! fEnabled || ! fgRecords || fMode == "full" ) return;
+
+  // Add the records of this thread
+  fMergedRecords.Append(*fgRecords);
+  fgRecords->clear();
+
+  if ( ! isMaster ) return;
+
+  if ( IsRecording() ) {
+    fgStatistics->Print("full tracking");
+    if ( IsCalibrating() ) WriteTable();
+  }
+  else {
+    fgStatistics->Print("fast");
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCapture::RegisterAccumulables()
+{
+  if ( fgStatistics ) return;
+
+  fgStatistics = new Statistics();
+  auto accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->RegisterAccumulable(fgStatistics->fNofNeutrons);
+  accumulableManager->RegisterAccumulable(fgStatistics->fNofCaptures);
+  accumulableManager->RegisterAccumulable(fgStatistics->fDeposit);
+  accumulableManager->RegisterAccumulable(fgStatistics->fTime);
+  accumulableManager->RegisterAccumulable(fgStatistics->fDisplacement);
+  accumulableManager->RegisterAccumulable(fgStatistics->fGammaEnergy);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCapture::Calibrate(const G4Step* step)
+{
+  if ( ! fgEventRecords ) return;
+  auto& event = *fgEventRecords;
+  auto track = step->GetTrack();
+  auto trackID = track->GetTrackID();
+  auto isNeutron = track->GetDefinition() == G4Neutron::Definition();
+  auto volume = step->GetPreStepPoint()->GetPhysicalVolume();
+
+  // At its first step, a neutron created in the target region starts a
+  // record; the other descendants of a recorded neutron, except the 
+  // capture gammas (emitted by the model), add their deposits to it
+  if ( track->GetCurrentStepNumber() == 1 ) {
+    if ( isNeutron ) {
+      auto vertexVolume = track->GetLogicalVolumeAtVertex();
+      if ( vertexVolume && vertexVolume->GetRegion() == fRegion ) {
+        Record record;
+        record.fEnergy = track->GetVertexKineticEnergy();
+        event.fAncestors[trackID] = event.fRecords.size();
+        event.fRecords.push_back(record);
+        event.fVolumes.push_back(volume);
+      }
+    }
+    else {
+      auto parent = event.fAncestors.find(track->GetParentID());
+      auto creator = track->GetCreatorProcess();
+      auto isCaptureGamma 
+        = track->GetDefinition() == G4Gamma::Definition() &&
+          creator && creator->GetProcessName() == "nCapture";
+      if ( parent != event.fAncestors.end() && ! isCaptureGamma ) {
+        event.fAncestors[trackID] = parent->second;
+      }
+    }
+  }
+
+  auto ancestor = event.fAncestors.find(trackID);
+  if ( ancestor == event.fAncestors.end() ) return;
+  auto& record = event.fRecords[ancestor->second];
+
+  // the deposit which stays in the panel of the vertex
+  if ( volume == event.fVolumes[ancestor->second] ) {
+    record.fDeposit += step->GetTotalEnergyDeposit();
+  }
+
+  // the fate of the neutron, at its last step, from its vertex
+  if ( ! isNeutron || track->GetTrackStatus() == fAlive ) return;
+  auto process = step->GetPostStepPoint()->GetProcessDefinedStep();
+  if ( process && process->GetProcessName() == "nCapture" ) {
+    record.fCaptured = true;
+    record.fTime = track->GetLocalTime();
+    auto displacement = track->GetPosition() - track->GetVertexPosition();
+    auto direction = track->GetVertexMomentumDirection();
+    record.fLongitudinal = displacement.dot(direction);
+    record.fTransverse 
+      = ( displacement - record.fLongitudinal * direction ).mag();
+    for ( auto secondary : *step->GetSecondaryInCurrentStep() ) {
+      if ( secondary->GetDefinition() == G4Gamma::Definition() ) {
+        record.fGammas.push_back(secondary->GetKineticEnergy());
+      }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCapture::EndOfEvent(G4bool aborted)
+{
+  if ( ! fgEventRecords ) return;
+
+  // the records of an aborted event are incomplete
+  if ( ! aborted ) {
+    for ( const auto& record : fgEventRecords->fRecords ) {
+      fgStatistics->Add(record);
+      fgRecords->push_back(record);
+    }
+  }
+  *fgEventRecords = EventRecords();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const B4cNeutronCapture::Record* B4cNeutronCapture::Sample(
+                                   G4double energy) const
+{
+  if ( fTable.empty() ) return nullptr;
+
+  // the records of the energy bin, or of the closest filled bin
+  auto bin = G4int(GetBin(energy));
+  for ( G4int distance=0; distance<G4int(kNofBins); ++distance ) {
+    for ( auto index : { bin - distance, bin + distance } ) {
+      if ( index < 0 || index >= G4int(kNofBins) ) continue;
+      const auto& records = fTable[index];
+      if ( records.empty() ) continue;
+      auto entry 
+        = std::min(std::size_t(G4UniformRand() * records.size()), 
+                   records.size() - 1);
+      return &records[entry];
+    }
+  }
+  return nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCapture::Count(const Record& record)
+{
+  if ( fgStatistics ) fgStatistics->Add(record);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCapture::WriteTable() const
+{
+  std::ofstream file(fTableFile.c_str());
+  if ( ! file ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fTableFile << ".";
+    G4Exception("B4cNeutronCapture::WriteTable()",
+      "MyCode0016", JustWarning, msg);
+    return;
+  }
+
+  file << "# energy(MeV) captured deposit(MeV) time(ns) longitudinal(mm)"
+       << " transverse(mm) nofGammas gammaEnergies(MeV)\n";
+  file.precision(8);
+  const auto& records = fMergedRecords.Get();
+  for ( const auto& record : records ) {
+    file << record.fEnergy/MeV << " " << record.fCaptured << " "
+         << record.fDeposit/MeV << " " << record.fTime/ns << " " 
+         << record.fLongitudinal/mm << " " << record.fTransverse/mm << " " 
+         << record.fGammas.size();
+    for ( auto gamma : record.fGammas ) file << " " << gamma/MeV;
+    file << "\n";
+  }
+
+  G4cout << "### Neutron capture table: " << records.size() 
+         << " neutrons written in " << fTableFile << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCapture::ReadTable()
+{
+  fTable.assign(kNofBins, std::vector<Record>());
+
+  std::ifstream file(fTableFile.c_str());
+  if ( ! file ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fTableFile << ", run in calibrate mode first;"
+        << " the neutrons are fully tracked.";
+    G4Exception("B4cNeutronCapture::ReadTable()",
+      "MyCode0016", JustWarning, msg);
+    fTable.clear();
+    return;
+  }
+
+  std::string line;
+  std::size_t nofRecords = 0;
+  while ( std::getline(file, line) ) {
+    if ( line.empty() || line[0] == '#' ) continue;
+    std::istringstream input(line);
+    Record record;
+    std::size_t nofGammas = 0;
+    input >> record.fEnergy >> record.fCaptured >> record.fDeposit 
+          >> record.fTime 
+          >> record.fLongitudinal >> record.fTransverse >> nofGammas;
+    for ( std::size_t i=0; i<nofGammas; ++i ) {
+      G4double gamma = 0.;
+      input >> gamma;
+      record.fGammas.push_back(gamma*MeV);
+    }
+    if ( ! input ) {
+      G4ExceptionDescription msg;
+      msg << "Wrong line \"" << line << "\" in " << fTableFile << ".";
+      G4Exception("B4cNeutronCapture::ReadTable()",
+        "MyCode0016", JustWarning, msg);
+      continue;
+    }
+    record.fEnergy *= MeV;
+    record.fDeposit *= MeV;
+    record.fTime *= ns;
+    record.fLongitudinal *= mm;
+    record.fTransverse *= mm;
+
+    fTable[GetBin(record.fEnergy)].push_back(record);
+    ++nofRecords;
+  }
+  if ( nofRecords == 0 ) fTable.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
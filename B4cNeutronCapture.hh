@@ -0,0 +1,206 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cNeutronCapture.hh
+/// \brief Definition of the B4cNeutronCapture class
+
+#ifndef B4cNeutronCapture_h
+#define B4cNeutronCapture_h 1
+
+#include "B4MergedVector.hh"
+#include "globals.hh"
+#include "G4Accumulable.hh"
+
+#include <unordered_map>
+#include <vector>
+
+class G4Step;
+class G4Region;
+class G4VPhysicalVolume;
+class G4GenericMessenger;
+
+/// Parametrized thermalization and capture of the neutrons in the 
+/// target region (the panels).
+///
+/// In calibrate mode, the neutrons created in the target region are 
+/// tracked with the full neutron physics and the stepping action 
+/// records for each one its initial kinetic energy and its fate: the 
+/// energy deposited in the panel of its vertex by the neutron and its 
+/// descendants (the recoils), except the capture gammas; the capture 
+/// time, the displacement of the capture point from the production 
+/// vertex (along and transverse to the initial direction) and the 
+/// energies of the capture gammas, or no capture if it escapes or ends 
+/// otherwise. The records are completed at the end of each event, as 
+/// the descendants are tracked after the neutron. Master writes the 
+/// records of all threads in a table file at the end of run. The full
+/// tracking modes need a physics list with the neutron capture process
+/// ("nCapture"), preferably with the high precision neutron models 
+/// (_HP lists); the runs without it are aborted.
+///
+/// In fast mode, the table is read by master at the start of run and 
+/// B4cNeutronCaptureModel replaces the tracking of the neutrons created
+/// in the target region, at their vertex: a record of the same initial
+/// energy (in bins of 1/5 decade) is drawn, the neutron is killed with 
+/// the deposit of the record and, for a capture, the gammas are emitted
+/// isotropically at the position displaced from the vertex after the 
+/// capture time. The neutrons entering the region from outside are 
+/// fully tracked, as they are not calibrated.
+///
+/// The same summary line (captured fraction, mean deposit, time, 
+/// displacement and gamma energy) is printed by master at the end of 
+/// run in all modes. The model is validated against a run in validate 
+/// mode, the full tracking recorded as in calibrate mode but without 
+/// writing the table, with a run seed independent of the calibration 
+/// run (see neutron.mac).
+///
+/// Both modes need the parametrization to be enabled before the 
+/// initialization, which defines the target region and registers the 
+/// fast simulation physics for the neutrons, so that it costs nothing 
+/// when it is not used; the neutrons are fully tracked in full mode.
+/// The following commands are defined (on master only):
+/// - /B4/neutron/setEnabled             (PreInit)
+/// - /B4/neutron/setMode full|calibrate|validate|fast
+/// - /B4/neutron/setTableFile fileName
+/// - /B4/neutron/setMaxEnergy value unit
+
+class B4cNeutronCapture
+{
+  public:
+    // Fate of a neutron
+    struct Record {
+      G4double fEnergy = 0.;        ///< initial kinetic energy
+      G4bool   fCaptured = false;
+      G4double fDeposit = 0.;       ///< in the panel of the vertex
+      G4double fTime = 0.;          ///< capture time after creation
+      G4double fLongitudinal = 0.;  ///< displacement along the direction
+      G4double fTransverse = 0.;    ///< and transverse to it
+      std::vector<G4double> fGammas;
+    };
+
+    static constexpr const char* kRegionName = "Target";
+
+    static B4cNeutronCapture* Instance();
+    ~B4cNeutronCapture();
+
+    // Called from the run action
+    void BeginOfRun(G4bool isMaster);
+    void EndOfRun(G4bool isMaster);
+
+    // Called from the run action constructor on each thread
+    void RegisterAccumulables();
+
+    // Called from the stepping and event actions in calibrate and 
+    // validate modes
+    void Calibrate(const G4Step* step);
+    void EndOfEvent(G4bool aborted);
+
+    // Called from the model in fast mode
+    const Record* Sample(G4double energy) const;
+    void Count(const Record& record);
+
+    // set/get methods
+    void   SetEnabled();
+    G4bool GetEnabled() const;
+    void   SetMode(const G4String& mode);
+    G4bool IsCalibrating() const;
+    G4bool IsRecording() const;
+    G4bool IsFast() const;
+    G4bool HasTable() const;
+    G4double GetMaxEnergy() const;
+
+  private:
+    B4cNeutronCapture();
+
+    // Sums over the neutrons of this thread
+    struct Statistics {
+      G4Accumulable<G4double> fNofNeutrons { "NeutronNeutrons", 0. };
+      G4Accumulable<G4double> fNofCaptures { "NeutronCaptures", 0. };
+      G4Accumulable<G4double> fDeposit { "NeutronDeposit", 0. };
+      G4Accumulable<G4double> fTime { "NeutronTime", 0. };
+      G4Accumulable<G4double> fDisplacement { "NeutronDisplacement", 0. };
+      G4Accumulable<G4double> fGammaEnergy { "NeutronGammaEnergy", 0. };
+
+      void Add(const Record& record);
+      void Print(const G4String& label) const;
+    };
+
+    // Neutrons of the current event being recorded
+    struct EventRecords {
+      std::vector<Record> fRecords;
+      std::vector<const G4VPhysicalVolume*> fVolumes; ///< of the vertices
+      std::unordered_map<G4int, std::size_t> fAncestors; ///< per track ID
+    };
+
+    static std::size_t GetBin(G4double energy);
+    void ReadTable();
+    void WriteTable() const;
+
+    static B4cNeutronCapture* fgInstance;
+    static G4ThreadLocal Statistics* fgStatistics;
+    static G4ThreadLocal std::vector<Record>* fgRecords;
+    static G4ThreadLocal EventRecords* fgEventRecords;
+
+    G4GenericMessenger* fMessenger;
+    G4bool   fEnabled;
+    G4String fMode;
+    G4String fTableFile;
+    G4double fMaxEnergy;
+    const G4Region* fRegion;
+
+    // table, by energy bin
+    std::vector<std::vector<Record>> fTable;
+
+    // merged over the threads
+    B4MergedVector<Record> fMergedRecords;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline G4bool B4cNeutronCapture::GetEnabled() const {
+  return fEnabled;
+}
+
+inline G4bool B4cNeutronCapture::IsCalibrating() const {
+  return fEnabled && fMode == "calibrate";
+}
+
+inline G4bool B4cNeutronCapture::IsRecording() const {
+  return fEnabled && ( fMode == "calibrate" || fMode == "validate" );
+}
+
+inline G4bool B4cNeutronCapture::IsFast() const {
+  return fEnabled && fMode == "fast";
+}
+
+inline G4bool B4cNeutronCapture::HasTable() const {
+  return ! fTable.empty();
+}
+
+inline G4double B4cNeutronCapture::GetMaxEnergy() const {
+  return fMaxEnergy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
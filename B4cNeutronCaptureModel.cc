@@ -0,0 +1,113 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cNeutronCaptureModel.cc
+/// \brief Implementation of the B4cNeutronCaptureModel class
+
+#include "B4cNeutronCaptureModel.hh"
+#include "B4cNeutronCapture.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Track.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Neutron.hh"
+#include "G4Gamma.hh"
+#include "G4RandomDirection.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cNeutronCaptureModel::B4cNeutronCaptureModel(const G4String& name, 
+                                               G4Region* region)
+ : G4VFastSimulationModel(name, region)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cNeutronCaptureModel::~B4cNeutronCaptureModel()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4cNeutronCaptureModel::IsApplicable(
+                                 const G4ParticleDefinition& particle)
+{
+  return &particle == G4Neutron::Definition();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4cNeutronCaptureModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+  // at the first step in the envelope of a neutron created in it
+  auto neutronCapture = B4cNeutronCapture::Instance();
+  auto track = fastTrack.GetPrimaryTrack();
+  return neutronCapture->IsFast() && neutronCapture->HasTable() &&
+         track->GetCurrentStepNumber() == 1 &&
+         track->GetKineticEnergy() < neutronCapture->GetMaxEnergy();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cNeutronCaptureModel::DoIt(const G4FastTrack& fastTrack, 
+                                  G4FastStep& fastStep)
+{
+  auto neutronCapture = B4cNeutronCapture::Instance();
+  auto track = fastTrack.GetPrimaryTrack();
+  auto energy = track->GetKineticEnergy();
+
+  // The neutron is replaced by the fate of a calibrated neutron, 
+  // with the energy deposited in its panel by the recoils during 
+  // moderation (it is tracked if no record is found)
+  auto record = neutronCapture->Sample(energy);
+  if ( ! record ) return;
+  fastStep.KillPrimaryTrack();
+  fastStep.ProposeTotalEnergyDeposited(record->fDeposit);
+  neutronCapture->Count(*record);
+  if ( ! record->fCaptured ) return;
+
+  // Capture point, displaced along and around the neutron direction 
+  // from the production vertex, as in the calibration
+  auto direction = track->GetVertexMomentumDirection();
+  auto phi = twopi * G4UniformRand();
+  auto u = direction.orthogonal().unit();
+  auto v = direction.cross(u);
+  auto position 
+    = track->GetVertexPosition() + record->fLongitudinal * direction
+      + record->fTransverse * ( std::cos(phi) * u + std::sin(phi) * v );
+  auto time = track->GetGlobalTime() + record->fTime;
+
+  fastStep.SetNumberOfSecondaryTracks(G4int(record->fGammas.size()));
+  for ( auto gammaEnergy : record->fGammas ) {
+    G4DynamicParticle gamma(G4Gamma::Definition(), G4RandomDirection(), 
+                            gammaEnergy);
+    fastStep.CreateSecondaryTrack(gamma, position, time, false);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
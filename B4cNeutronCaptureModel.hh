@@ -0,0 +1,61 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cNeutronCaptureModel.hh
+/// \brief Definition of the B4cNeutronCaptureModel class
+
+#ifndef B4cNeutronCaptureModel_h
+#define B4cNeutronCaptureModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+
+class G4Region;
+
+/// Fast simulation model of the thermalization and the capture of the 
+/// neutrons in the target region, from the table calibrated with the 
+/// full neutron physics (see B4cNeutronCapture).
+///
+/// It is triggered, in fast mode only, for the neutrons created in the
+/// target region below the maximum energy of the parametrization, at 
+/// their first step, so that the displacement of the calibrated capture
+/// point is applied from the production vertex as it was measured; the 
+/// neutrons entering the region are fully tracked. The neutron is killed
+/// with the energy deposit of the drawn record, and its capture gammas 
+/// are emitted isotropically at the capture point and time.
+
+class B4cNeutronCaptureModel : public G4VFastSimulationModel
+{
+  public:
+    B4cNeutronCaptureModel(const G4String& name, G4Region* region);
+    virtual ~B4cNeutronCaptureModel();
+
+    // methods from base class
+    virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+    virtual G4bool ModelTrigger(const G4FastTrack& fastTrack);
+    virtual void   DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
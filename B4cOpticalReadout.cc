@@ -0,0 +1,547 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cOpticalReadout.cc
+/// \brief Implementation of the B4cOpticalReadout class
+
+#include "B4cOpticalReadout.hh"
+
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4Material.hh"
+#include "G4MaterialPropertiesTable.hh"
+#include "G4ProcessTable.hh"
+#include "G4RunManager.hh"
+#include "G4VModularPhysicsList.hh"
+#include "G4OpticalPhysics.hh"
+#include "G4GenericMessenger.hh"
+#include "G4AccumulableManager.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Poisson.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace {
+  // Peak of the liquid argon scintillation spectrum (128 nm)
+  const G4double kPhotonEnergy = 9.69*eV;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cOpticalReadout* B4cOpticalReadout::fgInstance = nullptr;
+G4ThreadLocal B4cOpticalReadout::ThreadData* 
+  B4cOpticalReadout::fgData = nullptr;
+G4ThreadLocal B4cOpticalReadout::Counters* 
+  B4cOpticalReadout::fgCounters = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cOpticalReadout* B4cOpticalReadout::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4cOpticalReadout();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cOpticalReadout::B4cOpticalReadout()
+ : fMessenger(nullptr),
+   fPhysics(false),
+   fMode("off"),
+   fMapFile("optical_map.txt"),
+   fNofBins(10),
+   fPhotonsPerEvent(10000),
+   fEfficiency(0.25),
+   fActive(false),
+   fGapPV(nullptr),
+   fHalfSize(0.),
+   fYield(0.),
+   fMap(),
+   fEmitted(),
+   fDetected()
+{
+  // The readout is shared by all threads:
+  // the commands are executed on master only
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/optical/", 
+                             "Optical readout of the liquid argon gap");
+
+  auto& physicsCmd 
+    = fMessenger->DeclareMethod("setPhysics", &B4cOpticalReadout::SetPhysics,
+                                "Register the optical physics.");
+  physicsCmd.SetStates(G4State_PreInit);
+  physicsCmd.command->SetToBeBroadcasted(false);
+
+  auto& modeCmd 
+    = fMessenger->DeclareMethod("setMode", &B4cOpticalReadout::SetMode,
+                                "Switch the readout off, track the optical "
+                                "photons, build the map or use it.");
+  modeCmd.SetParameterName("mode", false);
+  modeCmd.SetCandidates("off full build lookup");
+  modeCmd.SetStates(G4State_PreInit, G4State_Idle);
+  modeCmd.command->SetToBeBroadcasted(false);
+
+  auto& mapCmd 
+    = fMessenger->DeclareProperty("setMapFile", fMapFile,
+                                  "Set the file of the detection "
+                                  "probability map.");
+  mapCmd.SetParameterName("fileName", false);
+  mapCmd.SetStates(G4State_PreInit, G4State_Idle);
+  mapCmd.command->SetToBeBroadcasted(false);
+
+  auto& binsCmd 
+    = fMessenger->DeclareProperty("setBins", fNofBins,
+                                  "Set the number of voxels of the map "
+                                  "along each axis.");
+  binsCmd.SetParameterName("nofBins", false);
+  binsCmd.SetRange("nofBins>0");
+  binsCmd.SetStates(G4State_PreInit, G4State_Idle);
+  binsCmd.command->SetToBeBroadcasted(false);
+
+  auto& photonsCmd 
+    = fMessenger->DeclareProperty("setPhotonsPerEvent", fPhotonsPerEvent,
+                                  "Set the number of photons emitted per "
+                                  "event when building the map.");
+  photonsCmd.SetParameterName("nofPhotons", false);
+  photonsCmd.SetRange("nofPhotons>0");
+  photonsCmd.SetStates(G4State_PreInit, G4State_Idle);
+  photonsCmd.command->SetToBeBroadcasted(false);
+
+  auto& efficiencyCmd 
+    = fMessenger->DeclareProperty("setDetectionEfficiency", fEfficiency,
+                                  "Set the probability to detect a photon "
+                                  "reaching a panel.");
+  efficiencyCmd.SetParameterName("efficiency", false);
+  efficiencyCmd.SetRange("efficiency>=0. && efficiency<=1.");
+  efficiencyCmd.SetStates(G4State_PreInit, G4State_Idle);
+  efficiencyCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cOpticalReadout::~B4cOpticalReadout()
+{ 
+  delete fgData;
+  fgData = nullptr;
+  delete fgCounters;
+  fgCounters = nullptr;
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cOpticalReadout::SetPhysics()
+{
+  if ( fPhysics ) return;
+
+  auto physicsList = dynamic_cast<G4VModularPhysicsList*>(
+                       const_cast<G4VUserPhysicsList*>(
+                         G4RunManager::GetRunManager()->GetUserPhysicsList()));
+  if ( ! physicsList ) {
+    G4ExceptionDescription msg;
+    msg << "A modular physics list must be set before registering "
+        << "the optical physics.";
+    G4Exception("B4cOpticalReadout::SetPhysics()",
+      "MyCode0017", JustWarning, msg);
+    return;
+  }
+
+  physicsList->RegisterPhysics(new G4OpticalPhysics());
+  fPhysics = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cOpticalReadout::SetMode(const G4String& mode)
+{
+  if ( ( mode == "full" || mode == "build" ) && ! fPhysics ) {
+    G4ExceptionDescription msg;
+    msg << "The optical physics must be registered "
+        << "before the initialization, mode " << mode << " ignored.";
+    G4Exception("B4cOpticalReadout::SetMode()",
+      "MyCode0017", JustWarning, msg);
+    return;
+  }
+  fMode = mode;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int B4cOpticalReadout::GetVoxel(const G4ThreeVector& position) const
+{
+  // the gap is centred at the origin
+  G4int index[3];
+  for ( G4int axis=0; axis<3; ++axis ) {
+    auto bin 
+      = std::floor(( position[axis] + fHalfSize ) / ( 2.*fHalfSize ) 
+                   * fNofBins);
+    index[axis] = G4int(std::clamp(bin, 0., G4double(fNofBins - 1)));
+  }
+  return index[0] + fNofBins * ( index[1] + fNofBins * index[2] );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cOpticalReadout::Print(const G4String& label) const
+{
+  auto nofEvents = fgCounters->fNofEvents.GetValue();
+  G4cout << "### Optical [" << label << "]: " 
+         << nofEvents << " events, mean PE per channel:";
+  for ( const auto& sum : fgCounters->fSums ) {
+    G4cout << " " << sum.GetValue() / std::max(nofEvents, 1.);
+  }
+  G4cout << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cOpticalReadout::RegisterAccumulables()
+{
+  if ( fgCounters ) return;
+
+  fgCounters = new Counters();
+  auto accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->RegisterAccumulable(fgCounters->fNofEvents);
+
+  // the vector is not resized after the registration
+  fgCounters->fSums.reserve(kNofChannels);
+  for ( std::size_t i=0; i<kNofChannels; ++i ) {
+    fgCounters->fSums.emplace_back("OpticalPE" + std::to_string(i), 0.);
+    accumulableManager->RegisterAccumulable(fgCounters->fSums.back());
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cOpticalReadout::BeginOfRun(G4bool isMaster)
+{
+  // Master checks the gap and reads the map before the workers start 
+  // the run
+  if ( isMaster ) {
+    fActive = false;
+    fEmitted.Reset();
+    fDetected.Reset();
+    if ( fMode != "off" ) {
+      fGapPV = G4PhysicalVolumeStore::GetInstance()->GetVolume("Gap", false);
+      auto gapBox 
+        = fGapPV ? dynamic_cast<const G4Box*>(
+                     fGapPV->GetLogicalVolume()->GetSolid()) : nullptr;
+      auto properties 
+        = fGapPV ? fGapPV->GetLogicalVolume()->GetMaterial()
+                     ->GetMaterialPropertiesTable() : nullptr;
+      if ( ! gapBox || ! properties || 
+           ! properties->ConstPropertyExists("SCINTILLATIONYIELD") ) {
+        G4ExceptionDescription msg;
+        msg << "No scintillating gap, use /B4/det/setLArGap;"
+            << " the optical readout is off.";
+        G4Exception("B4cOpticalReadout::BeginOfRun()",
+          "MyCode0017", JustWarning, msg);
+      }
+      else {
+        fHalfSize = gapBox->GetXHalfLength();
+        fYield = properties->GetConstProperty("SCINTILLATIONYIELD");
+        fActive = ( fMode != "lookup" || ReadMap() );
+      }
+    }
+  }
+
+  // No optical photon is generated in lookup mode
+  if ( fPhysics ) {
+    auto processTable = G4ProcessTable::GetProcessTable();
+    auto generate = ! ( fActive && fMode == "lookup" );
+    processTable->SetProcessActivation("Scintillation", generate);
+    processTable->SetProcessActivation("Cerenkov", generate);
+  }
+
+  if ( ! fActive ) return;
+
+  if ( ! fgData ) fgData = new ThreadData();
+  *fgData = ThreadData();
+  if ( fMode == "build" ) {
+    auto nofVoxels = std::size_t(fNofBins) * fNofBins * fNofBins;
+    fgData->fEmitted.assign(nofVoxels, 0.);
+    fgData->fDetected.assign(nofVoxels * kNofChannels, 0.);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cOpticalReadout::EndOfRun(G4bool isMaster)
+{
+  if ( ! fActive || ! fgData ) return;
+
+  // Add the map of this thread
+  if ( fMode == "build" ) {
+    fEmitted.Add(fgData->fEmitted);
+    fDetected.Add(fgData->fDetected);
+  }
+  *fgData = ThreadData();
+
+  if ( ! isMaster ) return;
+
+  if ( fMode == "build" ) {
+    WriteMap();
+  }
+  else {
+    Print(fMode == "full" ? "full tracking" : "lookup");
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cOpticalReadout::BeginOfEvent()
+{
+  if ( ! fActive || ! fgData ) return;
+
+  // the voxel of the event is set by the generator, called before
+  fgData->fPhotoelectrons.fill(0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const B4cOpticalReadout::Photoelectrons* B4cOpticalReadout::EndOfEvent()
+{
+  if ( ! fActive || ! fgData ) return nullptr;
+
+  const auto& photoelectrons = fgData->fPhotoelectrons;
+  if ( fMode == "build" ) {
+    auto voxel = fgData->fVoxel;
+    fgData->fVoxel = -1;
+    if ( voxel < 0 ) return nullptr;
+    fgData->fEmitted[voxel] += fPhotonsPerEvent;
+    for ( std::size_t i=0; i<kNofChannels; ++i ) {
+      fgData->fDetected[voxel * kNofChannels + i] += photoelectrons[i];
+    }
+    return nullptr;
+  }
+
+  fgCounters->fNofEvents += 1.;
+  for ( std::size_t i=0; i<kNofChannels; ++i ) {
+    fgCounters->fSums[i] += G4double(photoelectrons[i]);
+  }
+  return &photoelectrons;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cOpticalReadout::GeneratePrimaries(G4Event* event)
+{
+  if ( ! IsBuilding() || ! fgData ) return;
+
+  // the voxels are visited in turn, the photons are emitted from a 
+  // random point of the voxel
+  auto voxel = event->GetEventID() % ( fNofBins * fNofBins * fNofBins );
+  G4int index[3] 
+    = { voxel % fNofBins, ( voxel / fNofBins ) % fNofBins, 
+        voxel / ( fNofBins * fNofBins ) };
+  auto width = 2. * fHalfSize / fNofBins;
+  G4ThreeVector position;
+  for ( G4int axis=0; axis<3; ++axis ) {
+    position[axis] = - fHalfSize + ( index[axis] + G4UniformRand() ) * width;
+  }
+
+  // isotropic photons, randomly polarized
+  auto vertex = new G4PrimaryVertex(position, 0.);
+  for ( G4int i=0; i<fPhotonsPerEvent; ++i ) {
+    auto cosTheta = 1. - 2.*G4UniformRand();
+    auto sinTheta = std::sqrt(1. - cosTheta*cosTheta);
+    auto phi = twopi*G4UniformRand();
+    G4ThreeVector direction(sinTheta*std::cos(phi), sinTheta*std::sin(phi),
+                            cosTheta);
+    auto polarization = direction.orthogonal().unit();
+    polarization.rotate(twopi*G4UniformRand(), direction);
+
+    auto photon = new G4PrimaryParticle(G4OpticalPhoton::Definition());
+    photon->SetKineticEnergy(kPhotonEnergy);
+    photon->SetMomentumDirection(direction);
+    photon->SetPolarization(polarization);
+    vertex->SetPrimary(photon);
+  }
+  event->AddPrimaryVertex(vertex);
+
+  fgData->fVoxel = voxel;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cOpticalReadout::Step(const G4Step* step)
+{
+  if ( ! fgData ) return;
+
+  auto track = step->GetTrack();
+  if ( track->GetDefinition() == G4OpticalPhoton::Definition() ) {
+    // the photons are not tracked in lookup mode
+    if ( fMode == "lookup" ) {
+      track->SetTrackStatus(fStopAndKill);
+      return;
+    }
+
+    // a photon entering a panel is absorbed, and detected in its channel
+    auto postStepPoint = step->GetPostStepPoint();
+    if ( postStepPoint->GetStepStatus() != fGeomBoundary ) return;
+    auto volume = postStepPoint->GetPhysicalVolume();
+    if ( ! volume || volume->GetName().compare(0, 4, "Abso") != 0 ) return;
+    track->SetTrackStatus(fStopAndKill);
+
+    auto channel = volume->GetCopyNo();
+    if ( channel < 0 || channel >= G4int(kNofChannels) ) return;
+    // the map holds the probability to reach the panel
+    if ( fMode == "build" || G4UniformRand() < fEfficiency ) {
+      ++fgData->fPhotoelectrons[channel];
+    }
+    return;
+  }
+
+  // lookup of the energy deposits in the gap
+  if ( fMode != "lookup" ) return;
+  auto edep = step->GetTotalEnergyDeposit();
+  if ( edep <= 0. || 
+       step->GetPreStepPoint()->GetPhysicalVolume() != fGapPV ) return;
+
+  auto position 
+    = 0.5 * ( step->GetPreStepPoint()->GetPosition() 
+              + step->GetPostStepPoint()->GetPosition() );
+  auto voxel = GetVoxel(position);
+  auto nofPhotons = edep * fYield * fEfficiency;
+  for ( std::size_t i=0; i<kNofChannels; ++i ) {
+    auto mean = nofPhotons * fMap[voxel * kNofChannels + i];
+    if ( mean > 0. ) fgData->fPhotoelectrons[i] += G4int(G4Poisson(mean));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cOpticalReadout::WriteMap() const
+{
+  std::ofstream file(fMapFile.c_str());
+  if ( ! file ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fMapFile << ".";
+    G4Exception("B4cOpticalReadout::WriteMap()",
+      "MyCode0017", JustWarning, msg);
+    return;
+  }
+
+  const auto& emitted = fEmitted.Get();
+  const auto& detected = fDetected.Get();
+  file << "# nofBins halfSize(mm) nofChannels\n"
+       << fNofBins << " " << fHalfSize/mm << " " << kNofChannels << "\n"
+       << "# voxel emitted probabilities\n";
+  file.precision(8);
+  G4double nofEmitted = 0.;
+  std::array<G4double, kNofChannels> nofDetected = {};
+  for ( std::size_t voxel=0; voxel<emitted.size(); ++voxel ) {
+    file << voxel << " " << emitted[voxel];
+    for ( std::size_t i=0; i<kNofChannels; ++i ) {
+      auto counts = detected[voxel * kNofChannels + i];
+      file << " " << ( emitted[voxel] > 0. ? counts / emitted[voxel] : 0. );
+      nofDetected[i] += counts;
+    }
+    file << "\n";
+    nofEmitted += emitted[voxel];
+  }
+
+  G4cout << "### Optical map: " << nofEmitted << " photons in " 
+         << emitted.size() << " voxels written in " << fMapFile 
+         << ", mean probability per channel:";
+  for ( auto counts : nofDetected ) {
+    G4cout << " " << counts / std::max(nofEmitted, 1.);
+  }
+  G4cout << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4cOpticalReadout::ReadMap()
+{
+  fMap.clear();
+
+  std::ifstream file(fMapFile.c_str());
+  if ( ! file ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fMapFile << ", run in build mode first;"
+        << " the optical readout is off.";
+    G4Exception("B4cOpticalReadout::ReadMap()",
+      "MyCode0017", JustWarning, msg);
+    return false;
+  }
+
+  // the binning is that of the map
+  std::string line;
+  G4int nofBins = 0;
+  G4double halfSize = 0.;
+  std::size_t nofChannels = 0;
+  while ( std::getline(file, line) ) {
+    if ( line.empty() || line[0] == '#' ) continue;
+    std::istringstream input(line);
+    input >> nofBins >> halfSize >> nofChannels;
+    break;
+  }
+  if ( nofBins <= 0 || nofChannels != kNofChannels ||
+       std::abs(halfSize*mm - fHalfSize) > 1.e-3*mm ) {
+    G4ExceptionDescription msg;
+    msg << fMapFile << " does not match the gap, rebuild it;"
+        << " the optical readout is off.";
+    G4Exception("B4cOpticalReadout::ReadMap()",
+      "MyCode0017", JustWarning, msg);
+    return false;
+  }
+
+  fNofBins = nofBins;
+  auto nofVoxels = std::size_t(nofBins) * nofBins * nofBins;
+  fMap.assign(nofVoxels * kNofChannels, 0.);
+  while ( std::getline(file, line) ) {
+    if ( line.empty() || line[0] == '#' ) continue;
+    std::istringstream input(line);
+    std::size_t voxel = 0;
+    G4double emitted = 0.;
+    input >> voxel >> emitted;
+    if ( voxel >= nofVoxels ) continue;
+    for ( std::size_t i=0; i<kNofChannels; ++i ) {
+      input >> fMap[voxel * kNofChannels + i];
+    }
+  }
+
+  G4cout << "### Optical map: " << nofVoxels << " voxels read from " 
+         << fMapFile << G4endl;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
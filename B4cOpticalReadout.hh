@@ -0,0 +1,183 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cOpticalReadout.hh
+/// \brief Definition of the B4cOpticalReadout class
+
+#ifndef B4cOpticalReadout_h
+#define B4cOpticalReadout_h 1
+
+#include "B4cEventRecord.hh"
+#include "B4MergedVector.hh"
+#include "globals.hh"
+#include "G4Accumulable.hh"
+#include "G4ThreeVector.hh"
+
+#include <array>
+#include <vector>
+
+class G4Event;
+class G4Step;
+class G4VPhysicalVolume;
+class G4GenericMessenger;
+
+/// Readout of the scintillation light of the liquid argon gap by the 
+/// panels, each panel being a readout channel.
+///
+/// In full mode, the optical photons are tracked and those reaching a 
+/// panel are detected with the detection efficiency.
+///
+/// In build mode, the primary generator emits at each event a fixed 
+/// number of photons from a random point of one voxel of the gap, the 
+/// voxels being visited in turn, and the photons reaching each panel are
+/// counted. Master writes at the end of run the detection probability 
+/// of each channel for each voxel in the map file.
+///
+/// In lookup mode, the map is read by master at the start of run and 
+/// no optical photon is generated: for each energy deposit in the gap, 
+/// the number of photoelectrons of each channel is drawn from a Poisson
+/// distribution whose mean is the number of scintillation photons 
+/// (the yield of the material, without quenching) times the detection 
+/// probability of the voxel and the detection efficiency. The Cerenkov 
+/// light, tracked in full mode, is ignored in lookup mode: with the 
+/// refractive index defined only around the 128 nm scintillation line,
+/// it is a small fraction of the light of the charged particles, which 
+/// the lookup underestimates accordingly.
+///
+/// The scintillation properties of the liquid argon (see 
+/// B4cDetectorConstruction) use the Geant4 11 property keys 
+/// (SCINTILLATIONCOMPONENT1/2, SCINTILLATIONYIELD1/2, 
+/// SCINTILLATIONTIMECONSTANT1/2), which are not recognized by the 
+/// scintillation process of earlier versions.
+///
+/// In full and lookup modes, the number of photoelectrons of each 
+/// channel is written per event in the optical ntuple, and the same 
+/// summary line is printed by master at the end of run, which validates
+/// the map against the full tracking.
+///
+/// The gap must be filled (/B4/det/setLArGap), and the full and build 
+/// modes need the optical physics, which is registered before the 
+/// initialization so that it costs nothing when it is not used; the
+/// scintillation and Cerenkov processes are inactivated in lookup mode.
+/// The following commands are defined (on master only):
+/// - /B4/optical/setPhysics             (PreInit)
+/// - /B4/optical/setMode off|full|build|lookup
+/// - /B4/optical/setMapFile fileName
+/// - /B4/optical/setBins nofBins       (per axis)
+/// - /B4/optical/setPhotonsPerEvent nofPhotons
+/// - /B4/optical/setDetectionEfficiency value
+
+class B4cOpticalReadout
+{
+  public:
+    static constexpr std::size_t kNofChannels = B4cEventRecord::kNofPanels;
+    using Photoelectrons = std::array<G4int, kNofChannels>;
+
+    static B4cOpticalReadout* Instance();
+    ~B4cOpticalReadout();
+
+    // Called from the run action
+    void BeginOfRun(G4bool isMaster);
+    void EndOfRun(G4bool isMaster);
+
+    // Called from the run action constructor on each thread
+    void RegisterAccumulables();
+
+    // Called from the event action; the photoelectrons of the event are 
+    // returned in full and lookup modes
+    void BeginOfEvent();
+    const Photoelectrons* EndOfEvent();
+
+    // Called from the primary generator action in build mode
+    void GeneratePrimaries(G4Event* event);
+
+    // Called from the stepping action
+    void Step(const G4Step* step);
+
+    // set/get methods
+    void   SetPhysics();
+    void   SetMode(const G4String& mode);
+    G4bool IsActive() const;
+    G4bool IsBuilding() const;
+
+  private:
+    B4cOpticalReadout();
+
+    // Data of each thread
+    struct ThreadData {
+      Photoelectrons fPhotoelectrons = {};  ///< of the current event
+      G4int fVoxel = -1;                    ///< of the current event
+      std::vector<G4double> fEmitted;       ///< per voxel
+      std::vector<G4double> fDetected;      ///< per voxel and channel
+    };
+
+    // Counters of each thread
+    struct Counters {
+      G4Accumulable<G4double> fNofEvents { "OpticalEvents", 0. };
+      std::vector<G4Accumulable<G4double>> fSums;  ///< per channel
+    };
+
+    G4int GetVoxel(const G4ThreeVector& position) const;
+    void Print(const G4String& label) const;
+    G4bool ReadMap();
+    void WriteMap() const;
+
+    static B4cOpticalReadout* fgInstance;
+    static G4ThreadLocal ThreadData* fgData;
+    static G4ThreadLocal Counters* fgCounters;
+
+    G4GenericMessenger* fMessenger;
+    G4bool   fPhysics;
+    G4String fMode;
+    G4String fMapFile;
+    G4int    fNofBins;
+    G4int    fPhotonsPerEvent;
+    G4double fEfficiency;
+
+    // set by master at the start of run
+    G4bool   fActive;
+    const G4VPhysicalVolume* fGapPV;
+    G4double fHalfSize;
+    G4double fYield;
+    std::vector<G4double> fMap;  ///< detection probability per voxel 
+                                 ///< and channel
+
+    // merged over the threads in build mode
+    B4MergedVector<G4double> fEmitted;
+    B4MergedVector<G4double> fDetected;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline G4bool B4cOpticalReadout::IsActive() const {
+  return fActive;
+}
+
+inline G4bool B4cOpticalReadout::IsBuilding() const {
+  return fActive && fMode == "build";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,308 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cScoringMesh.cc
+/// \brief Implementation of the B4cScoringMesh class
+
+#include "B4cScoringMesh.hh"
+#include "B4cScoringWorld.hh"
+
+#include "G4RunManager.hh"
+#include "G4VUserDetectorConstruction.hh"
+#include "G4VModularPhysicsList.hh"
+#include "G4ParallelWorldPhysics.hh"
+#include "G4TransportationManager.hh"
+#include "G4Navigator.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4GenericMessenger.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cScoringMesh* B4cScoringMesh::fgInstance = nullptr;
+G4ThreadLocal B4cScoringMesh::Map* B4cScoringMesh::fgMap = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cScoringMesh* B4cScoringMesh::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4cScoringMesh();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cScoringMesh::B4cScoringMesh()
+ : fMessenger(nullptr),
+   fEnabled(false),
+   fHalfSize(5.*cm, 5.*cm, 5.*cm),
+   fBins({ 50, 50, 50 }),
+   fEdep(),
+   fFluence(),
+   fMasses()
+{
+  // The mesh is part of the geometry, shared by all threads: 
+  // the commands are executed on master only, before the initialization
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/mesh/", "Dose and fluence mesh");
+
+  auto& enabledCmd 
+    = fMessenger->DeclareMethod("setEnabled", &B4cScoringMesh::SetEnabled,
+                                "Score the dose and the fluence on the mesh.");
+  enabledCmd.SetStates(G4State_PreInit);
+  enabledCmd.command->SetToBeBroadcasted(false);
+
+  auto& sizeCmd 
+    = fMessenger->DeclareMethodWithUnit("setHalfSize", "cm",
+                                        &B4cScoringMesh::SetHalfSize,
+                                        "Set the half-size of the mesh.");
+  sizeCmd.SetParameterName("x", "y", "z", false);
+  sizeCmd.SetStates(G4State_PreInit);
+  sizeCmd.command->SetToBeBroadcasted(false);
+
+  auto& binsCmd 
+    = fMessenger->DeclareMethod("setBins", &B4cScoringMesh::SetBins,
+                                "Set the number of voxels along x, y, z: "
+                                "nx ny nz.");
+  binsCmd.SetParameterName("bins", false);
+  binsCmd.SetStates(G4State_PreInit);
+  binsCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cScoringMesh::~B4cScoringMesh()
+{ 
+  delete fgMap;
+  fgMap = nullptr;
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cScoringMesh::SetEnabled()
+{
+  if ( fEnabled ) return;
+
+  auto runManager = G4RunManager::GetRunManager();
+  auto detector = const_cast<G4VUserDetectorConstruction*>(
+                    runManager->GetUserDetectorConstruction());
+  auto physicsList = dynamic_cast<G4VModularPhysicsList*>(
+                       const_cast<G4VUserPhysicsList*>(
+                         runManager->GetUserPhysicsList()));
+  if ( ! detector || ! physicsList ) {
+    G4ExceptionDescription msg;
+    msg << "The detector construction and a modular physics list "
+        << "must be set before enabling the mesh.";
+    G4Exception("B4cScoringMesh::SetEnabled()",
+      "MyCode0013", JustWarning, msg);
+    return;
+  }
+
+  detector->RegisterParallelWorld(
+    new B4cScoringWorld(B4cScoringWorld::kWorldName));
+  physicsList->RegisterPhysics(
+    new G4ParallelWorldPhysics(B4cScoringWorld::kWorldName));
+  fEnabled = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cScoringMesh::SetBins(const G4String& bins)
+{
+  std::istringstream input(bins);
+  std::array<G4int, 3> values;
+  if ( ! ( input >> values[0] >> values[1] >> values[2] ) ||
+       values[0] <= 0 || values[1] <= 0 || values[2] <= 0 ) {
+    G4ExceptionDescription msg;
+    msg << "Wrong mesh bins \"" << bins << "\", the bins are not changed.";
+    G4Exception("B4cScoringMesh::SetBins()",
+      "MyCode0013", JustWarning, msg);
+    return;
+  }
+  fBins = values;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t B4cScoringMesh::GetNofVoxels() const
+{
+  return std::size_t(fBins[0]) * fBins[1] * fBins[2];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cScoringMesh::ComputeMasses()
+{
+  fMasses.assign(GetNofVoxels(), 0.);
+
+  // The mesh is centred on the origin of the mass world, 
+  // which is closed at the start of run
+  auto worldPV = G4TransportationManager::GetTransportationManager()
+                   ->GetNavigatorForTracking()->GetWorldVolume();
+  if ( ! worldPV ) return;
+  G4Navigator navigator;
+  navigator.SetWorldVolume(worldPV);
+
+  G4double width[3] = { 2.*fHalfSize.x() / fBins[0], 
+                        2.*fHalfSize.y() / fBins[1], 
+                        2.*fHalfSize.z() / fBins[2] };
+  auto volume = GetVoxelVolume();
+  auto nofSamples = kNofMassSamples * kNofMassSamples * kNofMassSamples;
+  auto step = 1. / kNofMassSamples;
+  std::size_t index = 0;
+  for ( G4int ix=0; ix<fBins[0]; ++ix ) {
+    for ( G4int iy=0; iy<fBins[1]; ++iy ) {
+      for ( G4int iz=0; iz<fBins[2]; ++iz ) {
+        // the points are the centres of a regular grid of the voxel
+        G4double density = 0.;
+        for ( G4int i=0; i<nofSamples; ++i ) {
+          G4int sub[3] = { i % kNofMassSamples, 
+                           i / kNofMassSamples % kNofMassSamples,
+                           i / ( kNofMassSamples * kNofMassSamples ) };
+          G4ThreeVector point(
+            -fHalfSize.x() + ( ix + ( sub[0] + 0.5 ) * step ) * width[0],
+            -fHalfSize.y() + ( iy + ( sub[1] + 0.5 ) * step ) * width[1],
+            -fHalfSize.z() + ( iz + ( sub[2] + 0.5 ) * step ) * width[2]);
+          auto pv = navigator.LocateGlobalPointAndSetup(point);
+          auto material 
+            = pv ? pv->GetLogicalVolume()->GetMaterial() : nullptr;
+          if ( material ) density += material->GetDensity();
+        }
+        fMasses[index++] = density / nofSamples * volume;
+      }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cScoringMesh::BeginOfRun(G4bool isMaster)
+{
+  if ( ! fEnabled ) return;
+
+  // The map of master is cleared before the workers start the run,
+  // the voxel masses are computed again as the geometry may have changed
+  if ( isMaster ) {
+    fEdep.Reset(GetNofVoxels());
+    fFluence.Reset(GetNofVoxels());
+    ComputeMasses();
+  }
+
+  // The map of this thread, filled by B4cMeshSD
+  if ( ! fgMap ) fgMap = new Map();
+  fgMap->fEdep.assign(GetNofVoxels(), 0.);
+  fgMap->fFluence.assign(GetNofVoxels(), 0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cScoringMesh::EndOfRun(G4bool isMaster, 
+                              const G4String& outputFileName)
+{
+  if ( ! fEnabled || ! fgMap ) return;
+
+  // Add the map of this thread (the workers, or master in sequential 
+  // mode)
+  fEdep.Add(fgMap->fEdep);
+  fFluence.Add(fgMap->fFluence);
+
+  if ( isMaster ) {
+    Write(outputFileName);
+  }
+  else {
+    // the worker maps are allocated again at the next run
+    delete fgMap;
+    fgMap = nullptr;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cScoringMesh::Write(const G4String& outputFileName) const
+{
+  std::filesystem::path path(outputFileName.c_str());
+  path.replace_filename(path.stem().string() + "_mesh.csv");
+  std::ofstream file(path);
+  if ( ! file ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << path.string() << ".";
+    G4Exception("B4cScoringMesh::Write()",
+      "MyCode0013", JustWarning, msg);
+    return;
+  }
+
+  // one row per voxel crossed by a track, with the position of its centre
+  // (the dose is 0 in the voxels without material)
+  file << "ix,iy,iz,x_mm,y_mm,z_mm,edep_MeV,mass_g,dose_Gy,"
+       << "fluence_per_cm2\n";
+  G4double width[3] = { 2.*fHalfSize.x() / fBins[0], 
+                        2.*fHalfSize.y() / fBins[1], 
+                        2.*fHalfSize.z() / fBins[2] };
+  const auto& edep = fEdep.Get();
+  const auto& fluence = fFluence.Get();
+  std::size_t nofCrossed = 0;
+  G4double maxDose = 0.;
+  for ( G4int ix=0; ix<fBins[0]; ++ix ) {
+    for ( G4int iy=0; iy<fBins[1]; ++iy ) {
+      for ( G4int iz=0; iz<fBins[2]; ++iz ) {
+        auto index = ( std::size_t(ix) * fBins[1] + iy ) * fBins[2] + iz;
+        if ( fluence[index] == 0. ) continue;
+        ++nofCrossed;
+        auto mass = fMasses[index];
+        auto dose = ( mass > 0. ) ? edep[index] / mass : 0.;
+        maxDose = std::max(maxDose, dose);
+        file << ix << "," << iy << "," << iz << ","
+             << ( -fHalfSize.x() + ( ix + 0.5 ) * width[0] ) / mm << ","
+             << ( -fHalfSize.y() + ( iy + 0.5 ) * width[1] ) / mm << ","
+             << ( -fHalfSize.z() + ( iz + 0.5 ) * width[2] ) / mm << ","
+             << edep[index] / MeV << ","
+             << mass / g << ","
+             << dose / gray << ","
+             << fluence[index] * cm2 << "\n";
+      }
+    }
+  }
+
+  G4cout << "### Mesh: " << fBins[0] << " x " << fBins[1] << " x " 
+         << fBins[2] << " voxels of " 
+         << G4BestUnit(GetVoxelVolume(), "Volume") << ", " 
+         << nofCrossed << " crossed, max dose " 
+         << G4BestUnit(maxDose, "Dose") << ", written in " 
+         << path.string() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,151 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cScoringMesh.hh
+/// \brief Definition of the B4cScoringMesh class
+
+#ifndef B4cScoringMesh_h
+#define B4cScoringMesh_h 1
+
+#include "B4MergedVector.hh"
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+
+#include <array>
+#include <vector>
+
+class G4GenericMessenger;
+
+/// Dose and fluence maps on a box mesh centred on the panels.
+///
+/// The mesh is built in the parallel world B4cScoringWorld, navigated 
+/// by G4ParallelWorldProcess, so that the voxels do not slow down the 
+/// navigation in the mass geometry. The energy deposit and the fluence 
+/// (track length over the voxel volume) are accumulated by B4cMeshSD on 
+/// each thread in contiguous arrays, added to the map of master at the
+/// end of run of each worker and written by master in a CSV file 
+/// <output>_mesh.csv, with one row per voxel with a non-zero fluence.
+///
+/// The dose is the energy over the mass of the material inside the 
+/// voxel, whatever the material of the steps. At the start of run master
+/// estimates the mass of each voxel by locating kNofMassSamples^3 points
+/// of a regular grid of the voxel in the mass geometry: the mass is exact
+/// for the voxels in one material and approximated for the voxels which
+/// contain a material boundary. The energy is written with the dose.
+///
+/// The mesh is defined before the initialization; enabling it registers
+/// the parallel world with the detector construction and its physics 
+/// with the physics list, so that it costs nothing when it is not used.
+/// The following commands are defined (on master, in PreInit state):
+/// - /B4/mesh/setEnabled
+/// - /B4/mesh/setHalfSize x y z unit
+/// - /B4/mesh/setBins nx ny nz
+
+class B4cScoringMesh
+{
+  public:
+    static B4cScoringMesh* Instance();
+    ~B4cScoringMesh();
+
+    // Called from the run action
+    void BeginOfRun(G4bool isMaster);
+    void EndOfRun(G4bool isMaster, const G4String& outputFileName);
+
+    // Number of points per axis sampled for the voxel masses
+    static constexpr G4int kNofMassSamples = 3;
+
+    // Accumulates a step in the given voxel on the calling thread,
+    // with the weight of its track
+    void Fill(G4int ix, G4int iy, G4int iz, G4double edep, 
+              G4double fluence, G4double weight = 1.);
+
+    // set/get methods
+    void SetEnabled();
+    G4bool GetEnabled() const;
+    void SetHalfSize(const G4ThreeVector& halfSize);
+    const G4ThreeVector& GetHalfSize() const;
+    void SetBins(const G4String& bins);
+    const std::array<G4int, 3>& GetBins() const;
+    G4double GetVoxelVolume() const;
+
+  private:
+    B4cScoringMesh();
+
+    // Energy deposit and fluence of the voxels
+    struct Map {
+      std::vector<G4double> fEdep;
+      std::vector<G4double> fFluence;
+    };
+
+    std::size_t GetNofVoxels() const;
+    void ComputeMasses();
+    void Write(const G4String& outputFileName) const;
+
+    static B4cScoringMesh* fgInstance;
+    static G4ThreadLocal Map* fgMap;
+
+    G4GenericMessenger* fMessenger;
+    G4bool fEnabled;
+    G4ThreeVector fHalfSize;
+    std::array<G4int, 3> fBins;
+    B4MergedVector<G4double> fEdep;
+    B4MergedVector<G4double> fFluence;
+    std::vector<G4double> fMasses;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B4cScoringMesh::Fill(G4int ix, G4int iy, G4int iz, 
+                                 G4double edep, G4double fluence,
+                                 G4double weight) {
+  auto index = ( std::size_t(ix) * fBins[1] + iy ) * fBins[2] + iz;
+  fgMap->fEdep[index] += weight * edep;
+  fgMap->fFluence[index] += weight * fluence;
+}
+
+inline G4bool B4cScoringMesh::GetEnabled() const {
+  return fEnabled;
+}
+
+inline void B4cScoringMesh::SetHalfSize(const G4ThreeVector& halfSize) {
+  fHalfSize = halfSize;
+}
+
+inline const G4ThreeVector& B4cScoringMesh::GetHalfSize() const {
+  return fHalfSize;
+}
+
+inline const std::array<G4int, 3>& B4cScoringMesh::GetBins() const {
+  return fBins;
+}
+
+inline G4double B4cScoringMesh::GetVoxelVolume() const {
+  return 8. * fHalfSize.x() * fHalfSize.y() * fHalfSize.z() 
+         / ( G4double(fBins[0]) * fBins[1] * fBins[2] );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,112 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cScoringWorld.cc
+/// \brief Implementation of the B4cScoringWorld class
+
+#include "B4cScoringWorld.hh"
+#include "B4cScoringMesh.hh"
+#include "B4cMeshSD.hh"
+
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4PVPlacement.hh"
+#include "G4PVReplica.hh"
+#include "G4SDManager.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const G4String B4cScoringWorld::kWorldName = "B4cScoringWorld";
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cScoringWorld::B4cScoringWorld(const G4String& worldName)
+ : G4VUserParallelWorld(worldName),
+   fVoxelLV(nullptr)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cScoringWorld::~B4cScoringWorld()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cScoringWorld::Construct()
+{
+  // The mesh is built once, it is kept when the mass geometry is rebuilt
+  if ( fVoxelLV ) return;
+
+  auto mesh = B4cScoringMesh::Instance();
+  const auto& halfSize = mesh->GetHalfSize();
+  const auto& bins = mesh->GetBins();
+
+  // The world of the parallel world, with its own solid
+  // (it is created with the solid of the mass world)
+  auto worldPV = GetWorld();
+  auto worldLV = worldPV->GetLogicalVolume();
+  auto worldS = new G4Box(kWorldName, 10.*m, 10.*m, 10.*m);
+  worldLV->SetSolid(worldS);
+
+  // Mesh box
+  auto meshS = new G4Box("Mesh", halfSize.x(), halfSize.y(), halfSize.z());
+  auto meshLV = new G4LogicalVolume(meshS, nullptr, "MeshLV");
+  new G4PVPlacement(0, G4ThreeVector(), meshLV, "Mesh", worldLV, false, 0);
+
+  // Slices along x, y, then voxels along z
+  auto sliceXS = new G4Box("MeshX", halfSize.x() / bins[0], 
+                           halfSize.y(), halfSize.z());
+  auto sliceXLV = new G4LogicalVolume(sliceXS, nullptr, "MeshXLV");
+  new G4PVReplica("MeshX", sliceXLV, meshLV, kXAxis, bins[0], 
+                  2. * halfSize.x() / bins[0]);
+
+  auto sliceYS = new G4Box("MeshY", halfSize.x() / bins[0], 
+                           halfSize.y() / bins[1], halfSize.z());
+  auto sliceYLV = new G4LogicalVolume(sliceYS, nullptr, "MeshYLV");
+  new G4PVReplica("MeshY", sliceYLV, sliceXLV, kYAxis, bins[1], 
+                  2. * halfSize.y() / bins[1]);
+
+  auto voxelS = new G4Box("MeshVoxel", halfSize.x() / bins[0], 
+                          halfSize.y() / bins[1], halfSize.z() / bins[2]);
+  fVoxelLV = new G4LogicalVolume(voxelS, nullptr, "MeshVoxelLV");
+  new G4PVReplica("MeshVoxel", fVoxelLV, sliceYLV, kZAxis, bins[2], 
+                  2. * halfSize.z() / bins[2]);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cScoringWorld::ConstructSD()
+{
+  // The detector is created once per thread 
+  // (ConstructSD is called again when the mass geometry is rebuilt)
+  if ( fVoxelLV->GetSensitiveDetector() ) return;
+
+  auto meshSD = new B4cMeshSD("MeshSD");
+  G4SDManager::GetSDMpointer()->AddNewDetector(meshSD);
+  SetSensitiveDetector(fVoxelLV, meshSD);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
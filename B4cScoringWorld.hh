@@ -0,0 +1,64 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cScoringWorld.hh
+/// \brief Definition of the B4cScoringWorld class
+
+#ifndef B4cScoringWorld_h
+#define B4cScoringWorld_h 1
+
+#include "G4VUserParallelWorld.hh"
+
+class G4LogicalVolume;
+
+/// Parallel world of the dose and fluence mesh (see B4cScoringMesh).
+///
+/// The mesh box is divided in voxels by three levels of replicas along
+/// x, y and z, so that the parallel navigation limits the steps at the 
+/// voxel boundaries; B4cMeshSD is attached to the voxels on each thread.
+///
+/// The mesh does not change when the mass geometry is rebuilt between 
+/// runs: its volumes are built once, and the world of the parallel world,
+/// created with the solid of the mass world, gets its own box, larger 
+/// than the mass world.
+
+class B4cScoringWorld : public G4VUserParallelWorld
+{
+  public:
+    static const G4String kWorldName;
+
+    B4cScoringWorld(const G4String& worldName);
+    virtual ~B4cScoringWorld();
+
+    virtual void Construct();
+    virtual void ConstructSD();
+
+  private:
+    G4LogicalVolume* fVoxelLV;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
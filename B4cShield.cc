@@ -0,0 +1,321 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cShield.cc
+/// \brief Implementation of the B4cShield class
+
+#include "B4cShield.hh"
+#include "B4cImportanceWorld.hh"
+#include "B4cEventKeeper.hh"
+#include "B4cOpticalReadout.hh"
+#include "B4cTrigger.hh"
+
+#include "G4Track.hh"
+#include "G4Material.hh"
+#include "G4NistManager.hh"
+#include "G4IStore.hh"
+#include "G4GeometrySampler.hh"
+#include "G4ImportanceBiasing.hh"
+#include "G4ParallelWorldPhysics.hh"
+#include "G4VUserDetectorConstruction.hh"
+#include "G4VModularPhysicsList.hh"
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cShield* B4cShield::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cShield* B4cShield::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4cShield();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cShield::B4cShield()
+ : fMessenger(nullptr),
+   fLayers(),
+   fCellThickness(5.*cm),
+   fImportanceRatio(2.),
+   fInnerHalfSize(0.),
+   fBiasing(false),
+   fParticle(),
+   fSampler(nullptr),
+   fMasterStore(nullptr)
+{
+  // The shield is part of the geometry shared by all threads:
+  // the commands are executed on master only
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/shield/", 
+                             "Shield and importance biasing control");
+
+  auto& layerCmd 
+    = fMessenger->DeclareMethod("addLayer", &B4cShield::AddLayer,
+                                "Add a shield layer outside the previous "
+                                "ones: material thickness unit.");
+  layerCmd.SetParameterName("layer", false);
+  layerCmd.SetStates(G4State_PreInit, G4State_Idle);
+  layerCmd.command->SetToBeBroadcasted(false);
+
+  auto& clearCmd 
+    = fMessenger->DeclareMethod("clearLayers", &B4cShield::ClearLayers,
+                                "Remove all the shield layers.");
+  clearCmd.SetStates(G4State_PreInit, G4State_Idle);
+  clearCmd.command->SetToBeBroadcasted(false);
+
+  auto& biasingCmd 
+    = fMessenger->DeclareMethod("setBiasing", &B4cShield::SetBiasing,
+                                "Define the importance cells of the shield "
+                                "and bias the transport of the particle.");
+  biasingCmd.SetParameterName("particle", false);
+  biasingCmd.SetStates(G4State_PreInit);
+  biasingCmd.command->SetToBeBroadcasted(false);
+
+  auto& cellCmd 
+    = fMessenger->DeclarePropertyWithUnit("setCellThickness", "cm", 
+                                          fCellThickness,
+                                          "Set the maximum thickness of the "
+                                          "importance cells.");
+  cellCmd.SetParameterName("thickness", false);
+  cellCmd.SetRange("thickness>0.");
+  cellCmd.SetStates(G4State_PreInit, G4State_Idle);
+  cellCmd.command->SetToBeBroadcasted(false);
+
+  auto& ratioCmd 
+    = fMessenger->DeclareProperty("setImportanceRatio", fImportanceRatio,
+                                  "Set the ratio of the importances of "
+                                  "successive cells.");
+  ratioCmd.SetParameterName("ratio", false);
+  ratioCmd.SetRange("ratio>=1.");
+  ratioCmd.SetStates(G4State_PreInit, G4State_Idle);
+  ratioCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cShield::~B4cShield()
+{ 
+  delete fSampler;
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cShield::AddLayer(const G4String& layer)
+{
+  // The material is looked up now, so that a wrong name is reported
+  // before the geometry is built
+  std::istringstream input(layer);
+  G4String material, unit;
+  G4double thickness = 0.;
+  auto nistManager = G4NistManager::Instance();
+  G4bool valid = ( input >> material >> thickness >> unit ) && thickness > 0.
+              && G4UnitDefinition::GetCategory(unit) == "Length"
+              && ( material == kRockName 
+                   || G4Material::GetMaterial(material, false)
+                   || nistManager->FindOrBuildMaterial(material) );
+  if ( ! valid ) {
+    G4ExceptionDescription msg;
+    msg << "Wrong shield layer \"" << layer << "\", layer ignored.";
+    G4Exception("B4cShield::AddLayer()",
+      "MyCode0020", JustWarning, msg);
+    return;
+  }
+
+  Layer value;
+  value.fMaterial = material;
+  value.fThickness = thickness * G4UnitDefinition::GetValueOf(unit);
+  fLayers.push_back(value);
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cShield::ClearLayers()
+{
+  if ( fLayers.empty() ) return;
+
+  fLayers.clear();
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cShield::SetBiasing(const G4String& particle)
+{
+  if ( fBiasing ) {
+    G4ExceptionDescription msg;
+    msg << "The biasing is already enabled for " << fParticle 
+        << ", " << particle << " is not biased.";
+    G4Exception("B4cShield::SetBiasing()",
+      "MyCode0020", JustWarning, msg);
+    return;
+  }
+
+  auto runManager = G4RunManager::GetRunManager();
+  auto detector = const_cast<G4VUserDetectorConstruction*>(
+                    runManager->GetUserDetectorConstruction());
+  auto physicsList = dynamic_cast<G4VModularPhysicsList*>(
+                       const_cast<G4VUserPhysicsList*>(
+                         runManager->GetUserPhysicsList()));
+  if ( ! detector || ! physicsList ) {
+    G4ExceptionDescription msg;
+    msg << "The detector construction and a modular physics list "
+        << "must be set before enabling the biasing.";
+    G4Exception("B4cShield::SetBiasing()",
+      "MyCode0020", JustWarning, msg);
+    return;
+  }
+
+  // The sampler is used by the biasing processes of all threads
+  const auto& worldName = B4cImportanceWorld::kWorldName;
+  fSampler = new G4GeometrySampler(worldName, particle);
+  fSampler->SetParallel(true);
+
+  detector->RegisterParallelWorld(new B4cImportanceWorld(worldName));
+  physicsList->RegisterPhysics(new G4ImportanceBiasing(fSampler, worldName));
+  physicsList->RegisterPhysics(new G4ParallelWorldPhysics(worldName));
+  fParticle = particle;
+  fBiasing = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4cShield::GetThickness() const
+{
+  return std::accumulate(fLayers.begin(), fLayers.end(), 0.,
+           [](G4double sum, const Layer& layer) { 
+             return sum + layer.fThickness; });
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<G4double> B4cShield::GetCellHalfSizes() const
+{
+  // Each layer is divided in cells of equal thickness, so that the 
+  // cell boundaries include the layer boundaries
+  auto halfSize = fInnerHalfSize + GetThickness();
+  std::vector<G4double> halfSizes = { halfSize };
+  for ( auto layer = fLayers.rbegin(); layer != fLayers.rend(); ++layer ) {
+    auto nofCells 
+      = std::max(1, G4int(std::ceil(layer->fThickness / fCellThickness 
+                                    - 1.e-9)));
+    for ( G4int i=0; i<nofCells; ++i ) {
+      halfSize -= layer->fThickness / nofCells;
+      halfSizes.push_back(halfSize);
+    }
+  }
+  // the innermost box is the space of the panels
+  if ( ! fLayers.empty() ) halfSizes.back() = fInnerHalfSize;
+  return halfSizes;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4cShield::GetWeight(const G4Track* track) const
+{
+  return fBiasing ? track->GetWeight() : 1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cShield::BeginOfRun(G4bool isMaster)
+{
+  if ( ! fBiasing ) return;
+
+  // The cells are rebuilt with the mass geometry, the store is filled
+  // again at each run; the workers fill their own store if they have one
+  auto store = G4IStore::GetInstance(B4cImportanceWorld::kWorldName);
+  if ( ! isMaster ) {
+    if ( store != fMasterStore ) FillStore(store);
+    return;
+  }
+
+  // The features acting on single events are refused: the clones of 
+  // a track deposit in the same event
+  G4String features;
+  if ( B4cTrigger::Instance()->GetEnabled() ) {
+    features += " trigger,";
+  }
+  if ( B4cEventKeeper::Instance()->GetEnabled() ) {
+    features += " event keeping,";
+  }
+  if ( B4cOpticalReadout::Instance()->IsActive() ) {
+    features += " optical readout,";
+  }
+  if ( features.size() ) {
+    features.pop_back();
+    G4ExceptionDescription msg;
+    msg << "The biased shield transport cannot be used with:" << features
+        << "." << G4endl << "Their events are not physical, the run is "
+        << "aborted.";
+    G4Exception("B4cShield::BeginOfRun()",
+      "MyCode0020", RunMustBeAborted, msg);
+  }
+
+  FillStore(store);
+  fMasterStore = store;
+
+  auto nofCells = GetCellHalfSizes().size();
+  G4cout << "### Shield: " << fLayers.size() << " layers, " 
+         << G4BestUnit(GetThickness(), "Length") << ", " 
+         << nofCells << " importance cells up to " 
+         << std::pow(fImportanceRatio, G4double(nofCells - 1))
+         << " for " << fParticle << G4endl
+         << "    only the weighted deposits and the dose mesh are filled" 
+         << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cShield::FillStore(G4IStore* store) const
+{
+  // The cells are nested: the importance is multiplied by the ratio 
+  // at each level, from 1 in the world to the space of the panels
+  store->Clear();
+  auto importance = 1.;
+  auto cell = &store->GetWorldVolume();
+  while ( cell ) {
+    store->AddImportanceGeometryCell(importance, *cell);
+    auto cellLV = cell->GetLogicalVolume();
+    cell = ( cellLV->GetNoDaughters() > 0 ) ? cellLV->GetDaughter(0) : nullptr;
+    importance *= fImportanceRatio;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
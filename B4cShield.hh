@@ -0,0 +1,155 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cShield.hh
+/// \brief Definition of the B4cShield class
+
+#ifndef B4cShield_h
+#define B4cShield_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class G4Track;
+class G4GeometrySampler;
+class G4IStore;
+class G4GenericMessenger;
+
+/// Layered shield around the panels, and geometry importance biasing 
+/// of the transport through it.
+///
+/// The layers (rock, lead, copper or any NIST material) are hollow 
+/// boxes placed by B4cDetectorConstruction around the space of the 
+/// panels, from the inside out in the order of their definition; the
+/// world is enlarged to contain them. "StandardRock" is the standard 
+/// rock (Z=11, A=22, 2.65 g/cm3). Adding or clearing layers rebuilds
+/// the mass geometry.
+///
+/// Without biasing, only a tiny fraction of the particles entering 
+/// tens of centimetres of shield reaches the panels. When biasing is 
+/// enabled (before the initialization, for one particle type), each 
+/// layer is divided along its depth into cells of about the given 
+/// thickness, defined in the parallel world B4cImportanceWorld; the 
+/// importance grows by the given ratio from each cell to the next one
+/// inward, from 1 outside to the highest value in the space of the 
+/// panels. The particles are split at each cell boundary crossed 
+/// inward, and played Russian roulette outward (G4GeometrySampler).
+///
+/// The importance store is filled by master at each start of run, and
+/// also by the workers when each thread has its own store.
+///
+/// The clones of a split track are tracked in the same event, and their
+/// deposits add up to energies which no single history produces: with 
+/// biasing, the events are only valid as tallies of weighted means. The
+/// deposits stay physical and the hits carry the mean track weight of 
+/// each panel (see GetWeight()); the run action sums the weighted 
+/// deposits of each panel and prints their means per primary, and the
+/// dose mesh weights each step by its track weight. The per-event 
+/// outputs (the histograms, the ntuples, the digits and the shared 
+/// spectra) are not filled, and the runs with the trigger, the event 
+/// keeping or the optical readout are aborted at the start of run.
+///
+/// The following commands are defined (on master only):
+/// - /B4/shield/addLayer material thickness unit
+/// - /B4/shield/clearLayers
+/// - /B4/shield/setBiasing particle     (PreInit)
+/// - /B4/shield/setCellThickness value unit
+/// - /B4/shield/setImportanceRatio value
+
+class B4cShield
+{
+  public:
+    // A layer of the shield
+    struct Layer {
+      G4String fMaterial;
+      G4double fThickness = 0.;
+    };
+
+    static constexpr const char* kRockName = "StandardRock";
+
+    static B4cShield* Instance();
+    ~B4cShield();
+
+    // Called from the run action
+    void BeginOfRun(G4bool isMaster);
+
+    // Called from the sensitive detectors
+    G4double GetWeight(const G4Track* track) const;
+
+    // Called from the detector construction
+    void SetInnerHalfSize(G4double halfSize);
+
+    // set/get methods
+    void AddLayer(const G4String& layer);
+    void ClearLayers();
+    void SetBiasing(const G4String& particle);
+    G4bool GetBiasing() const;
+    const std::vector<Layer>& GetLayers() const;
+    G4double GetThickness() const;
+    G4double GetInnerHalfSize() const;
+
+    // Half-sizes of the cell boxes from the outside in, the outermost
+    // cell being the world
+    std::vector<G4double> GetCellHalfSizes() const;
+
+  private:
+    B4cShield();
+
+    void FillStore(G4IStore* store) const;
+
+    static B4cShield* fgInstance;
+
+    G4GenericMessenger* fMessenger;
+    std::vector<Layer> fLayers;
+    G4double fCellThickness;
+    G4double fImportanceRatio;
+    G4double fInnerHalfSize;
+    G4bool   fBiasing;
+    G4String fParticle;
+    G4GeometrySampler* fSampler;
+    const G4IStore* fMasterStore;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B4cShield::SetInnerHalfSize(G4double halfSize) {
+  fInnerHalfSize = halfSize;
+}
+
+inline G4bool B4cShield::GetBiasing() const {
+  return fBiasing;
+}
+
+inline const std::vector<B4cShield::Layer>& B4cShield::GetLayers() const {
+  return fLayers;
+}
+
+inline G4double B4cShield::GetInnerHalfSize() const {
+  return fInnerHalfSize;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,195 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cSiliconResponse.cc
+/// \brief Implementation of the B4cSiliconResponse class
+
+#include "B4cSiliconResponse.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cSiliconResponse* B4cSiliconResponse::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cSiliconResponse* B4cSiliconResponse::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4cSiliconResponse();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cSiliconResponse::B4cSiliconResponse()
+ : fMessenger(nullptr),
+   fEnabled(true),
+   fDigitsOnly(false),
+   fPairEnergy(3.62*eV),
+   fFano(0.115),
+   fNoise(1000.),
+   fThreshold(20.*keV),
+   fAdcGain(1.*keV),
+   fAdcBits(14),
+   fDeadTime(0.),
+   fSourceRate(0.)
+{
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/digi/", "Panel digitization");
+
+  auto& enabledCmd 
+    = fMessenger->DeclareMethod("setEnabled", &B4cSiliconResponse::SetEnabled,
+                                "Digitize the panels at the end of event.");
+  enabledCmd.SetParameterName("enabled", true);
+  enabledCmd.SetDefaultValue("true");
+  enabledCmd.command->SetToBeBroadcasted(false);
+
+  auto& digitsOnlyCmd 
+    = fMessenger->DeclareMethod("setDigitsOnly", 
+                                &B4cSiliconResponse::SetDigitsOnly,
+                                "Write only the digits ntuple.");
+  digitsOnlyCmd.SetParameterName("digitsOnly", true);
+  digitsOnlyCmd.SetDefaultValue("true");
+  digitsOnlyCmd.SetStates(G4State_PreInit, G4State_Idle);
+  digitsOnlyCmd.command->SetToBeBroadcasted(false);
+
+  auto& fanoCmd 
+    = fMessenger->DeclareProperty("setFano", fFano, 
+                                  "Set the Fano factor.");
+  fanoCmd.SetParameterName("factor", false);
+  fanoCmd.SetRange("factor>=0.");
+  fanoCmd.command->SetToBeBroadcasted(false);
+
+  auto& noiseCmd 
+    = fMessenger->DeclareProperty("setNoise", fNoise, 
+                                  "Set the equivalent noise charge "
+                                  "(in electrons).");
+  noiseCmd.SetParameterName("electrons", false);
+  noiseCmd.SetRange("electrons>=0.");
+  noiseCmd.command->SetToBeBroadcasted(false);
+
+  auto& thresholdCmd 
+    = fMessenger->DeclarePropertyWithUnit("setThreshold", "keV", fThreshold,
+                                          "Set the panel threshold.");
+  thresholdCmd.SetParameterName("threshold", false);
+  thresholdCmd.command->SetToBeBroadcasted(false);
+
+  auto& gainCmd 
+    = fMessenger->DeclarePropertyWithUnit("setAdcGain", "keV", fAdcGain,
+                                          "Set the energy per ADC channel.");
+  gainCmd.SetParameterName("gain", false);
+  gainCmd.SetRange("gain>0.");
+  gainCmd.command->SetToBeBroadcasted(false);
+
+  auto& bitsCmd 
+    = fMessenger->DeclareProperty("setAdcBits", fAdcBits,
+                                  "Set the number of bits of the ADC.");
+  bitsCmd.SetParameterName("nBits", false);
+  bitsCmd.SetRange("nBits>0 && nBits<31");
+  bitsCmd.command->SetToBeBroadcasted(false);
+
+  auto& deadTimeCmd 
+    = fMessenger->DeclarePropertyWithUnit("setDeadTime", "us", fDeadTime,
+                                          "Set the panel dead time.");
+  deadTimeCmd.SetParameterName("deadTime", false);
+  deadTimeCmd.SetRange("deadTime>=0.");
+  deadTimeCmd.command->SetToBeBroadcasted(false);
+
+  auto& rateCmd 
+    = fMessenger->DeclarePropertyWithUnit("setSourceRate", "Hz", fSourceRate,
+                                          "Set the rate of the primary "
+                                          "events, used for the live "
+                                          "fraction.");
+  rateCmd.SetParameterName("rate", false);
+  rateCmd.SetRange("rate>=0.");
+  rateCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cSiliconResponse::~B4cSiliconResponse()
+{ 
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4cSiliconResponse::Measure(G4double edep, 
+                                     CLHEP::HepRandomEngine* engine) const
+{
+  // 1. number of electron-hole pairs, with the Fano fluctuation (in the
+  //    Gaussian approximation, which is poor only for deposits of a few
+  //    tens of pairs, far below the noise)
+  auto nofPairs = edep / fPairEnergy;
+  if ( nofPairs > 0. && fFano > 0. ) {
+    nofPairs 
+      = G4RandGauss::shoot(engine, nofPairs, std::sqrt(fFano * nofPairs));
+  }
+
+  // 2. electronic noise, added to every panel, also without deposit
+  if ( fNoise > 0. ) {
+    nofPairs += G4RandGauss::shoot(engine, 0., fNoise);
+  }
+
+  // the threshold is applied by the digitizer to the returned energy,
+  // which includes the noise
+  return std::max(nofPairs, 0.) * fPairEnergy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int B4cSiliconResponse::ToAdc(G4double energy) const
+{
+  // the last channel collects the overflows
+  auto maxAdc = ( 1 << fAdcBits ) - 1;
+  auto adc = std::floor(energy / fAdcGain);
+  return G4int(std::min(adc, G4double(maxAdc)));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4cSiliconResponse::ToEnergy(G4int adc) const
+{
+  // center of the channel
+  return ( adc + 0.5 ) * fAdcGain;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B4cSiliconResponse::GetLiveFraction(G4double rate) const
+{
+  return 1. / ( 1. + rate * fDeadTime );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
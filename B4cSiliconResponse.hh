@@ -0,0 +1,144 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cSiliconResponse.hh
+/// \brief Definition of the B4cSiliconResponse class
+
+#ifndef B4cSiliconResponse_h
+#define B4cSiliconResponse_h 1
+
+#include "globals.hh"
+
+class G4GenericMessenger;
+
+namespace CLHEP {
+  class HepRandomEngine;
+}
+
+/// Response of the silicon detector panels, applied by B4cDigitizer.
+///
+/// The energy deposit is converted in electron-hole pairs (3.62 eV per
+/// pair), whose number fluctuates with the Fano factor; the electronic 
+/// noise (equivalent noise charge, in electrons) is added and the 
+/// measured energy is converted in an ADC value with the given gain and
+/// number of bits. The threshold is applied last, to the measured energy
+/// (with the noise): only the panels above it give a digit.
+///
+/// The dead time of the panels is not applied event by event, as the
+/// events are processed independently on several threads: a 
+/// non-paralyzable live fraction 1/(1 + rate * deadTime) is computed 
+/// at the end of run from the digit rate of each panel, for the given 
+/// source rate.
+///
+/// The response is shared by all threads, the following commands are 
+/// therefore executed on master only:
+/// - /B4/digi/setEnabled true|false
+/// - /B4/digi/setDigitsOnly true|false (write only the digits ntuple)
+/// - /B4/digi/setFano factor
+/// - /B4/digi/setNoise electrons
+/// - /B4/digi/setThreshold value unit
+/// - /B4/digi/setAdcGain value unit  (energy per ADC channel)
+/// - /B4/digi/setAdcBits nBits
+/// - /B4/digi/setDeadTime value unit
+/// - /B4/digi/setSourceRate value unit
+
+class B4cSiliconResponse
+{
+  public:
+    static B4cSiliconResponse* Instance();
+    ~B4cSiliconResponse();
+
+    // Returns the energy measured for the given energy deposit, 
+    // with the fluctuations drawn from the given engine
+    G4double Measure(G4double edep, CLHEP::HepRandomEngine* engine) const;
+
+    // Returns the ADC value of the measured energy, 
+    // and the energy reconstructed from the ADC value
+    G4int    ToAdc(G4double energy) const;
+    G4double ToEnergy(G4int adc) const;
+
+    // Returns the live fraction of a panel with the given digit rate
+    G4double GetLiveFraction(G4double rate) const;
+
+    // set/get methods
+    void     SetEnabled(G4bool enabled);
+    G4bool   GetEnabled() const;
+    void     SetDigitsOnly(G4bool digitsOnly);
+    G4bool   GetDigitsOnly() const;
+    G4double GetThreshold() const;
+    G4double GetDeadTime() const;
+    G4double GetSourceRate() const;
+
+  private:
+    B4cSiliconResponse();
+
+    static B4cSiliconResponse* fgInstance;
+
+    G4GenericMessenger* fMessenger;
+    G4bool   fEnabled;
+    G4bool   fDigitsOnly;
+    G4double fPairEnergy;
+    G4double fFano;
+    G4double fNoise;
+    G4double fThreshold;
+    G4double fAdcGain;
+    G4int    fAdcBits;
+    G4double fDeadTime;
+    G4double fSourceRate;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B4cSiliconResponse::SetEnabled(G4bool enabled) {
+  fEnabled = enabled;
+}
+
+inline G4bool B4cSiliconResponse::GetEnabled() const {
+  return fEnabled;
+}
+
+inline void B4cSiliconResponse::SetDigitsOnly(G4bool digitsOnly) {
+  fDigitsOnly = digitsOnly;
+}
+
+inline G4bool B4cSiliconResponse::GetDigitsOnly() const {
+  return fEnabled && fDigitsOnly;
+}
+
+inline G4double B4cSiliconResponse::GetThreshold() const {
+  return fThreshold;
+}
+
+inline G4double B4cSiliconResponse::GetDeadTime() const {
+  return fDeadTime;
+}
+
+inline G4double B4cSiliconResponse::GetSourceRate() const {
+  return fSourceRate;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,89 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cStackingAction.cc
+/// \brief Implementation of the B4cStackingAction class
+
+#include "B4cStackingAction.hh"
+#include "B4SubEventSplitter.hh"
+#include "B4cTrigger.hh"
+
+#include "G4Track.hh"
+#include "G4EventManager.hh"
+#include "G4StackManager.hh"
+#include "G4Version.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cStackingAction::B4cStackingAction()
+ : G4UserStackingAction()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cStackingAction::~B4cStackingAction()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ClassificationOfNewTrack 
+B4cStackingAction::ClassifyNewTrack(const G4Track* track)
+{
+  // the tracks toward the panels first (the runs with both the trigger
+  // and the sub-event splitting are aborted at the start of run)
+  auto trigger = B4cTrigger::Instance();
+  if ( trigger->GetEnabled() ) {
+    return trigger->Delay(track) ? fWaiting : fUrgent;
+  }
+
+#if G4VERSION_NUMBER >= 1120
+  // the sub-event type is registered as the first one
+  if ( B4SubEventSplitter::Instance()->Select(track) ) {
+    return fSubEvent_0;
+  }
+#endif
+
+  return fUrgent;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cStackingAction::NewStage()
+{
+  // the end of the event is not a new stage
+  if ( stackManager->GetNUrgentTrack() == 0 ) return;
+
+  if ( B4cTrigger::Instance()->NewStage() ) {
+    G4EventManager::GetEventManager()->AbortCurrentEvent();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cStackingAction::PrepareNewEvent()
+{
+  B4cTrigger::Instance()->PrepareNewEvent();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,58 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cStackingAction.hh
+/// \brief Definition of the B4cStackingAction class
+
+#ifndef B4cStackingAction_h
+#define B4cStackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+
+/// Stacking action class
+///
+/// When the panel trigger is enabled (see B4cTrigger), the tracks which
+/// do not head toward a panel are delayed to the next stage, and the 
+/// event is aborted at a new stage if the trigger can no longer fire.
+///
+/// Otherwise, when the events are split in sub-events (see 
+/// B4SubEventSplitter), the selected secondaries are stacked as 
+/// sub-event tracks; the other tracks are tracked by the thread of their
+/// event. The sub-events are not used with the trigger, whose bound 
+/// needs all the tracks of the event.
+
+class B4cStackingAction : public G4UserStackingAction
+{
+  public:
+    B4cStackingAction();
+    virtual ~B4cStackingAction();
+
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track);
+    virtual void NewStage();
+    virtual void PrepareNewEvent();
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,71 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cSteppingAction.cc
+/// \brief Implementation of the B4cSteppingAction class
+
+#include "B4cSteppingAction.hh"
+#include "B4RunAction.hh"
+#include "B4NavigationBenchmark.hh"
+#include "B4cNeutronCapture.hh"
+#include "B4cOpticalReadout.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cSteppingAction::B4cSteppingAction(B4RunAction* runAction)
+ : G4UserSteppingAction(),
+   fRunAction(runAction)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cSteppingAction::~B4cSteppingAction()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cSteppingAction::UserSteppingAction(const G4Step* step)
+{
+  // Record the fate of the neutrons for the capture table
+  auto neutronCapture = B4cNeutronCapture::Instance();
+  if ( neutronCapture->IsRecording() ) {
+    neutronCapture->Calibrate(step);
+  }
+
+  // Detect the optical photons, or look up the deposits in the gap
+  auto opticalReadout = B4cOpticalReadout::Instance();
+  if ( opticalReadout->IsActive() ) {
+    opticalReadout->Step(step);
+  }
+
+  if ( ! B4NavigationBenchmark::Instance()->GetEnabled() ) return;
+
+  fRunAction->AddStep(step->GetTrack()->GetCurrentStepNumber() == 1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
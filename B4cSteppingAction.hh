@@ -0,0 +1,60 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file B4cSteppingAction.hh
+/// \brief Definition of the B4cSteppingAction class
+
+#ifndef B4cSteppingAction_h
+#define B4cSteppingAction_h 1
+
+#include "G4UserSteppingAction.hh"
+
+class B4RunAction;
+
+/// Stepping action class
+///
+/// When the navigation benchmark is enabled (see B4NavigationBenchmark),
+/// it counts the steps and the tracks in the run action of its thread.
+/// In calibrate mode of the neutron capture parametrization, it records
+/// the fate of the neutrons (see B4cNeutronCapture). With the optical 
+/// readout of the gap, it detects the optical photons reaching the 
+/// panels or looks up the energy deposits in the gap 
+/// (see B4cOpticalReadout).
+
+class B4cSteppingAction : public G4UserSteppingAction
+{
+  public:
+    B4cSteppingAction(B4RunAction* runAction);
+    virtual ~B4cSteppingAction();
+
+    virtual void UserSteppingAction(const G4Step* step);
+    
+  private:
+    B4RunAction* fRunAction;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,335 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cTrigger.cc
+/// \brief Implementation of the B4cTrigger class
+
+#include "B4cTrigger.hh"
+#include "B4cCalorHit.hh"
+
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4SDManager.hh"
+#include "G4Track.hh"
+#include "G4Gamma.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+#include "G4Proton.hh"
+#include "G4Deuteron.hh"
+#include "G4Triton.hh"
+#include "G4He3.hh"
+#include "G4Alpha.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VSolid.hh"
+#include "G4GenericMessenger.hh"
+#include "G4AccumulableManager.hh"
+#include "G4UnitsTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cTrigger* B4cTrigger::fgInstance = nullptr;
+G4ThreadLocal B4cTrigger::ThreadData* B4cTrigger::fgData = nullptr;
+G4ThreadLocal B4cTrigger::Counters* B4cTrigger::fgCounters = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cTrigger* B4cTrigger::Instance()
+{
+  if ( ! fgInstance ) {
+    fgInstance = new B4cTrigger();
+  }
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cTrigger::B4cTrigger()
+ : fMessenger(nullptr),
+   fEnabled(false),
+   fMinPanels(2),
+   fThreshold(50.*keV),
+   fPanels()
+{
+  // The trigger is shared by all threads:
+  // the commands are executed on master only
+  fMessenger 
+    = new G4GenericMessenger(this, "/B4/trigger/", 
+                             "Panel coincidence trigger");
+
+  auto& enabledCmd 
+    = fMessenger->DeclareMethod("setEnabled", &B4cTrigger::SetEnabled,
+                                "Prioritize the tracks toward the panels "
+                                "and abort the events missing the trigger.");
+  enabledCmd.SetParameterName("enabled", true);
+  enabledCmd.SetDefaultValue("true");
+  enabledCmd.command->SetToBeBroadcasted(false);
+
+  auto& panelsCmd 
+    = fMessenger->DeclareProperty("setMinPanels", fMinPanels,
+                                  "Set the number of panels in coincidence.");
+  panelsCmd.SetParameterName("minPanels", false);
+  panelsCmd.SetRange("minPanels>0");
+  panelsCmd.command->SetToBeBroadcasted(false);
+
+  auto& thresholdCmd 
+    = fMessenger->DeclarePropertyWithUnit("setThreshold", "keV", fThreshold,
+                                          "Set the deposit threshold of a "
+                                          "panel.");
+  thresholdCmd.SetParameterName("threshold", false);
+  thresholdCmd.SetRange("threshold>0.");
+  thresholdCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B4cTrigger::~B4cTrigger()
+{ 
+  delete fgData;
+  fgData = nullptr;
+  delete fgCounters;
+  fgCounters = nullptr;
+  delete fMessenger;
+  fgInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cTrigger::BeginOfRun(G4bool isMaster)
+{
+  if ( ! fEnabled ) return;
+
+  // Master collects the panels before the workers start the run
+  if ( isMaster ) {
+    fPanels.clear();
+    auto world 
+      = G4PhysicalVolumeStore::GetInstance()->GetVolume("World", false);
+    auto worldLV = world ? world->GetLogicalVolume() : nullptr;
+    for ( std::size_t i=0; worldLV && i<worldLV->GetNoDaughters(); ++i ) {
+      auto daughter = worldLV->GetDaughter(i);
+      if ( daughter->GetName().compare(0, 4, "Abso") != 0 ) continue;
+      Panel panel;
+      panel.fSolid = daughter->GetLogicalVolume()->GetSolid();
+      panel.fInverseRotation = daughter->GetObjectRotationValue().inverse();
+      panel.fTranslation = daughter->GetObjectTranslation();
+      fPanels.push_back(panel);
+    }
+  }
+
+  if ( ! fgData ) fgData = new ThreadData();
+  *fgData = ThreadData();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cTrigger::EndOfEvent(const G4Event* event, 
+                            const B4cEventRecord* record)
+{
+  if ( ! fEnabled || ! fgData ) return;
+
+  fgCounters->fNofEvents += 1.;
+  if ( event->IsAborted() ) {
+    fgCounters->fNofAborted += 1.;
+  }
+  else if ( record && Fires(record->fEdep) ) {
+    fgCounters->fNofTriggered += 1.;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cTrigger::EndOfRun(G4bool isMaster)
+{
+  if ( ! fgData ) return;
+
+  // The data of this thread is created again at the next run
+  delete fgData;
+  fgData = nullptr;
+
+  if ( ! fEnabled || ! isMaster ) return;
+
+  auto nofAborted = fgCounters->fNofAborted.GetValue();
+  auto nofEvents = fgCounters->fNofEvents.GetValue();
+  G4cout << "### Trigger (" << fMinPanels << " panels above " 
+         << G4BestUnit(fThreshold, "Energy") << "): " 
+         << nofEvents << " events, " 
+         << fgCounters->fNofTriggered.GetValue() << " triggered, " 
+         << nofAborted << " aborted (" 
+         << 100. * nofAborted / std::max(nofEvents, 1.) << " %)" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cTrigger::RegisterAccumulables()
+{
+  if ( fgCounters ) return;
+
+  fgCounters = new Counters();
+  auto accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->RegisterAccumulable(fgCounters->fNofEvents);
+  accumulableManager->RegisterAccumulable(fgCounters->fNofTriggered);
+  accumulableManager->RegisterAccumulable(fgCounters->fNofAborted);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4cTrigger::Fires(
+         const std::array<G4double, B4cEventRecord::kNofPanels>& edep) const
+{
+  auto nofPanels 
+    = std::count_if(edep.begin(), edep.end(), 
+                    [this](G4double value) { return value >= fThreshold; });
+  return nofPanels >= fMinPanels;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4cTrigger::CanFire(
+         const std::array<G4double, B4cEventRecord::kNofPanels>& edep, 
+         G4double energy) const
+{
+  // the panels below the threshold are funded in the order of their 
+  // deficit
+  G4int nofPanels = 0;
+  std::vector<G4double> deficits;
+  for ( auto value : edep ) {
+    if ( value >= fThreshold ) ++nofPanels;
+    else deficits.push_back(fThreshold - value);
+  }
+  std::sort(deficits.begin(), deficits.end());
+  for ( auto deficit : deficits ) {
+    if ( nofPanels >= fMinPanels || deficit > energy ) break;
+    energy -= deficit;
+    ++nofPanels;
+  }
+  return nofPanels >= fMinPanels;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cTrigger::GetEdep(
+       std::array<G4double, B4cEventRecord::kNofPanels>& edep) const
+{
+  // the panel totals of the current event (the last hit of each panel)
+  edep.fill(0.);
+  auto event = G4EventManager::GetEventManager()->GetConstCurrentEvent();
+  auto hce = event ? event->GetHCofThisEvent() : nullptr;
+  if ( ! hce ) return;
+
+  auto& hcIDs = fgData->fHCIDs;
+  for ( std::size_t i=0; i<edep.size(); ++i ) {
+    if ( hcIDs[i] == -1 ) {
+      auto name = G4String("AbsorberHitsCollection");
+      if ( i > 0 ) name += std::to_string(i+1);
+      hcIDs[i] = G4SDManager::GetSDMpointer()->GetCollectionID(name);
+    }
+    if ( hcIDs[i] < 0 ) continue;
+    auto hc = static_cast<B4cCalorHitsCollection*>(hce->GetHC(hcIDs[i]));
+    if ( hc && hc->entries() > 0 ) {
+      edep[i] = (*hc)[hc->entries()-1]->GetEdep();
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4cTrigger::IsHeadingToPanel(const G4Track* track) const
+{
+  for ( const auto& panel : fPanels ) {
+    auto position 
+      = panel.fInverseRotation * ( track->GetPosition() - panel.fTranslation );
+    auto direction = panel.fInverseRotation * track->GetMomentumDirection();
+    if ( panel.fSolid->Inside(position) != kOutside ||
+         panel.fSolid->DistanceToIn(position, direction) != kInfinity ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B4cTrigger::PrepareNewEvent()
+{
+  if ( ! fEnabled || ! fgData ) return;
+
+  fgData->fFired = false;
+  fgData->fDelayedEnergy = 0.;
+  fgData->fUnbounded = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4cTrigger::Delay(const G4Track* track)
+{
+  if ( ! fEnabled || ! fgData || fgData->fFired ) return false;
+  if ( IsHeadingToPanel(track) ) return false;
+
+  // the energy which the track and its secondaries can deposit
+  auto definition = track->GetDefinition();
+  auto energy = track->GetKineticEnergy();
+  if ( definition == G4Positron::Definition() ) {
+    fgData->fDelayedEnergy += energy + 2.*electron_mass_c2;
+  }
+  else if ( definition == G4Gamma::Definition() || 
+            definition == G4Electron::Definition() ||
+            definition == G4Proton::Definition() ||
+            definition == G4Deuteron::Definition() ||
+            definition == G4Triton::Definition() ||
+            definition == G4He3::Definition() ||
+            definition == G4Alpha::Definition() ||
+            definition == G4OpticalPhoton::Definition() ) {
+    fgData->fDelayedEnergy += energy;
+  }
+  else {
+    fgData->fUnbounded = true;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B4cTrigger::NewStage()
+{
+  if ( ! fEnabled || ! fgData || fgData->fFired ) return false;
+
+  // the delayed tracks are the only ones left
+  std::array<G4double, B4cEventRecord::kNofPanels> edep;
+  GetEdep(edep);
+  auto abort 
+    = ! fgData->fUnbounded && ! CanFire(edep, fgData->fDelayedEnergy);
+  fgData->fFired = Fires(edep);
+  fgData->fDelayedEnergy = 0.;
+  fgData->fUnbounded = false;
+  return abort;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
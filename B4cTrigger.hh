@@ -0,0 +1,160 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+/// \file B4cTrigger.hh
+/// \brief Definition of the B4cTrigger class
+
+#ifndef B4cTrigger_h
+#define B4cTrigger_h 1
+
+#include "B4cEventRecord.hh"
+#include "globals.hh"
+#include "G4Accumulable.hh"
+#include "G4RotationMatrix.hh"
+#include "G4ThreeVector.hh"
+
+#include <array>
+#include <vector>
+
+class G4Event;
+class G4Track;
+class G4VSolid;
+class G4GenericMessenger;
+
+/// Panel coincidence trigger, and abort of the events which can no 
+/// longer fire it.
+///
+/// The trigger fires when at least the given number of panels have a 
+/// deposit above the threshold. When it is enabled, B4cStackingAction 
+/// tracks first the tracks inside or heading toward a panel and delays
+/// the others to the next stage. At each new stage, the energy which 
+/// the panels could still receive is bounded by the energy of the 
+/// delayed tracks (the kinetic energy, plus the annihilation energy for
+/// the positrons); the panels missing the trigger are funded from this
+/// bound in the order of their deficit, and the event is aborted if the
+/// trigger cannot be reached. The bound is infinite when a delayed 
+/// track can release more than its kinetic energy (neutrons, unstable
+/// particles, ions), so that such events are tracked on. Once the 
+/// trigger has fired, the tracks are no longer delayed.
+///
+/// The events which do not fire the trigger are not filled in the 
+/// outputs, whether they were aborted or tracked to the end, so that 
+/// the abort only saves the tracking time. The events are counted on 
+/// each thread and master prints the numbers of events, of triggered 
+/// and of aborted events at the end of run.
+///
+/// The tracks are delayed by the trigger instead of being split in 
+/// sub-events: the runs with both the trigger and the sub-event 
+/// splitting (see B4SubEventSplitter) are aborted at the start of run.
+///
+/// The following commands are defined (on master only):
+/// - /B4/trigger/setEnabled true|false
+/// - /B4/trigger/setMinPanels value
+/// - /B4/trigger/setThreshold value unit
+
+class B4cTrigger
+{
+  public:
+    static B4cTrigger* Instance();
+    ~B4cTrigger();
+
+    // Called from the run and event actions
+    void BeginOfRun(G4bool isMaster);
+    void EndOfEvent(const G4Event* event, const B4cEventRecord* record);
+    void EndOfRun(G4bool isMaster);
+
+    // Called from the run action constructor on each thread
+    void RegisterAccumulables();
+
+    // Called from the stacking action
+    void   PrepareNewEvent();
+    G4bool Delay(const G4Track* track);
+    G4bool NewStage();
+
+    // Whether the deposits fire the trigger
+    G4bool Fires(const std::array<G4double, B4cEventRecord::kNofPanels>& 
+                   edep) const;
+
+    // set/get methods
+    void   SetEnabled(G4bool enabled);
+    G4bool GetEnabled() const;
+
+  private:
+    B4cTrigger();
+
+    // A panel placed in the world
+    struct Panel {
+      const G4VSolid* fSolid = nullptr;
+      G4RotationMatrix fInverseRotation;
+      G4ThreeVector fTranslation;
+    };
+
+    // Event state of this thread
+    struct ThreadData {
+      G4bool   fFired = false;
+      G4double fDelayedEnergy = 0.;
+      G4bool   fUnbounded = false;
+      std::array<G4int, B4cEventRecord::kNofPanels> fHCIDs;
+      ThreadData() { fHCIDs.fill(-1); }
+    };
+
+    // Counters of this thread
+    struct Counters {
+      G4Accumulable<G4double> fNofEvents { "TriggerEvents", 0. };
+      G4Accumulable<G4double> fNofTriggered { "TriggerTriggered", 0. };
+      G4Accumulable<G4double> fNofAborted { "TriggerAborted", 0. };
+    };
+
+    G4bool IsHeadingToPanel(const G4Track* track) const;
+    G4bool CanFire(const std::array<G4double, B4cEventRecord::kNofPanels>& 
+                     edep, G4double energy) const;
+    void   GetEdep(std::array<G4double, B4cEventRecord::kNofPanels>& edep) 
+             const;
+
+    static B4cTrigger* fgInstance;
+    static G4ThreadLocal ThreadData* fgData;
+    static G4ThreadLocal Counters* fgCounters;
+
+    G4GenericMessenger* fMessenger;
+    G4bool   fEnabled;
+    G4int    fMinPanels;
+    G4double fThreshold;
+
+    // set by master at the start of run
+    std::vector<Panel> fPanels;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B4cTrigger::SetEnabled(G4bool enabled) {
+  fEnabled = enabled;
+}
+
+inline G4bool B4cTrigger::GetEnabled() const {
+  return fEnabled;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
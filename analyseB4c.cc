@@ -0,0 +1,470 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file analyseB4c.cc
+/// \brief Standalone parallel analysis of the exampleB4c ntuples
+///
+/// Reads the "B4" ntuple of the given Root or CSV files in chunks of rows
+/// (Root) or of bytes (CSV), processed concurrently by a pool of threads.
+/// A panel is hit when its energy deposit is above the threshold; the 
+/// events are selected by a window on the total energy deposit. For the
+/// selected events the tool builds the energy spectrum of each panel, 
+/// the hit multiplicity, the total energy of the coincidences (two hit
+/// panels or more) and the coincidence counts of each pair of panels.
+/// The spectra are written in <output>.root, the summary tables in 
+/// <output>_panels.csv and <output>_coincidences.csv.
+
+#include "B4OutputLayout.hh"
+#include "B4OutputReader.hh"
+
+#include "G4RootAnalysisManager.hh"
+#include "G4UIcommand.hh"
+#include "G4SystemOfUnits.hh"
+
+#include "tools/histo/h1d"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  void PrintUsage() {
+    G4cerr << " Usage: " << G4endl;
+    G4cerr << " analyseB4c [-o output] [-j nThreads] [-n chunkRows]"
+           << " [-e threshold_keV]" << G4endl;
+    G4cerr << "            [-w minTotal_MeV:maxTotal_MeV] [-b nBins]"
+           << " [-m maxEnergy_MeV]" << G4endl;
+    G4cerr << "            input1.root|input1.csv [input2 ...]" << G4endl;
+  }
+
+  // Analysis parameters
+  struct Cuts {
+    G4double threshold = 10.*keV;
+    G4double minTotal = 0.;
+    G4double maxTotal = DBL_MAX;
+    G4int nofBins = 100;
+    G4double maxEnergy = 5.*MeV;
+  };
+
+  // Energy columns of the panels, in the order of the ntuple
+  std::vector<G4String> GetEnergyColumns() {
+    std::vector<G4String> columns;
+    for ( const auto& column : B4OutputLayout::kNtupleColumns ) {
+      if ( column[0] == 'E' ) columns.push_back(column);
+    }
+    return columns;
+  }
+
+  // Results of the analysis of a part of the data
+  class Accumulator {
+    public:
+      Accumulator(const Cuts& cuts, std::size_t nofPanels)
+       : fCuts(cuts),
+         fNofPanels(nofPanels),
+         fMultiplicity("Multiplicity", G4int(nofPanels)+1, 
+                       -0.5, nofPanels+0.5),
+         fCoincidenceEnergy("Ecoinc", cuts.nofBins, 0., cuts.maxEnergy),
+         fNofHits(nofPanels, 0),
+         fSumEnergy(nofPanels, 0.),
+         fPairs(nofPanels*nofPanels, 0),
+         fHit(nofPanels, false)
+      {
+        for ( const auto& column : GetEnergyColumns() ) {
+          fSpectra.emplace_back(column, cuts.nofBins, 0., cuts.maxEnergy);
+        }
+      }
+
+      void Fill(const std::vector<G4double>& energies) {
+        ++fNofEvents;
+        G4double total = 0.;
+        for ( auto energy : energies ) total += energy;
+        if ( total < fCuts.minTotal || total > fCuts.maxTotal ) return;
+        ++fNofSelected;
+
+        G4int multiplicity = 0;
+        for ( std::size_t i=0; i<fNofPanels; ++i ) {
+          fHit[i] = energies[i] > fCuts.threshold;
+          if ( ! fHit[i] ) continue;
+          ++multiplicity;
+          ++fNofHits[i];
+          fSumEnergy[i] += energies[i];
+          fSpectra[i].fill(energies[i]);
+        }
+        fMultiplicity.fill(multiplicity);
+        if ( multiplicity < 2 ) return;
+
+        fCoincidenceEnergy.fill(total);
+        for ( std::size_t i=0; i<fNofPanels; ++i ) {
+          if ( ! fHit[i] ) continue;
+          for ( std::size_t j=i+1; j<fNofPanels; ++j ) {
+            if ( fHit[j] ) ++fPairs[i*fNofPanels+j];
+          }
+        }
+      }
+
+      void Add(const Accumulator& other) {
+        fNofEvents += other.fNofEvents;
+        fNofSelected += other.fNofSelected;
+        for ( std::size_t i=0; i<fNofPanels; ++i ) {
+          fSpectra[i].add(other.fSpectra[i]);
+          fNofHits[i] += other.fNofHits[i];
+          fSumEnergy[i] += other.fSumEnergy[i];
+        }
+        for ( std::size_t i=0; i<fPairs.size(); ++i ) {
+          fPairs[i] += other.fPairs[i];
+        }
+        fMultiplicity.add(other.fMultiplicity);
+        fCoincidenceEnergy.add(other.fCoincidenceEnergy);
+      }
+
+      const Cuts& fCuts;
+      std::size_t fNofPanels;
+      G4long fNofEvents = 0;
+      G4long fNofSelected = 0;
+      std::vector<tools::histo::h1d> fSpectra;
+      tools::histo::h1d fMultiplicity;
+      tools::histo::h1d fCoincidenceEnergy;
+      std::vector<G4long> fNofHits;
+      std::vector<G4double> fSumEnergy;
+      std::vector<G4long> fPairs;     // [i*nofPanels+j], i < j
+    
+    private:
+      std::vector<G4bool> fHit;
+  };
+
+  // A part of an input file: rows of a Root ntuple, 
+  // or bytes of a CSV ntuple
+  struct Chunk {
+    std::size_t input;
+    G4long first;
+    G4long size;
+  };
+
+  // Description of an input file
+  struct Input {
+    G4String fileName;
+    G4bool csv = false;
+    G4long size = 0;                 // rows (Root) or bytes (CSV)
+    G4long dataStart = 0;            // CSV: offset of the first row
+    std::vector<std::size_t> indexes; // CSV: indexes of the energy columns
+    std::size_t nofColumns = 0;       // CSV: number of columns
+    G4String error;
+  };
+
+  G4bool IsCsv(const G4String& fileName) {
+    return fileName.size() > 4 
+           && fileName.compare(fileName.size()-4, 4, ".csv") == 0;
+  }
+
+  // Reads the header of a CSV ntuple written by Geant4:
+  // lines "#column <type> <name>", followed by the rows
+  void OpenCsv(Input& input, const std::vector<G4String>& columns) {
+    std::ifstream file(input.fileName, std::ios::binary);
+    if ( ! file ) {
+      input.error = "cannot open file";
+      return;
+    }
+    std::vector<G4String> names;
+    std::string line;
+    std::streamoff offset = 0;
+    while ( file.peek() == '#' && std::getline(file, line) ) {
+      offset = file.tellg();
+      std::istringstream header(line);
+      std::string keyword, type, name;
+      header >> keyword >> type >> name;
+      if ( keyword == "#column" ) names.push_back(name);
+    }
+    for ( const auto& column : columns ) {
+      auto it = std::find(names.begin(), names.end(), column);
+      if ( it == names.end() ) {
+        input.error = "column " + column + " not found";
+        return;
+      }
+      input.indexes.push_back(it - names.begin());
+    }
+    file.seekg(0, std::ios::end);
+    input.nofColumns = names.size();
+    input.dataStart = offset;
+    input.size = G4long(file.tellg()) - offset;
+  }
+
+  // Processes the rows starting in [first, first + size) bytes 
+  // after the CSV header
+  G4bool ReadCsvChunk(const Input& input, const Chunk& chunk, 
+                      Accumulator& accumulator) {
+    std::ifstream file(input.fileName, std::ios::binary);
+    if ( ! file ) return false;
+
+    auto begin = input.dataStart + chunk.first;
+    auto end = begin + chunk.size;
+    file.seekg(begin);
+    std::string line;
+    // a row cut by the chunk start belongs to the previous chunk
+    if ( chunk.first > 0 ) {
+      file.seekg(begin - 1);
+      std::getline(file, line);
+    }
+
+    std::vector<G4double> values(input.nofColumns, 0.);
+    std::vector<G4double> energies(input.indexes.size(), 0.);
+    while ( G4long(file.tellg()) < end && std::getline(file, line) ) {
+      if ( line.empty() ) continue;
+      std::size_t position = 0;
+      for ( std::size_t i=0; i<input.nofColumns; ++i ) {
+        auto comma = line.find(',', position);
+        values[i] = std::strtod(line.c_str() + position, nullptr);
+        if ( comma == std::string::npos ) break;
+        position = comma + 1;
+      }
+      for ( std::size_t i=0; i<energies.size(); ++i ) {
+        energies[i] = values[input.indexes[i]];
+      }
+      accumulator.Fill(energies);
+    }
+    return true;
+  }
+
+  G4bool ReadRootChunk(const Input& input, const Chunk& chunk, 
+                       const std::vector<G4String>& columns,
+                       Accumulator& accumulator) {
+    std::ostringstream log;
+    B4OutputReader reader(input.fileName, log);
+    if ( ! reader.IsOpen() ) return false;
+
+    auto nofRead 
+      = reader.ReadNtuple(B4OutputLayout::kNtupleName, columns, 
+                          chunk.first, chunk.size,
+                          [&accumulator](const std::vector<G4double>& row) {
+                            accumulator.Fill(row);
+                          });
+    return nofRead == chunk.size;
+  }
+
+  G4bool ParseWindow(const G4String& value, Cuts& cuts) {
+    auto colon = value.find(':');
+    if ( colon == std::string::npos ) return false;
+    cuts.minTotal = G4UIcommand::ConvertToDouble(value.substr(0, colon))*MeV;
+    cuts.maxTotal = G4UIcommand::ConvertToDouble(value.substr(colon+1))*MeV;
+    return cuts.minTotal <= cuts.maxTotal;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc,char** argv)
+{
+  // Evaluate arguments
+  //
+  G4String outputName = "B4_analysis";
+  G4int nThreads = std::max(G4int(std::thread::hardware_concurrency()), 1);
+  G4long chunkRows = 1000000;
+  Cuts cuts;
+  std::vector<Input> inputs;
+  for ( G4int i=1; i<argc; ++i ) {
+    G4String option = argv[i];
+    if ( option.size() == 2 && option[0] == '-' ) {
+      if ( i+1 >= argc ) {
+        PrintUsage();
+        return 1;
+      }
+      G4String value = argv[++i];
+      if      ( option == "-o" ) outputName = value;
+      else if ( option == "-j" ) {
+        nThreads = std::max(G4UIcommand::ConvertToInt(value), 1);
+      }
+      else if ( option == "-n" ) {
+        chunkRows = std::max(G4UIcommand::ConvertToLongInt(value), 1L);
+      }
+      else if ( option == "-e" ) {
+        cuts.threshold = G4UIcommand::ConvertToDouble(value)*keV;
+      }
+      else if ( option == "-b" ) {
+        cuts.nofBins = std::max(G4UIcommand::ConvertToInt(value), 1);
+      }
+      else if ( option == "-m" ) {
+        cuts.maxEnergy = G4UIcommand::ConvertToDouble(value)*MeV;
+      }
+      else if ( option != "-w" || ! ParseWindow(value, cuts) ) {
+        PrintUsage();
+        return 1;
+      }
+    }
+    else {
+      inputs.emplace_back();
+      inputs.back().fileName = option;
+      inputs.back().csv = IsCsv(option);
+    }
+  }
+  if ( inputs.empty() ) {
+    PrintUsage();
+    return 1;
+  }
+
+  // Split the inputs in chunks
+  // (a CSV row takes about 20 bytes per column)
+  //
+  auto columns = GetEnergyColumns();
+  std::vector<Chunk> chunks;
+  for ( std::size_t i=0; i<inputs.size(); ++i ) {
+    auto& input = inputs[i];
+    G4long chunkSize = chunkRows;
+    if ( input.csv ) {
+      OpenCsv(input, columns);
+      chunkSize = chunkRows * 20 * std::max(input.nofColumns, std::size_t(1));
+    }
+    else {
+      std::ostringstream log;
+      B4OutputReader reader(input.fileName, log);
+      input.size = reader.IsOpen() 
+                 ? reader.GetNtupleEntries(B4OutputLayout::kNtupleName) : -1;
+      if ( input.size < 0 ) input.error = "ntuple not readable";
+    }
+    if ( input.error.size() ) {
+      G4cerr << "Skipping " << input.fileName << ": " << input.error << G4endl;
+      continue;
+    }
+    for ( G4long first=0; first<input.size; first+=chunkSize ) {
+      chunks.push_back({ i, first, std::min(chunkSize, input.size - first) });
+    }
+  }
+
+  // Process the chunks with a pool of threads, each with its own 
+  // accumulator
+  //
+  nThreads = std::max(std::min(nThreads, G4int(chunks.size())), 1);
+  std::vector<std::unique_ptr<Accumulator>> accumulators;
+  for ( G4int i=0; i<nThreads; ++i ) {
+    accumulators.emplace_back(new Accumulator(cuts, columns.size()));
+  }
+  std::atomic<std::size_t> nextChunk(0);
+  std::mutex errorMutex;
+
+  auto processChunks = [&](Accumulator& accumulator) {
+    std::size_t index;
+    while ( ( index = nextChunk++ ) < chunks.size() ) {
+      const auto& chunk = chunks[index];
+      auto& input = inputs[chunk.input];
+      auto ok = input.csv 
+              ? ReadCsvChunk(input, chunk, accumulator)
+              : ReadRootChunk(input, chunk, columns, accumulator);
+      if ( ! ok ) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        input.error = "read error";
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for ( G4int i=0; i<nThreads; ++i ) {
+    pool.emplace_back(processChunks, std::ref(*accumulators[i]));
+  }
+  for ( auto& thread : pool ) thread.join();
+
+  auto& result = *accumulators[0];
+  for ( G4int i=1; i<nThreads; ++i ) {
+    result.Add(*accumulators[i]);
+  }
+  for ( const auto& input : inputs ) {
+    if ( input.error.size() ) {
+      G4cerr << "Error in " << input.fileName << ": " << input.error << G4endl;
+    }
+  }
+
+  // Write the spectra
+  //
+  auto analysisManager = G4RootAnalysisManager::Instance();
+  analysisManager->SetVerboseLevel(0);
+  std::vector<const tools::histo::h1d*> spectra;
+  for ( const auto& spectrum : result.fSpectra ) spectra.push_back(&spectrum);
+  spectra.push_back(&result.fMultiplicity);
+  spectra.push_back(&result.fCoincidenceEnergy);
+  for ( auto spectrum : spectra ) {
+    analysisManager->CreateH1(spectrum->title(), spectrum->title(), 
+                              spectrum->axis().bins(), 
+                              spectrum->axis().lower_edge(), 
+                              spectrum->axis().upper_edge());
+  }
+  if ( ! analysisManager->OpenFile(outputName + ".root") ) {
+    G4cerr << "Cannot open output file " << outputName << ".root" << G4endl;
+    return 1;
+  }
+  for ( std::size_t i=0; i<spectra.size(); ++i ) {
+    *analysisManager->GetH1(G4int(i)) = *spectra[i];
+  }
+  analysisManager->Write();
+  analysisManager->CloseFile();
+
+  // Write and print the summary tables
+  //
+  std::ofstream panels(outputName + "_panels.csv");
+  panels << "panel,hits,fraction,meanEnergy_MeV" << std::endl;
+  G4cout << "Analysed " << result.fNofEvents << " events with " << nThreads
+         << " threads, " << result.fNofSelected << " selected, threshold "
+         << cuts.threshold/keV << " keV" << G4endl;
+  G4cout << std::setw(8) << "panel" << std::setw(12) << "hits" 
+         << std::setw(12) << "fraction" << std::setw(14) << "<E> [MeV]" 
+         << G4endl;
+  for ( std::size_t i=0; i<columns.size(); ++i ) {
+    auto hits = result.fNofHits[i];
+    auto fraction 
+      = result.fNofSelected ? G4double(hits) / result.fNofSelected : 0.;
+    auto meanEnergy = hits ? result.fSumEnergy[i] / hits / MeV : 0.;
+    panels << columns[i] << "," << hits << "," << fraction << "," 
+           << meanEnergy << std::endl;
+    G4cout << std::setw(8) << columns[i] << std::setw(12) << hits 
+           << std::setw(12) << fraction << std::setw(14) << meanEnergy 
+           << G4endl;
+  }
+
+  std::ofstream coincidences(outputName + "_coincidences.csv");
+  coincidences << "panel";
+  for ( const auto& column : columns ) coincidences << "," << column;
+  coincidences << std::endl;
+  for ( std::size_t i=0; i<columns.size(); ++i ) {
+    coincidences << columns[i];
+    for ( std::size_t j=0; j<columns.size(); ++j ) {
+      auto pair = ( i < j ) ? result.fPairs[i*columns.size()+j] 
+                            : result.fPairs[j*columns.size()+i];
+      coincidences << "," << ( i == j ? 0 : pair );
+    }
+    coincidences << std::endl;
+  }
+  G4cout << "Coincidences (2 panels or more): " 
+         << result.fCoincidenceEnergy.all_entries() 
+         << ", written in " << outputName << ".root, " << outputName 
+         << "_panels.csv and " << outputName << "_coincidences.csv" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
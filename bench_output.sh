@@ -0,0 +1,31 @@
+#!/bin/sh
+#
+# Compares the output size and the write throughput of exampleB4c
+# with several analysis output types, in headless batch mode.
+#
+# Usage: ./bench_output.sh [nEvents] [nThreads] [outputType ...]
+#
+
+nEvents=${1:-100000}
+nThreads=${2:-1}
+[ $# -gt 2 ] && shift 2 || set -- root csv xml hdf5
+
+printf "%-8s %10s %8s %10s %14s %12s\n" "type" "size[MB]" "files" "time[s]" "bytes/s" "events/s"
+for type in "$@"; do
+  line=$(./exampleB4c -b -n "$nEvents" -t "$nThreads" -f "$type" \
+         -o "B4_bench_$type" 2>&1 | grep "### Output" | tail -1)
+  if [ -z "$line" ]; then
+    printf "%-8s %s\n" "$type" "failed"
+    continue
+  fi
+  echo "$line" | awk -v type="$type" '{
+    for ( i=1; i<=NF; ++i ) {
+      if ( $i == "MB" ) size = $(i-1)
+      if ( $i == "files," ) files = $(i-1)
+      if ( $i == "written" ) time = $(i+2)
+      if ( $i == "bytes/s," ) bytes = $(i-1)
+      if ( $i == "events/s" ) events = $(i-1)
+    }
+    printf "%-8s %10s %8s %10s %14s %12s\n", type, size, files, time, bytes, events
+  }'
+done
@@ -0,0 +1,30 @@
+#!/bin/sh
+#
+# Compares the start-up time, the event rate and the memory of exampleB4c
+# with several physics lists, in headless batch mode.
+#
+# Usage: ./bench_physics.sh [nEvents] [nThreads] [physicsList ...]
+#
+
+nEvents=${1:-10000}
+nThreads=${2:-1}
+[ $# -gt 2 ] && shift 2 || set -- FTFP_BERT EM_opt4 EM_Livermore EM_Penelope EM_opt4+RDM
+
+printf "%-16s %10s %12s %10s %10s\n" "physics" "startup[s]" "events/s" "RSS[MB]" "peak[MB]"
+for physics in "$@"; do
+  line=$(./exampleB4c -b -n "$nEvents" -t "$nThreads" -p "$physics" 2>&1 \
+         | grep "### Performance" | tail -1)
+  if [ -z "$line" ]; then
+    printf "%-16s %s\n" "$physics" "failed"
+    continue
+  fi
+  echo "$line" | awk -v physics="$physics" '{
+    for ( i=1; i<=NF; ++i ) {
+      if ( $i == "startup" ) startup = $(i+1)
+      if ( $i == "events/s," ) rate = $(i-1)
+      if ( $i == "RSS" ) rss = $(i+1)
+      if ( $i == "peak" ) peak = $(i+1)
+    }
+    printf "%-16s %10s %12s %10s %10s\n", physics, startup, rate, rss, peak
+  }'
+done
@@ -30,30 +30,139 @@
 
 #include "B4cDetectorConstruction.hh"
 #include "B4cActionInitialization.hh"
+#include "B4RunAction.hh"
+#include "B4EventSeeder.hh"
+#include "B4ScanDriver.hh"
+#include "B4cCheckpoint.hh"
+#include "B4cMemoryReport.hh"
+#include "B4cSiliconResponse.hh"
+#include "B4SharedHistograms.hh"
+#include "B4NavigationBenchmark.hh"
+#include "B4cScoringMesh.hh"
+#include "B4RangeOut.hh"
+#include "B4cEventKeeper.hh"
+#include "B4cNeutronCapture.hh"
+#include "B4cOpticalReadout.hh"
+#include "B4SubEventSplitter.hh"
+#include "B4cTrigger.hh"
+#include "B4cShield.hh"
+#include "B4StartupReport.hh"
+#include "B4EmPhysicsList.hh"
+#include "B4PhysicsTableCache.hh"
 
-#ifdef G4MULTITHREADED
-#include "G4MTRunManager.hh"
-#else
-#include "G4RunManager.hh"
-#endif
+#include "G4RunManagerFactory.hh"
+#include "G4Threading.hh"
+#include "G4Version.hh"
 
 #include "G4UImanager.hh"
 #include "G4UIcommand.hh"
-#include "FTFP_BERT.hh"
+#include "G4StateManager.hh"
+#include "G4PhysListFactory.hh"
+#include "G4RadioactiveDecayPhysics.hh"
 
 #include "Randomize.hh"
 
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
 
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 namespace {
   void PrintUsage() {
     G4cerr << " Usage: " << G4endl;
-    G4cerr << " exampleB4c [-m macro ] [-u UIsession] [-t nThreads]" << G4endl;
+    G4cerr << " exampleB4c [-m macro ] [-u UIsession] [-t nThreads|auto]"
+           << " [-r runManagerType]" << G4endl;
+    G4cerr << "            [-e randomEngine] [-s runSeed]"
+           << " [-p physicsList]" << G4endl;
+    G4cerr << "            [-n nEvents [-i shardIndex -c shardCount]] [-b]"
+           << G4endl;
+    G4cerr << "            [-o outputFile] [-f outputType]" << G4endl;
     G4cerr << "   note: -t option is available only for multi-threaded mode."
            << G4endl;
+    G4cerr << "   runManagerType: default, serial, mt, tasking (tbb),"
+           << " subevent (Geant4 11.2)." << G4endl;
+    G4cerr << "   randomEngine: MixMax (default), Ranlux, Ranlux64, RanluxPP,"
+           << " Ranecu." << G4endl;
+    G4cerr << "   -n runs nEvents after the macro; with -i/-c only the events"
+           << G4endl
+           << "   of the given shard are run and the output file is tagged"
+           << " with the shard" << G4endl
+           << "   (-c requires -n)." << G4endl;
+    G4cerr << "   physicsList: a reference list (FTFP_BERT, the default, "
+           << "QGSP_BIC_EMZ, ...)" << G4endl
+           << "   or an EM-only list EM_opt4, EM_Livermore, EM_Penelope;"
+           << G4endl
+           << "   +RDM adds the radioactive decay (e.g. EM_opt4+RDM)." 
+           << G4endl;
+    G4cerr << "   outputType: root (default), csv, xml, hdf5 (if available);"
+           << G4endl
+           << "   it is also given by the outputFile extension." << G4endl;
+    G4cerr << "   -b runs headless: no visualization, no material printing"
+           << G4endl
+           << "   and the overlaps check is done once per geometry; the"
+           << " kernel is initialized" << G4endl
+           << "   after the macro, which can use PreInit commands." 
+           << G4endl;
+  }
+
+  // Splits the physics list name into its base name and the RDM option
+  G4String GetPhysicsBaseName(const G4String& name, G4bool& rdm) {
+    auto plus = name.find("+RDM");
+    rdm = ( plus != std::string::npos );
+    return rdm ? name.substr(0, plus) : name;
+  }
+
+  G4bool IsPhysicsList(const G4String& name) {
+    G4bool rdm;
+    auto baseName = GetPhysicsBaseName(name, rdm);
+    if ( baseName.compare(0, 3, "EM_") == 0 ) {
+      return B4EmPhysicsList::IsEmName(baseName.substr(3));
+    }
+    G4PhysListFactory factory;
+    return factory.IsReferencePhysList(baseName);
+  }
+
+  G4VModularPhysicsList* CreatePhysicsList(const G4String& name) {
+    G4bool rdm;
+    auto baseName = GetPhysicsBaseName(name, rdm);
+    if ( baseName.compare(0, 3, "EM_") == 0 ) {
+      auto physicsList = new B4EmPhysicsList(baseName.substr(3));
+      if ( rdm ) physicsList->AddRadioactiveDecay();
+      return physicsList;
+    }
+    G4PhysListFactory factory;
+    auto physicsList = factory.GetReferencePhysList(baseName);
+    if ( physicsList && rdm ) {
+      physicsList->RegisterPhysics(new G4RadioactiveDecayPhysics());
+    }
+    return physicsList;
+  }
+
+  const std::vector<G4String> kOutputTypes 
+    = { "root", "csv", "xml", "hdf5" };
+
+  G4bool IsOutputType(const G4String& type) {
+    return std::find(kOutputTypes.begin(), kOutputTypes.end(), type) 
+           != kOutputTypes.end();
+  }
+
+  G4bool GetRunManagerType(const G4String& name, G4RunManagerType& type) {
+    if      ( name == "default" ) type = G4RunManagerType::Default;
+    else if ( name == "serial" )  type = G4RunManagerType::SerialOnly;
+    else if ( name == "mt" )      type = G4RunManagerType::MTOnly;
+    else if ( name == "tasking" ) type = G4RunManagerType::TaskingOnly;
+    else if ( name == "tbb" )     type = G4RunManagerType::TBBOnly;
+#if G4VERSION_NUMBER >= 1120
+    else if ( name == "subevent" ) type = G4RunManagerType::SubEvtOnly;
+#endif
+    else return false;
+    return true;
   }
 }
 
@@ -61,80 +170,220 @@ namespace {
 
 int main(int argc,char** argv)
 {
+  B4StartupReport::Start();
+
   // Evaluate arguments
   //
-  if ( argc > 7 ) {
-    PrintUsage();
-    return 1;
-  }
-  
   G4String macro;
   G4String session;
-#ifdef G4MULTITHREADED
   G4int nThreads = 0;
-#endif
-  for ( G4int i=1; i<argc; i=i+2 ) {
-    if      ( G4String(argv[i]) == "-m" ) macro = argv[i+1];
-    else if ( G4String(argv[i]) == "-u" ) session = argv[i+1];
-#ifdef G4MULTITHREADED
-    else if ( G4String(argv[i]) == "-t" ) {
-      nThreads = G4UIcommand::ConvertToInt(argv[i+1]);
+  auto runManagerType = G4RunManagerType::Default;
+  G4String engineName = "MixMax";
+  G4String physicsName = "FTFP_BERT";
+  G4long runSeed = -1;
+  G4long nofEvents = 0;
+  G4String outputFile = "B4";
+  G4String outputType;
+  G4long shardIndex = 0;
+  G4long shardCount = 1;
+  G4bool headless = false;
+  for ( G4int i=1; i<argc; ++i ) {
+    G4String option = argv[i];
+    if ( option == "-b" ) {
+      headless = true;
+      continue;
+    }
+    if ( i+1 >= argc ) {
+      PrintUsage();
+      return 1;
+    }
+    G4String value = argv[++i];
+    if      ( option == "-m" ) macro = value;
+    else if ( option == "-u" ) session = value;
+    else if ( option == "-t" ) {
+      nThreads = ( value == "auto" ) 
+        ? G4Threading::G4GetNumberOfCores()
+        : G4UIcommand::ConvertToInt(value);
+    }
+    else if ( option == "-e" ) engineName = value;
+    else if ( option == "-p" ) {
+      if ( ! IsPhysicsList(value) ) {
+        PrintUsage();
+        return 1;
+      }
+      physicsName = value;
+    }
+    else if ( option == "-s" ) runSeed = G4UIcommand::ConvertToLongInt(value);
+    else if ( option == "-n" ) nofEvents = G4UIcommand::ConvertToLongInt(value);
+    else if ( option == "-i" ) shardIndex = G4UIcommand::ConvertToLongInt(value);
+    else if ( option == "-c" ) shardCount = G4UIcommand::ConvertToLongInt(value);
+    else if ( option == "-o" ) outputFile = value;
+    else if ( option == "-f" ) {
+      if ( ! IsOutputType(value) ) {
+        PrintUsage();
+        return 1;
+      }
+      outputType = value;
+    }
+    else if ( option == "-r" ) {
+      if ( ! GetRunManagerType(value, runManagerType) ) {
+        PrintUsage();
+        return 1;
+      }
     }
-#endif
     else {
       PrintUsage();
       return 1;
     }
   }  
-  
-  // Detect interactive mode (if no macro provided) and define UI session
-  //
-  G4UIExecutive* ui = 0;
-  if ( ! macro.size() ) {
-    ui = new G4UIExecutive(argc, argv, session);
+  if ( shardCount < 1 || shardIndex < 0 || shardIndex >= shardCount 
+       || ( shardCount > 1 && nofEvents <= 0 )
+       || ( headless && ! macro.size() && nofEvents <= 0 ) ) {
+    PrintUsage();
+    return 1;
   }
 
   // Choose the Random engine
+  // Events are seeded from (run seed, run ID, event ID), independently
+  // of the number of threads
   //
-  G4Random::setTheEngine(new CLHEP::RanecuEngine);
+  if ( ! B4EventSeeder::SetEngine(engineName) ) {
+    PrintUsage();
+    return 1;
+  }
+  auto eventSeeder = B4EventSeeder::Instance();
+  if ( runSeed >= 0 ) {
+    eventSeeder->SetRunSeed(runSeed);
+  }
+
+  // Create the checkpointing control (/B4/checkpoint/), the memory report
+  // (/B4/memory/), the panel response (/B4/digi/), the shared histograms
+  // (/B4/sharedH1/), the navigation benchmark (/B4/navigation/), the 
+  // dose mesh (/B4/mesh/), the range-out policy (/B4/rangeOut/), the 
+  // event keeping (/B4/keep/), the neutron capture parametrization 
+  // (/B4/neutron/), the optical readout (/B4/optical/), the sub-event 
+  // splitting (/B4/subEvent/), the trigger (/B4/trigger/), the shield
+  // (/B4/shield/) and the parameter scan (/B4/scan/) before any macro 
+  // is executed
+  //
+  auto checkpoint = B4cCheckpoint::Instance();
+  auto memoryReport = B4cMemoryReport::Instance();
+  auto siliconResponse = B4cSiliconResponse::Instance();
+  auto sharedHistograms = B4SharedHistograms::Instance();
+  auto navigationBenchmark = B4NavigationBenchmark::Instance();
+  auto scoringMesh = B4cScoringMesh::Instance();
+  auto rangeOut = B4RangeOut::Instance();
+  auto eventKeeper = B4cEventKeeper::Instance();
+  auto neutronCapture = B4cNeutronCapture::Instance();
+  auto opticalReadout = B4cOpticalReadout::Instance();
+  auto subEventSplitter = B4SubEventSplitter::Instance();
+  auto trigger = B4cTrigger::Instance();
+  auto shield = B4cShield::Instance();
+  auto scanDriver = new B4ScanDriver();
+
+  // Select the slice of the run processed by this shard.
+  // Its events are seeded with their IDs in the whole run, so that the 
+  // shards use disjoint random streams and together reproduce the 
+  // unsharded run.
+  //
+  G4long shardEvents = nofEvents;
+  if ( shardCount > 1 ) {
+    auto firstEvent = nofEvents * shardIndex / shardCount;
+    shardEvents = nofEvents * (shardIndex + 1) / shardCount - firstEvent;
+    eventSeeder->SetEventOffset(firstEvent);
+
+    std::ostringstream tag;
+    tag << "_shard" << std::setw(std::to_string(shardCount - 1).size()) 
+        << std::setfill('0') << shardIndex;
+    B4RunAction::SetFileTag(tag.str());
+
+    G4cout << "### Shard " << shardIndex << " of " << shardCount 
+           << ": events " << firstEvent << " to " 
+           << firstEvent + shardEvents - 1 << G4endl;
+  }
+
+  // Detect interactive mode (if no macro nor events provided) and define 
+  // UI session
+  //
+  G4UIExecutive* ui = 0;
+  if ( ! macro.size() && nofEvents <= 0 ) {
+    ui = new G4UIExecutive(argc, argv, session);
+  }
   
-  // Construct the default run manager
+  // Construct the run manager of the requested type
+  // (the G4RUN_MANAGER_TYPE environment variable applies for "default")
   //
-#ifdef G4MULTITHREADED
-  G4MTRunManager * runManager = new G4MTRunManager;
+  auto runManager = G4RunManagerFactory::CreateRunManager(runManagerType);
   if ( nThreads > 0 ) { 
     runManager->SetNumberOfThreads(nThreads);
   }  
-#else
-  G4RunManager * runManager = new G4RunManager;
-#endif
+  B4StartupReport::Mark("run manager");
 
   // Set mandatory initialization classes
   //
   auto detConstruction = new B4cDetectorConstruction();
+  if ( headless ) {
+    detConstruction->SetPrintMaterials(false);
+    detConstruction->SetCacheOverlapsCheck(true);
+  }
   runManager->SetUserInitialization(detConstruction);
 
-  auto physicsList = new FTFP_BERT;
+  auto physicsList = CreatePhysicsList(physicsName);
   runManager->SetUserInitialization(physicsList);
+  B4StartupReport::SetLabel("physics list " + physicsName);
+
+  // Retrieve the physics tables from the cache, or store them there
+  // after they are built (/B4/physicsCache/)
+  auto tableCache = new B4PhysicsTableCache(physicsList, physicsName);
     
   auto actionInitialization = new B4cActionInitialization();
   runManager->SetUserInitialization(actionInitialization);
+  B4StartupReport::Mark("user initialization");
   
   // Initialize visualization
-  auto visManager = new G4VisExecutive;
-  // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
-  // G4VisManager* visManager = new G4VisExecutive("Quiet");
-  visManager->Initialize();
+  G4VisManager* visManager = nullptr;
+  if ( ! headless ) {
+    visManager = new G4VisExecutive;
+    // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
+    // G4VisManager* visManager = new G4VisExecutive("Quiet");
+    visManager->Initialize();
+    B4StartupReport::Mark("visualization");
+  }
 
   // Get the pointer to the User Interface manager
   auto UImanager = G4UImanager::GetUIpointer();
 
+  // Set the output file name and type
+  // (the name, also when set in the macro, is tagged with the shard at 
+  // the start of each run, see B4RunAction)
+  //
+  if ( outputType.size() ) {
+    UImanager->ApplyCommand("/analysis/setDefaultFileType " + outputType);
+  }
+  if ( outputFile != "B4" ) {
+    UImanager->ApplyCommand("/analysis/setFileName " + outputFile);
+  }
+
   // Process macro or start UI session
   //
-  if ( macro.size() ) {
+  if ( ! ui ) {
     // batch mode
-    G4String command = "/control/execute ";
-    UImanager->ApplyCommand(command+macro);
+    if ( macro.size() ) {
+      G4String command = "/control/execute ";
+      UImanager->ApplyCommand(command+macro);
+    }
+    // Initialize the kernel after the macro, so that its PreInit commands
+    // apply, unless the macro did; in headless mode its time is reported
+    if ( ( headless || shardEvents > 0 ) &&
+         G4StateManager::GetStateManager()->GetCurrentState() 
+           == G4State_PreInit ) {
+      runManager->Initialize();
+      B4StartupReport::Mark("kernel initialization");
+    }
+    if ( shardEvents > 0 ) {
+      UImanager->ApplyCommand(
+        "/run/beamOn " + G4UIcommand::ConvertToString(G4int(shardEvents)));
+    }
   }
   else  {  
     // interactive mode : define UI session
@@ -152,6 +401,22 @@ int main(int argc,char** argv)
   // in the main() program !
 
   delete visManager;
+  delete scanDriver;
+  delete tableCache;
+  delete shield;
+  delete trigger;
+  delete subEventSplitter;
+  delete opticalReadout;
+  delete neutronCapture;
+  delete eventKeeper;
+  delete rangeOut;
+  delete scoringMesh;
+  delete navigationBenchmark;
+  delete sharedHistograms;
+  delete siliconResponse;
+  delete memoryReport;
+  delete checkpoint;
+  delete eventSeeder;
   delete runManager;
 }
 
@@ -0,0 +1,379 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+/// \file mergeB4c.cc
+/// \brief Standalone merger of the exampleB4c output files
+///
+/// Adds the histograms and concatenates the ntuples (B4, B4digi and 
+/// B4optical) of the given Root files into one file with the same 
+/// layout. The inputs without histograms (digits or optical only) are
+/// accepted, as well as those missing an ntuple which was not written.
+/// The input files are read concurrently by a pool of threads and 
+/// written in the order of the command line. The output also contains 
+/// a "Provenance" ntuple with one row per input file.
+
+#include "B4OutputLayout.hh"
+#include "B4OutputReader.hh"
+
+#include "G4RootAnalysisManager.hh"
+#include "G4UIcommand.hh"
+
+#include "tools/histo/h1d"
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  void PrintUsage() {
+    G4cerr << " Usage: " << G4endl;
+    G4cerr << " mergeB4c [-o output] [-j nThreads] input1.root [input2.root ...]"
+           << G4endl;
+  }
+
+  // The ntuples merged, in the order of their IDs in the output
+  struct NtupleLayout {
+    const G4String& name;
+    const char* title;
+    const std::vector<G4String>& columns;
+    G4bool intColumns;
+  };
+  const std::vector<NtupleLayout> kNtuples = {
+    { B4OutputLayout::kNtupleName, "Edep and TrackL", 
+      B4OutputLayout::kNtupleColumns, false },
+    { B4OutputLayout::kDigiNtupleName, "Panel digits", 
+      B4OutputLayout::kDigiNtupleColumns, true },
+    { B4OutputLayout::kOpticalNtupleName, "Panel photoelectrons",
+      B4OutputLayout::kOpticalNtupleColumns, true } };
+
+  // Rows of one ntuple of an input file
+  struct NtupleData {
+    std::vector<G4double> rows;   // values, row after row
+    G4long nofRows = 0;
+  };
+
+  // Content of one input file
+  struct InputData {
+    G4String fileName;
+    std::vector<std::unique_ptr<tools::histo::h1d>> h1s; // none or all
+    std::vector<NtupleData> ntuples;
+    G4String error;
+    G4bool done = false;
+  };
+
+  void ReadInput(InputData& input) {
+    std::ostringstream log;
+    B4OutputReader reader(input.fileName, log);
+    if ( ! reader.IsOpen() ) {
+      input.error = "cannot open file";
+      return;
+    }
+
+    // the histograms are not written in the digits or optical only runs
+    for ( const auto& name : B4OutputLayout::kH1Names ) {
+      auto h1 = reader.ReadH1(name);
+      if ( ! h1 ) continue;
+      input.h1s.emplace_back(h1);
+    }
+    if ( input.h1s.size() && 
+         input.h1s.size() != B4OutputLayout::kH1Names.size() ) {
+      input.error = "histograms missing";
+      return;
+    }
+
+    // the inactive ntuples are not written
+    input.ntuples.resize(kNtuples.size());
+    for ( std::size_t i=0; i<kNtuples.size(); ++i ) {
+      const auto& layout = kNtuples[i];
+      if ( reader.GetNtupleEntries(layout.name) < 0 ) continue;
+
+      auto& ntuple = input.ntuples[i];
+      auto function = [&ntuple](const std::vector<G4double>& row) {
+        ntuple.rows.insert(ntuple.rows.end(), row.begin(), row.end());
+      };
+      auto nofRows 
+        = layout.intColumns
+          ? reader.ReadIntNtuple(layout.name, layout.columns, 0, -1, function)
+          : reader.ReadNtuple(layout.name, layout.columns, 0, -1, function);
+      if ( nofRows < 0 ) {
+        input.error = "ntuple " + layout.name + " not readable";
+        return;
+      }
+      ntuple.nofRows = nofRows;
+    }
+  }
+
+  // Provenance of one input file
+  struct Provenance {
+    G4String fileName;
+    std::vector<G4long> nofRows;  // per ntuple
+    G4double nofH1Entries;
+    G4String status;
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc,char** argv)
+{
+  // Evaluate arguments
+  //
+  G4String outputName = "B4_merged.root";
+  G4int nThreads = std::max(G4int(std::thread::hardware_concurrency()), 1);
+  std::vector<InputData> inputs;
+  for ( G4int i=1; i<argc; ++i ) {
+    G4String option = argv[i];
+    if ( option == "-o" || option == "-j" ) {
+      if ( i+1 >= argc ) {
+        PrintUsage();
+        return 1;
+      }
+      G4String value = argv[++i];
+      if ( option == "-o" ) outputName = value;
+      else nThreads = std::max(G4UIcommand::ConvertToInt(value), 1);
+    }
+    else {
+      inputs.emplace_back();
+      inputs.back().fileName = option;
+    }
+  }
+  if ( inputs.empty() ) {
+    PrintUsage();
+    return 1;
+  }
+  nThreads = std::min(nThreads, G4int(inputs.size()));
+
+  // Read the inputs with a pool of threads; at most maxPending inputs
+  // are kept in memory ahead of the writer
+  //
+  const std::size_t maxPending = 2 * nThreads;
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::size_t nextInput = 0;
+  std::size_t nofWritten = 0;
+
+  auto readInputs = [&]() {
+    while ( true ) {
+      std::size_t index;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&]() { 
+          return nextInput >= inputs.size() 
+                 || nextInput < nofWritten + maxPending; });
+        if ( nextInput >= inputs.size() ) return;
+        index = nextInput++;
+      }
+      ReadInput(inputs[index]);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        inputs[index].done = true;
+      }
+      condition.notify_all();
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for ( G4int i=0; i<nThreads; ++i ) {
+    pool.emplace_back(readInputs);
+  }
+
+  // Merge the inputs in the command line order
+  //
+  auto analysisManager = G4RootAnalysisManager::Instance();
+  analysisManager->SetVerboseLevel(0);
+  std::vector<std::unique_ptr<tools::histo::h1d>> merged;
+  std::vector<Provenance> provenance;
+  std::vector<G4long> nofRows(kNtuples.size(), 0);
+  G4int nofMerged = 0;
+  G4bool opened = false;
+  G4bool failed = false;
+
+  for ( auto& input : inputs ) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [&input]() { return input.done; });
+    }
+
+    G4String status = input.error.size() ? input.error : "merged";
+    G4double nofH1Entries = 0.;
+
+    if ( input.error.empty() && ! opened ) {
+      // Book the ntuples at the first input; the histograms are booked 
+      // at the end with the binning of the first input which has them
+      for ( const auto& layout : kNtuples ) {
+        analysisManager->CreateNtuple(layout.name, layout.title);
+        for ( const auto& column : layout.columns ) {
+          if ( layout.intColumns ) {
+            analysisManager->CreateNtupleIColumn(column);
+          }
+          else {
+            analysisManager->CreateNtupleDColumn(column);
+          }
+        }
+        analysisManager->FinishNtuple();
+      }
+      analysisManager->CreateNtuple("Provenance", "Merged input files");
+      analysisManager->CreateNtupleSColumn("file");
+      for ( const auto& layout : kNtuples ) {
+        analysisManager->CreateNtupleDColumn(layout.name + "Rows");
+      }
+      analysisManager->CreateNtupleDColumn("h1Entries");
+      analysisManager->CreateNtupleSColumn("status");
+      analysisManager->FinishNtuple();
+      opened = true;
+
+      if ( ! analysisManager->OpenFile(outputName) ) {
+        G4cerr << "Cannot open output file " << outputName << G4endl;
+        // stop the readers
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          nextInput = inputs.size();
+        }
+        condition.notify_all();
+        failed = true;
+        break;
+      }
+    }
+
+    if ( input.error.empty() && input.h1s.size() && merged.empty() ) {
+      for ( const auto& h1 : input.h1s ) {
+        merged.emplace_back(new tools::histo::h1d(*h1));
+      }
+    }
+    else if ( input.error.empty() && input.h1s.size() ) {
+      // all the histograms are checked before any is added, so that a
+      // skipped input leaves the merged histograms unchanged
+      for ( std::size_t i=0; i<merged.size(); ++i ) {
+        if ( ! merged[i]->is_compatible(*input.h1s[i]) ) {
+          status = "incompatible binning of " + B4OutputLayout::kH1Names[i];
+          break;
+        }
+      }
+      for ( std::size_t i=0; status == "merged" && i<merged.size(); ++i ) {
+        merged[i]->add(*input.h1s[i]);
+      }
+    }
+
+    std::vector<G4long> inputRows(kNtuples.size(), 0);
+    if ( status == "merged" ) {
+      if ( input.h1s.size() ) nofH1Entries = input.h1s[0]->all_entries();
+      for ( std::size_t id=0; id<kNtuples.size(); ++id ) {
+        const auto& layout = kNtuples[id];
+        const auto& ntuple = input.ntuples[id];
+        auto nofColumns = layout.columns.size();
+        for ( G4long row=0; row<ntuple.nofRows; ++row ) {
+          for ( std::size_t column=0; column<nofColumns; ++column ) {
+            auto value = ntuple.rows[row*nofColumns+column];
+            if ( layout.intColumns ) {
+              analysisManager->FillNtupleIColumn(G4int(id), G4int(column), 
+                                                 G4int(value));
+            }
+            else {
+              analysisManager->FillNtupleDColumn(G4int(id), G4int(column), 
+                                                 value);
+            }
+          }
+          analysisManager->AddNtupleRow(G4int(id));
+        }
+        inputRows[id] = ntuple.nofRows;
+        nofRows[id] += ntuple.nofRows;
+      }
+      ++nofMerged;
+    }
+    else {
+      G4cerr << "Skipping " << input.fileName << ": " << status << G4endl;
+    }
+    provenance.push_back(
+      { input.fileName, inputRows, nofH1Entries, status });
+
+    // release the input and let the readers go on
+    input.h1s.clear();
+    std::vector<NtupleData>().swap(input.ntuples);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++nofWritten;
+    }
+    condition.notify_all();
+  }
+
+  for ( auto& thread : pool ) thread.join();
+
+  if ( failed ) return 1;
+  if ( nofMerged == 0 ) {
+    G4cerr << "No input file could be merged." << G4endl;
+    return 1;
+  }
+
+  // Write the merged histograms and the provenance table
+  //
+  for ( std::size_t i=0; i<merged.size(); ++i ) {
+    const auto& h1 = *merged[i];
+    auto id = analysisManager->CreateH1(B4OutputLayout::kH1Names[i], 
+                                        h1.title(), h1.axis().bins(), 
+                                        h1.axis().lower_edge(),
+                                        h1.axis().upper_edge());
+    *analysisManager->GetH1(id) = h1;
+  }
+  const G4int provenanceID = G4int(kNtuples.size());
+  for ( const auto& record : provenance ) {
+    G4int column = 0;
+    analysisManager->FillNtupleSColumn(provenanceID, column++, 
+                                       record.fileName);
+    for ( auto rows : record.nofRows ) {
+      analysisManager->FillNtupleDColumn(provenanceID, column++, rows);
+    }
+    analysisManager->FillNtupleDColumn(provenanceID, column++, 
+                                       record.nofH1Entries);
+    analysisManager->FillNtupleSColumn(provenanceID, column++, 
+                                       record.status);
+    analysisManager->AddNtupleRow(provenanceID);
+  }
+  analysisManager->Write();
+  analysisManager->CloseFile();
+
+  // Print the merged statistics
+  //
+  G4cout << "Merged " << nofMerged << " of " << inputs.size() 
+         << " files with " << nThreads << " threads into " << outputName 
+         << ":";
+  for ( std::size_t id=0; id<kNtuples.size(); ++id ) {
+    G4cout << " " << nofRows[id] << " " << kNtuples[id].name << " rows";
+  }
+  G4cout << G4endl;
+  for ( std::size_t i=0; i<merged.size(); ++i ) {
+    G4cout << " " << B4OutputLayout::kH1Names[i] 
+           << " : entries = " << merged[i]->all_entries()
+           << " mean = " << merged[i]->mean() 
+           << " rms = " << merged[i]->rms() << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......